@@ -6,6 +6,13 @@
 //
 
 #include "alignment.h"
+#include <bit>
+#include <charconv>
+#include <exception>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include "../utils/gzstream.h"
 
 using namespace std;
 using namespace cmaple;
@@ -39,33 +46,87 @@ cmaple::Alignment::Alignment(const std::string& aln_filename,
   read(aln_filename, ref_seq, format, seqtype);
 }
 
+cmaple::Alignment::Alignment(std::vector<Sequence>&& sequences,
+                             const std::string& ref_seq,
+                             const cmaple::SeqRegion::SeqType seqtype)
+    : Alignment() {
+  // Initialize an alignment instance from the sequences
+  read(std::move(sequences), ref_seq, seqtype);
+}
+
 cmaple::Alignment::~Alignment() = default;
 
 void cmaple::Alignment::read(std::istream& aln_stream,
                              const std::string& n_ref_seq,
                              const InputType format,
                              const cmaple::SeqRegion::SeqType seqtype) {
+  // Set format (if specified). Otherwise, detect the format from the alignment
+  const InputType n_format = (format != IN_AUTO && format != IN_UNKNOWN)
+                                 ? format
+                                 : detectInputFile(aln_stream);
+
+  // validate the format
+  if (n_format == IN_UNKNOWN) {
+    throw std::invalid_argument(
+        "Failed to detect the format from the alignment!");
+  }
+
+  // MAPLE and binary alignments are parsed from the content in memory
+  if (n_format == IN_MAPLE || n_format == IN_BINARY) {
+    const string content((std::istreambuf_iterator<char>(aln_stream)),
+                         std::istreambuf_iterator<char>());
+    resetStream(aln_stream);
+    readBuffer(content.data(), content.size(), n_format, n_ref_seq, seqtype);
+    return;
+  }
+
   if (cmaple::verbose_mode >= cmaple::VB_MED) {
     std::cout << "Reading an alignment" << std::endl;
   }
 
   // Reset aln_base
   reset();
+  aln_format = n_format;
 
-  // Set format (if specified)
-  if (format != IN_AUTO && format != IN_UNKNOWN) {
-    aln_format = format;
-    // Otherwise, detect the format from the alignment
+  // Set seqtype. If it's auto (not specified), we'll dectect it later when
+  // reading the alignment
+  if (seqtype != SeqRegion::SEQ_UNKNOWN) {
+    setSeqType(seqtype);
   } else {
-    aln_format = detectInputFile(aln_stream);
+    setSeqType(SeqRegion::SEQ_AUTO);
+  }
 
-    // validate the format
-    if (aln_format == IN_UNKNOWN) {
-      throw std::invalid_argument(
-          "Failed to detect the format from the alignment!");
+  // Read the input alignment
+  try {
+    // in VCF format
+    if (aln_format == IN_VCF) {
+      readVcf(aln_stream, n_ref_seq);
+      // in FASTA or PHYLIP format
+    } else {
+      readFastaOrPhylip(aln_stream, n_ref_seq);
     }
+
+    finishReading();
+  } catch (std::logic_error& e) {
+    throw std::invalid_argument(e.what());
+  }
+}
+
+void cmaple::Alignment::readBuffer(
+    const char* const buffer,
+    const std::size_t size,
+    const InputType format,
+    const std::string& n_ref_seq,
+    const cmaple::SeqRegion::SeqType seqtype) {
+  assert(format == IN_MAPLE || format == IN_BINARY);
+  if (cmaple::verbose_mode >= cmaple::VB_MED) {
+    std::cout << "Reading an alignment" << std::endl;
   }
 
+  // Reset aln_base
+  reset();
+  aln_format = format;
+
   // Set seqtype. If it's auto (not specified), we'll dectect it later when
   // reading the alignment
   if (seqtype != SeqRegion::SEQ_UNKNOWN) {
@@ -74,36 +135,80 @@ void cmaple::Alignment::read(std::istream& aln_stream,
     setSeqType(SeqRegion::SEQ_AUTO);
   }
 
-  // Read the input alignment
   try {
-    // in FASTA or PHYLIP format
-    if (aln_format != IN_MAPLE) {
-      readFastaOrPhylip(aln_stream, n_ref_seq);
-      // in MAPLE format
-    } else {
-      if (n_ref_seq.length() && cmaple::verbose_mode > cmaple::VB_QUIET) {
-        outWarning(
-            "Ignore the input reference as it must be already "
-            "specified in the MAPLE format");
-      }
-      readMaple(aln_stream);
+    if (n_ref_seq.length() && cmaple::verbose_mode > cmaple::VB_QUIET) {
+      outWarning(format == IN_BINARY
+                     ? "Ignore the input reference as it is already stored "
+                       "in the binary alignment"
+                     : "Ignore the input reference as it must be already "
+                       "specified in the MAPLE format");
     }
 
-    // sort sequences by their distances to the reference sequence
-    sortSeqsByDistances();
-
-    // avoid using DNA build for protein data
-    if (NUM_STATES < num_states) {
-      throw std::invalid_argument(
-          "Look like you're using the wrong (DNA) compilation version for "
-          "Protein data. Please use the version for Protein data (*-aa) "
-          "instead.");
+    // sequences in the binary format are already sorted
+    if (format == IN_BINARY) {
+      readBinary(buffer, size);
+      finishReading(false);
+    } else {
+      readMaple(buffer, size);
+      finishReading();
     }
   } catch (std::logic_error& e) {
     throw std::invalid_argument(e.what());
   }
 }
 
+void cmaple::Alignment::finishReading(const bool sort_seqs) {
+  // sort sequences by their distances to the reference sequence
+  if (sort_seqs) {
+    sortSeqsByDistances();
+  }
+
+  // avoid using DNA build for protein data
+  if (NUM_STATES < num_states) {
+    throw std::invalid_argument(
+        "Look like you're using the wrong (DNA) compilation version for "
+        "Protein data. Please use the version for Protein data (*-aa) "
+        "instead.");
+  }
+}
+
+namespace {
+/**
+ A read-only stream buffer over a block of memory. Unlike std::istringstream,
+ it doesn't copy the content.
+ */
+class ViewStreamBuf : public std::streambuf {
+ public:
+  explicit ViewStreamBuf(const std::string_view content) {
+    // the buffer is never written (no putback of different characters)
+    char* const begin = const_cast<char*>(content.data());
+    setg(begin, begin, begin + content.size());
+  }
+
+ protected:
+  auto seekoff(off_type off,
+               std::ios_base::seekdir dir,
+               std::ios_base::openmode which) -> pos_type override {
+    const off_type size = egptr() - eback();
+    if (dir == std::ios_base::cur) {
+      off += gptr() - eback();
+    } else if (dir == std::ios_base::end) {
+      off += size;
+    }
+    if (!(which & std::ios_base::in) || off < 0 || off > size) {
+      return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + off, egptr());
+    return pos_type(off);
+  }
+
+  auto seekpos(pos_type pos, std::ios_base::openmode which)
+      -> pos_type override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+}  // namespace
+
 void cmaple::Alignment::read(const std::string& aln_filename,
                              const std::string& n_ref_seq,
                              const InputType format,
@@ -123,6 +228,54 @@ void cmaple::Alignment::read(const std::string& aln_filename,
     throw ios::failure(err_msg + aln_filename);
   }
 
+  // gzip-compressed files
+  if (isGzipFile(aln_filename)) {
+    aln_stream.close();
+
+    // BGZF files are decompressed into memory (in parallel), then parsed in
+    // place
+    if (isBgzfFile(aln_filename)) {
+      const std::string content = readGzipFile(aln_filename);
+      ViewStreamBuf content_buf(content);
+      std::istream content_stream(&content_buf);
+      const InputType n_format = (format != IN_AUTO && format != IN_UNKNOWN)
+                                     ? format
+                                     : detectInputFile(content_stream);
+      if (n_format == IN_MAPLE || n_format == IN_BINARY) {
+        readBuffer(content.data(), content.size(), n_format, n_ref_seq,
+                   seqtype);
+      } else {
+        read(content_stream, n_ref_seq, format, seqtype);
+      }
+      return;
+    }
+
+    // other gzip files are decompressed on the fly
+    igzstream gz_stream(aln_filename.c_str());
+    if (!gz_stream.rdbuf()->is_open()) {
+      std::string err_msg(ERR_READ_INPUT);
+      throw ios::failure(err_msg + aln_filename);
+    }
+    gz_stream.exceptions(ios::failbit | ios::badbit);
+    read(gz_stream, n_ref_seq, format, seqtype);
+    return;
+  }
+
+  // MAPLE and binary files are read directly from the memory-mapped file (if
+  // possible)
+  const InputType n_format = (format != IN_AUTO && format != IN_UNKNOWN)
+                                 ? format
+                                 : detectInputFile(aln_stream);
+  if (n_format == IN_MAPLE || n_format == IN_BINARY) {
+    const MemoryMappedFile mapped_file(aln_filename);
+    if (mapped_file.data()) {
+      aln_stream.close();
+      readBuffer(mapped_file.data(), mapped_file.size(), n_format, n_ref_seq,
+                 seqtype);
+      return;
+    }
+  }
+
   // Initialize an alignment instance from the input stream
   read(aln_stream, n_ref_seq, format, seqtype);
 
@@ -130,6 +283,154 @@ void cmaple::Alignment::read(const std::string& aln_filename,
   aln_stream.close();
 }
 
+void cmaple::Alignment::read(std::vector<Sequence>&& sequences,
+                             const std::string& n_ref_seq,
+                             const cmaple::SeqRegion::SeqType seqtype) {
+  // Reset aln_base
+  reset();
+
+  try {
+    if (!n_ref_seq.length()) {
+      throw std::logic_error("The reference sequence is empty");
+    }
+
+    // transform ref_sequence to uppercase
+    string ref_sequence(n_ref_seq);
+    transform(ref_sequence.begin(), ref_sequence.end(), ref_sequence.begin(),
+              ::toupper);
+
+    // Set seqtype or detect it from the reference sequence
+    if (seqtype != SeqRegion::SEQ_UNKNOWN && seqtype != SeqRegion::SEQ_AUTO) {
+      setSeqType(seqtype);
+    } else {
+      StrVector tmp_str_vec;
+      tmp_str_vec.push_back(ref_sequence);
+      setSeqType(detectSequenceType(tmp_str_vec));
+    }
+
+    // parse the reference sequence into vector of state
+    parseRefSeq(ref_sequence, true);
+
+    // take the sequences then validate them
+    data = std::move(sequences);
+    if (data.size() < MIN_NUM_TAXA) {
+      throw std::logic_error("The number of taxa must be at least " +
+                             convertIntToString(MIN_NUM_TAXA));
+    }
+    validateSequences();
+
+    finishReading();
+  } catch (std::logic_error& e) {
+    throw std::invalid_argument(e.what());
+  }
+}
+
+void cmaple::Alignment::addSequences(std::vector<Sequence>&& sequences) {
+  if (!data.size()) {
+    throw std::invalid_argument(
+        "Alignment is empty. Please call read(...) first!");
+  }
+
+  // append the new sequences then validate them
+  const std::vector<Sequence>::size_type first = data.size();
+  data.insert(data.end(), std::make_move_iterator(sequences.begin()),
+              std::make_move_iterator(sequences.end()));
+  try {
+    validateSequences(first);
+  } catch (std::logic_error& e) {
+    data.erase(data.begin() + static_cast<std::ptrdiff_t>(first), data.end());
+    throw std::invalid_argument(e.what());
+  }
+}
+
+void cmaple::Alignment::addSequences(std::istream& aln_stream) {
+  // read the whole records into a buffer
+  std::ostringstream buffer;
+  buffer << aln_stream.rdbuf();
+  const std::string records = std::move(buffer).str();
+
+  std::vector<Sequence> sequences;
+  try {
+    // the records must start by the name of a sequence
+    const std::string::size_type first_char =
+        records.find_first_not_of(" \t\r\n");
+    if (first_char != std::string::npos && records[first_char] != '>') {
+      throw std::logic_error(
+          "Invalid input. The records of sequences must start by a "
+          "'>' line. Please check and try again!");
+    }
+
+    parseMapleRecords(records.data(), records.data(),
+                      records.data() + records.size(), sequences);
+  } catch (std::logic_error& e) {
+    throw std::invalid_argument(e.what());
+  }
+  addSequences(std::move(sequences));
+}
+
+void cmaple::Alignment::validateSequences(
+    const std::vector<Sequence>::size_type first) {
+  const PositionType ref_length = static_cast<PositionType>(ref_seq.size());
+  const bool is_dna = getSeqType() == cmaple::SeqRegion::SEQ_DNA;
+  std::unordered_set<std::string_view> seq_names;
+  seq_names.reserve(data.size() - first);
+
+  // validate the names
+  for (std::vector<Sequence>::size_type i = first; i < data.size(); ++i) {
+    const Sequence& sequence = data[i];
+    if (!sequence.seq_name.length()) {
+      throw std::logic_error("Empty sequence name found");
+    }
+    if (!seq_names.insert(sequence.seq_name).second) {
+      throw std::logic_error("Duplicated sequence name " +
+                             sequence.seq_name);
+    }
+  }
+  for (std::vector<Sequence>::size_type i = 0; i < first; ++i) {
+    if (seq_names.find(data[i].seq_name) != seq_names.end()) {
+      throw std::logic_error("Duplicated sequence name " + data[i].seq_name);
+    }
+  }
+
+  for (std::vector<Sequence>::size_type i = first; i < data.size(); ++i) {
+    const Sequence& sequence = data[i];
+
+    // validate the mutations
+    PositionType prev_end = 0;
+    for (const Mutation& mutation : sequence) {
+      const StateType state = mutation.type;
+      // ambiguous DNA states are encoded as in convertChar2State()
+      const bool valid_state =
+          state < num_states || state == TYPE_N || state == TYPE_DEL ||
+          (is_dna && state > 3 + 2 && state < 3 + 15 &&
+           !std::has_single_bit(static_cast<unsigned>(state - 3)));
+      if (!valid_state) {
+        throw std::logic_error(
+            "Invalid state " + convertIntToString(state) + " of sequence " +
+            sequence.seq_name + " at position " +
+            convertPosTypeToString(mutation.position + 1));
+      }
+      if (mutation.getLength() <= 0 ||
+          (mutation.getLength() > 1 && state != TYPE_N &&
+           state != TYPE_DEL)) {
+        throw std::logic_error(
+            "Invalid length of the mutation of sequence " + sequence.seq_name +
+            " at position " + convertPosTypeToString(mutation.position + 1) +
+            ". Only mutation type N or - can have length greater than 1.");
+      }
+      if (mutation.position < prev_end ||
+          mutation.position + mutation.getLength() > ref_length) {
+        throw std::logic_error(
+            "Mutations of sequence " + sequence.seq_name +
+            " must be sorted by positions, not overlapping, and within the "
+            "reference sequence (position " +
+            convertPosTypeToString(mutation.position + 1) + ")");
+      }
+      prev_end = mutation.position + mutation.getLength();
+    }
+  }
+}
+
 void cmaple::Alignment::write(std::ostream& aln_stream,
                               const InputType& format) {
   assert(data.size() > 0);
@@ -150,6 +451,9 @@ void cmaple::Alignment::write(std::ostream& aln_stream,
     case IN_PHYLIP:
       writePHYLIP(aln_stream);
       break;
+    case IN_BINARY:
+      writeBinary(aln_stream);
+      break;
     case IN_AUTO:
     case IN_UNKNOWN:
     default:
@@ -178,8 +482,16 @@ void cmaple::Alignment::write(const std::string& aln_filename,
         " already exists. Please set overwrite = true to overwrite it.");
   }
 
+  // Write a gzip-compressed file if the filename ends by ".gz"
+  if (aln_filename.ends_with(".gz")) {
+    ogzstream aln_stream(aln_filename.c_str());
+    write(aln_stream, format);
+    aln_stream.close();
+    return;
+  }
+
   // Open a stream to write the output
-  std::ofstream aln_stream = ofstream(aln_filename);
+  std::ofstream aln_stream = ofstream(aln_filename, ios::out | ios::binary);
 
   // Write alignment to the stream
   write(aln_stream, format);
@@ -222,7 +534,8 @@ void cmaple::Alignment::reset() {
 
 void cmaple::Alignment::processSeq(string& sequence,
                                    string& line,
-                                   PositionType line_num) {
+                                   PositionType line_num,
+                                   bool show_notes) {
   for (string::iterator it = line.begin(); it != line.end(); ++it) {
     if ((*it) <= ' ') {
       continue;
@@ -240,7 +553,7 @@ void cmaple::Alignment::processSeq(string& sequence,
                                ": No matching close-bracket ) or } found");
       }
       sequence.append(1, '?');
-      if (cmaple::verbose_mode > cmaple::VB_QUIET) {
+      if (show_notes && cmaple::verbose_mode > cmaple::VB_QUIET) {
         cout << "NOTE: Line " << line_num << ": "
              << line.substr(static_cast<std::basic_string<char>
                             ::size_type>(start_it - line.begin()),
@@ -304,6 +617,10 @@ void cmaple::Alignment::readFasta(std::istream& aln_stream,
   }
 
   // now try to cut down sequence name if possible
+  shortenSeqNames(seq_names);
+}
+
+void cmaple::Alignment::shortenSeqNames(StrVector& seq_names) {
   std::vector<std::string>::size_type i = 0;
   PositionType step = 0;
   StrVector new_seq_names(0);
@@ -628,109 +945,113 @@ void cmaple::Alignment::extractMutations(const StrVector& str_sequences,
   }
 
   data.clear();
-  Sequence* sequence = nullptr;
-  std::vector<char>::size_type seq_length = ref_sequence.length();
 
   // extract mutations of sequences one by one
   for (std::vector<std::string>::size_type i = 0; i < str_sequences.size(); ++i) {
-    // validate the sequence length
-    string str_sequence = str_sequences[i];
-    if (seq_length != str_sequence.length()) {
-      throw std::logic_error(
-          "The sequence length of " + seq_names[static_cast<std::vector<std::string>
-                                                    ::size_type>(i)] + " (" +
-          convertIntToString(static_cast<int>(str_sequence.length())) +
-          ") is different from that of the reference sequence (" +
-          convertIntToString(static_cast<int>(ref_sequence.length())) + ")!");
-    }
+    extractMutations(str_sequences[i], seq_names[i], ref_sequence);
+  }
+}
 
-    // init new sequence instance for the inference process afterwards
-    data.push_back(string(seq_names[static_cast<std::vector<std::string>::size_type>(i)]));
-    sequence = &data.back();
+void cmaple::Alignment::extractMutations(const string& str_sequence,
+                                         const string& seq_name,
+                                         const string& ref_sequence) {
+  std::vector<char>::size_type seq_length = ref_sequence.length();
 
-    // init dummy variables
-    int state = 0;
-    PositionType length = 0;
-    for (std::basic_string<char>::size_type pos = 0; pos < seq_length; ++pos) {
-      switch (state) {
-        case 0:  // previous character is neither 'N' nor '-'
+  // validate the sequence length
+  if (seq_length != str_sequence.length()) {
+    throw std::logic_error(
+        "The sequence length of " + seq_name + " (" +
+        convertIntToString(static_cast<int>(str_sequence.length())) +
+        ") is different from that of the reference sequence (" +
+        convertIntToString(static_cast<int>(ref_sequence.length())) + ")!");
+  }
+
+  // init new sequence instance for the inference process afterwards
+  data.push_back(string(seq_name));
+  Sequence* sequence = &data.back();
+
+  // init dummy variables
+  int state = 0;
+  PositionType length = 0;
+  for (std::basic_string<char>::size_type pos = 0; pos < seq_length; ++pos) {
+    switch (state) {
+      case 0:  // previous character is neither 'N' nor '-'
+        if (str_sequence[pos] != ref_sequence[pos]) {
+          length = 1;
+
+          // starting a sequence of 'N'
+          if (toupper(str_sequence[pos]) == 'N' &&
+              getSeqType() == cmaple::SeqRegion::SEQ_DNA) {
+            state = 1;
+            // starting a sequence of '-'
+          } else if (str_sequence[pos] == '-') {
+            state = 2;
+            // output a mutation
+          } else {
+            addMutation(sequence, str_sequence[pos], static_cast<PositionType>(pos));
+          }
+        }
+        break;
+      case 1:  // previous character is 'N'
+        // inscrease the length if the current character is still 'N'
+        if (toupper(str_sequence[pos]) == 'N' &&
+            str_sequence[pos] != ref_sequence[pos]) {
+          ++length;
+        } else {
+          // output the previous sequence of 'N'
+          addMutation(sequence, str_sequence[pos - 1], (static_cast<PositionType>(pos)) - length, length);
+
+          // reset state
+          state = 0;
+
+          // handle new character different from the reference
           if (str_sequence[pos] != ref_sequence[pos]) {
             length = 1;
+            // starting a sequence of '-'
+            if (str_sequence[pos] == '-') {
+              state = 2;
+              // output a mutation
+            } else {
+              addMutation(sequence, str_sequence[pos], static_cast<PositionType>(pos));
+              state = 0;
+            }
+          }
+        }
+        break;
+      case 2:  // previous character is '-'
+        // inscrease the length if the current character is still '-'
+        if (toupper(str_sequence[pos]) == '-' &&
+            str_sequence[pos] != ref_sequence[pos]) {
+          ++length;
+        } else {
+          // output the previous sequence of '-'
+          addMutation(sequence, str_sequence[pos - 1], (static_cast<PositionType>(pos)) - length, length);
 
+          // reset state
+          state = 0;
+
+          // handle new character different from the reference
+          if (str_sequence[pos] != ref_sequence[pos]) {
+            length = 1;
             // starting a sequence of 'N'
             if (toupper(str_sequence[pos]) == 'N' &&
                 getSeqType() == cmaple::SeqRegion::SEQ_DNA) {
               state = 1;
-              // starting a sequence of '-'
-            } else if (str_sequence[pos] == '-') {
-              state = 2;
               // output a mutation
             } else {
               addMutation(sequence, str_sequence[pos], static_cast<PositionType>(pos));
+              state = 0;
             }
           }
-          break;
-        case 1:  // previous character is 'N'
-          // inscrease the length if the current character is still 'N'
-          if (toupper(str_sequence[pos]) == 'N' &&
-              str_sequence[pos] != ref_sequence[pos]) {
-            ++length;
-          } else {
-            // output the previous sequence of 'N'
-            addMutation(sequence, str_sequence[pos - 1], (static_cast<PositionType>(pos)) - length, length);
-
-            // reset state
-            state = 0;
-
-            // handle new character different from the reference
-            if (str_sequence[pos] != ref_sequence[pos]) {
-              length = 1;
-              // starting a sequence of '-'
-              if (str_sequence[pos] == '-') {
-                state = 2;
-                // output a mutation
-              } else {
-                addMutation(sequence, str_sequence[pos], static_cast<PositionType>(pos));
-                state = 0;
-              }
-            }
-          }
-          break;
-        case 2:  // previous character is '-'
-          // inscrease the length if the current character is still '-'
-          if (toupper(str_sequence[pos]) == '-' &&
-              str_sequence[pos] != ref_sequence[pos]) {
-            ++length;
-          } else {
-            // output the previous sequence of '-'
-            addMutation(sequence, str_sequence[pos - 1], (static_cast<PositionType>(pos)) - length, length);
-
-            // reset state
-            state = 0;
-
-            // handle new character different from the reference
-            if (str_sequence[pos] != ref_sequence[pos]) {
-              length = 1;
-              // starting a sequence of 'N'
-              if (toupper(str_sequence[pos]) == 'N' &&
-                  getSeqType() == cmaple::SeqRegion::SEQ_DNA) {
-                state = 1;
-                // output a mutation
-              } else {
-                addMutation(sequence, str_sequence[pos], static_cast<PositionType>(pos));
-                state = 0;
-              }
-            }
-          }
-          break;
-      }
+        }
+        break;
     }
+  }
 
-    //  output the last sequence of 'N' or '-' (if any)
-    if (state != 0) {
-      addMutation(sequence, str_sequence[str_sequence.length() - 1],
-                  (static_cast<PositionType>(str_sequence.length())) - length, length);
-    }
+  //  output the last sequence of 'N' or '-' (if any)
+  if (state != 0) {
+    addMutation(sequence, str_sequence[str_sequence.length() - 1],
+                (static_cast<PositionType>(str_sequence.length())) - length, length);
   }
 }
 
@@ -764,33 +1085,72 @@ void cmaple::Alignment::parseRefSeq(string& ref_sequence, bool throw_error) {
   }
 }
 
-void cmaple::Alignment::readMaple(std::istream& aln_stream) {
-  // init dummy variables
-  string seq_name;
-  vector<Mutation> mutations;
-  PositionType line_num = 1;
-  string line;
+namespace {
+/**
+ Extract the line starting at pos (without the line ending) then move pos to
+ the beginning of the next line. Like safeGetline(), "\n", "\r\n", and "\r"
+ are all accepted as line endings.
+ */
+inline auto getMappedLine(const char*& pos, const char* const end)
+    -> std::string_view {
+  const char* line_end = pos;
+  while (line_end < end && *line_end != '\n' && *line_end != '\r') {
+    ++line_end;
+  }
+  const std::string_view line(pos, static_cast<size_t>(line_end - pos));
+  if (line_end < end && *line_end == '\r' && line_end + 1 < end &&
+      line_end[1] == '\n') {
+    ++line_end;
+  }
+  pos = line_end < end ? line_end + 1 : end;
+  return line;
+}
 
-  // set the failbit and badbit
-  aln_stream.exceptions(ios::failbit | ios::badbit);
-  // remove the failbit
-  aln_stream.exceptions(ios::badbit);
+/**
+ Get the (1-based) line number of a position in a buffer
+ */
+inline auto getLineNumber(const char* const buffer, const char* const pos)
+    -> PositionType {
+  return static_cast<PositionType>(std::count(buffer, pos, '\n')) + 1;
+}
+
+/**
+ Parse a non-negative integer from a token
+ @throw std::invalid_argument if the token is not an integer
+ */
+inline auto parsePositionToken(const std::string_view token)
+    -> PositionType {
+  PositionType value = 0;
+  const char* const token_end = token.data() + token.size();
+  const auto [ptr, ec] = std::from_chars(token.data(), token_end, value);
+  if (token.empty() || ec != std::errc() || ptr != token_end) {
+    throw std::invalid_argument("Expecting integer, but found \"" +
+                                std::string(token) + "\" instead");
+  }
+  return value;
+}
+}  // namespace
+
+void cmaple::Alignment::readMaple(const char* const buffer,
+                                  const std::size_t size) {
+  const char* const buffer_end = buffer + size;
+  const char* pos = buffer;
+  string seq_name;
 
   if (cmaple::verbose_mode >= cmaple::VB_MAX) {
-    cout << "Reading an alignment in MAPLE format from a stream" << endl;
+    cout << "Reading an alignment in MAPLE format from memory" << endl;
   }
 
   // extract reference sequence first
-  for (; !aln_stream.eof(); ++line_num) {
-    safeGetline(aln_stream, line);
-    if (line == "") {
+  while (pos < buffer_end) {
+    const std::string_view line = getMappedLine(pos, buffer_end);
+    if (line.empty()) {
       continue;
     }
 
     // read the first line (">REF")
     if (line[0] == '>') {
-      string::size_type pos = line.find_first_of("\n\r");
-      seq_name = line.substr(1, pos - 1);
+      seq_name.assign(line.substr(1));
 
       // transform seq_name to upper case
       transform(seq_name.begin(), seq_name.end(), seq_name.begin(), ::toupper);
@@ -809,32 +1169,93 @@ void cmaple::Alignment::readMaple(std::istream& aln_stream) {
       }
 
       // transform ref_sequence to uppercase
-      transform(line.begin(), line.end(), line.begin(), ::toupper);
+      string ref_line(line);
+      transform(ref_line.begin(), ref_line.end(), ref_line.begin(),
+                ::toupper);
 
       // detect the seq_type from the ref_sequences
       const cmaple::SeqRegion::SeqType current_seq_type = getSeqType();
       if (current_seq_type == cmaple::SeqRegion::SEQ_AUTO ||
           current_seq_type == cmaple::SeqRegion::SEQ_UNKNOWN) {
         StrVector tmp_str_vec;
-        tmp_str_vec.push_back(line);
+        tmp_str_vec.push_back(ref_line);
         setSeqType(detectSequenceType(tmp_str_vec));
       }
 
       // parse the reference sequence into vector of state
-      parseRefSeq(line, true);
-
-      // reset the seq_name
-      seq_name = "";
+      parseRefSeq(ref_line, true);
 
       // break to read sequences of other taxa
       break;
     }
   }
 
-  // extract sequences of other taxa one by one
-  for (; !aln_stream.eof(); ++line_num) {
-    safeGetline(aln_stream, line);
-    if (line == "") {
+  // split the remaining records into chunks at the beginnings of records
+  std::vector<const char*> boundaries{pos};
+  for (const char* split = pos + MAPLE_CHUNK_SIZE; split < buffer_end;
+       split = boundaries.back() + MAPLE_CHUNK_SIZE) {
+    while (split < buffer_end &&
+           (*split != '>' || (split[-1] != '\n' && split[-1] != '\r'))) {
+      ++split;
+    }
+    if (split >= buffer_end) {
+      break;
+    }
+    boundaries.push_back(split);
+  }
+  boundaries.push_back(buffer_end);
+
+  // parse chunks in parallel
+  const size_t num_chunks = boundaries.size() - 1;
+  std::vector<std::vector<Sequence>> chunk_sequences(num_chunks);
+  std::vector<std::exception_ptr> chunk_errors(num_chunks);
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < num_chunks; ++i) {
+    try {
+      parseMapleRecords(buffer, boundaries[i], boundaries[i + 1],
+                        chunk_sequences[i]);
+    } catch (...) {
+      chunk_errors[i] = std::current_exception();
+    }
+  }
+  for (const std::exception_ptr& error : chunk_errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // record sequences in their input order
+  size_t num_seqs = 0;
+  for (const std::vector<Sequence>& sequences : chunk_sequences) {
+    num_seqs += sequences.size();
+  }
+  data.reserve(num_seqs);
+  for (std::vector<Sequence>& sequences : chunk_sequences) {
+    std::move(sequences.begin(), sequences.end(), std::back_inserter(data));
+  }
+
+  // validate the input
+  if (ref_seq.size() == 0) {
+    throw std::logic_error("Reference sequence is not found!");
+  }
+  if (data.size() < MIN_NUM_TAXA) {
+    throw std::logic_error("The number of taxa must be at least " +
+                           convertIntToString(MIN_NUM_TAXA));
+  }
+}
+
+void cmaple::Alignment::parseMapleRecords(const char* const buffer,
+                                          const char* const begin,
+                                          const char* const end,
+                                          std::vector<Sequence>& sequences) {
+  const PositionType ref_length = static_cast<PositionType>(ref_seq.size());
+  string seq_name;
+  vector<Mutation> mutations;
+
+  for (const char* pos = begin; pos < end;) {
+    const char* const line_begin = pos;
+    const std::string_view line = getMappedLine(pos, end);
+    if (line.empty()) {
       continue;
     }
 
@@ -842,7 +1263,7 @@ void cmaple::Alignment::readMaple(std::istream& aln_stream) {
     if (line[0] == '>') {
       // record the sequence of the previous taxon
       if (seq_name.length()) {
-        data.emplace_back(std::move(seq_name), std::move(mutations));
+        sequences.emplace_back(std::move(seq_name), std::move(mutations));
 
         // reset dummy variables
         seq_name.clear();
@@ -850,89 +1271,381 @@ void cmaple::Alignment::readMaple(std::istream& aln_stream) {
       }
 
       // Read new sequence name
-      string::size_type pos = line.find_first_of("\n\r");
-      seq_name = line.substr(1, pos - 1);
+      seq_name.assign(line.substr(1));
       if (!seq_name.length()) {
-        throw std::logic_error("Empty sequence name found at line " +
-                               convertIntToString(line_num) +
-                               ". Please check and try again!");
+        throw std::logic_error(
+            "Empty sequence name found at line " +
+            convertIntToString(getLineNumber(buffer, line_begin)) +
+            ". Please check and try again!");
       }
     }
     // Read a Mutation
     else {
       // validate the input
-      char separator = '\t';
-      long num_items = std::count(line.begin(), line.end(), separator) + 1;
+      const auto num_items = std::count(line.begin(), line.end(), '\t') + 1;
       if (num_items < 2 || num_items > 3) {
         throw std::logic_error(
             "Invalid input. Each difference must be presented be <Type>    "
             "<Position>  [<Length>]. Please check and try again!");
       }
 
-      // extract mutation info
-      stringstream ssin(line);
-      string tmp;
+      // split the line into (at most 3) whitespace-separated tokens
+      std::array<std::string_view, 3> tokens;
+      size_t num_tokens = 0;
+      for (size_t i = 0; i < line.size() && num_tokens < tokens.size();) {
+        if (isspace(static_cast<unsigned char>(line[i]))) {
+          ++i;
+          continue;
+        }
+        const size_t token_begin = i;
+        while (i < line.size() &&
+               !isspace(static_cast<unsigned char>(line[i]))) {
+          ++i;
+        }
+        tokens[num_tokens++] = line.substr(token_begin, i - token_begin);
+      }
+      if (num_tokens < 2) {
+        throw std::logic_error(
+            "Invalid input. Each difference must be presented be <Type>    "
+            "<Position>  [<Length>]. Please check and try again!");
+      }
 
       // extract <Type>
-      ssin >> tmp;
-      StateType state = convertChar2State(toupper(tmp[0]));
+      StateType state =
+          convertChar2State(static_cast<char>(toupper(tokens[0][0])));
 
       // extract <Position>
-      ssin >> tmp;
-      PositionType pos = convert_positiontype(tmp.c_str());
-      if (pos <= 0 || pos > static_cast<PositionType>(ref_seq.size())) {
+      const PositionType pos_mut = parsePositionToken(tokens[1]);
+      if (pos_mut <= 0 || pos_mut > ref_length) {
         throw std::logic_error(
             "<Position> must be greater than 0 and less than the reference "
             "sequence length (" +
-            convertPosTypeToString(static_cast<PositionType>(ref_seq.size())) + ")!");
+            convertPosTypeToString(ref_length) + ")!");
       }
 
       // extract <Length>
       PositionType length = 1;
-      if (ssin.good()) {
-        ssin >> tmp;
+      if (num_tokens > 2) {
         if (state == TYPE_N || state == TYPE_DEL) {
-          length = convert_positiontype(tmp.c_str());
+          length = parsePositionToken(tokens[2]);
           if (length <= 0) {
             throw std::logic_error("<Length> must be greater than 0!");
           }
-          if (length + pos - 1 > static_cast<PositionType>(ref_seq.size())) {
+          if (length + pos_mut - 1 > ref_length) {
             throw std::logic_error(
                 "<Length> + <Position> must be less than the reference "
                 "sequence length (" +
-                convertPosTypeToString(static_cast<PositionType>(ref_seq.size())) + ")!");
+                convertPosTypeToString(ref_length) + ")!");
           }
         } else if (cmaple::verbose_mode >= cmaple::VB_MED) {
-          outWarning("Ignoring <Length> of " + tmp +
+          outWarning("Ignoring <Length> of " + std::string(tokens[2]) +
                      ". <Length> is only appliable for 'N' or '-'.");
         }
       }
 
       // add a new mutation into mutations
       if (state == TYPE_N || state == TYPE_DEL) {
-        mutations.emplace_back(state, pos - 1, length);
+        mutations.emplace_back(state, pos_mut - 1, length);
       } else {
-        mutations.emplace_back(state, pos - 1);
+        mutations.emplace_back(state, pos_mut - 1);
       }
     }
   }
 
-  // Record the sequence of  the last taxon
+  // Record the sequence of the last taxon
   if (seq_name.length()) {
-    data.emplace_back(std::move(seq_name), std::move(mutations));
+    sequences.emplace_back(std::move(seq_name), std::move(mutations));
+  }
+}
+
+namespace {
+/** Magic bytes of the binary alignment format */
+const char BINARY_ALN_MAGIC[8] = {'C', 'M', 'A', 'P', 'L', 'E', 'B', 'A'};
+/** Version of the binary alignment format */
+const uint32_t BINARY_ALN_VERSION = 2;
+/** Marker to detect files written on a machine with another byte order */
+const uint32_t BINARY_ALN_BYTE_ORDER = 0x01020304;
+
+/** Header of the binary alignment format */
+struct BinaryAlnHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t mutation_size;
+  uint32_t seq_type;
+  uint64_t ref_length;
+  uint64_t num_seqs;
+  uint64_t num_mutations;
+  uint64_t names_length;
+  uint64_t ref_offset;
+  uint64_t index_offset;
+  uint64_t mutations_offset;
+  uint64_t names_offset;
+};
+
+/** Index entry of a sequence in the binary alignment format */
+struct BinaryAlnIndexEntry {
+  uint64_t mutation_start;
+  uint64_t num_mutations;
+  uint64_t name_start;
+  uint64_t name_length;
+};
+
+/**
+ A mutation in the binary alignment format. The fields are stored explicitly
+ (instead of the raw bytes of Mutation) so that no padding bytes are written.
+ */
+struct BinaryAlnMutation {
+  int32_t position;
+  int16_t length;
+  uint16_t type;
+};
+
+static_assert(sizeof(BinaryAlnMutation) == 8,
+              "BinaryAlnMutation must not contain padding bytes");
+static_assert(sizeof(PositionType) <= sizeof(int32_t) &&
+                  sizeof(LengthType) <= sizeof(int16_t) &&
+                  sizeof(StateType) <= sizeof(uint16_t),
+              "Mutation fields must fit in BinaryAlnMutation");
+
+/**
+ Check if a section of num_elements elements (each of elem_size bytes) starting
+ at offset lies within a buffer of size bytes (without overflowing)
+ */
+inline auto isInBuffer(const uint64_t offset,
+                       const uint64_t num_elements,
+                       const uint64_t elem_size,
+                       const std::size_t size) -> bool {
+  return offset <= size && num_elements <= (size - offset) / elem_size;
+}
+
+/** Round up an offset to a multiple of 8 bytes */
+inline auto alignOffset(const uint64_t offset) -> uint64_t {
+  return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+/**
+ Validate and extract the header of a binary alignment
+ @throw std::logic_error if the buffer is not a valid binary alignment
+ */
+auto getBinaryAlnHeader(const char* const buffer, const std::size_t size)
+    -> BinaryAlnHeader {
+  BinaryAlnHeader header;
+  if (size < sizeof(header)) {
+    throw std::logic_error("Invalid binary alignment: file is truncated");
+  }
+  memcpy(&header, buffer, sizeof(header));
+  if (memcmp(header.magic, BINARY_ALN_MAGIC, sizeof(BINARY_ALN_MAGIC))) {
+    throw std::logic_error("Invalid binary alignment: unknown file type");
+  }
+  if (header.version != BINARY_ALN_VERSION) {
+    throw std::logic_error("Unsupported version of binary alignment: " +
+                           convertIntToString(static_cast<int>(header.version)));
+  }
+  if (header.byte_order != BINARY_ALN_BYTE_ORDER ||
+      header.mutation_size != sizeof(BinaryAlnMutation)) {
+    throw std::logic_error(
+        "Binary alignment was written on an incompatible platform/version. "
+        "Please re-create it from the text alignment.");
+  }
+  if (!isInBuffer(header.ref_offset, header.ref_length, sizeof(StateType),
+                  size) ||
+      !isInBuffer(header.index_offset, header.num_seqs,
+                  sizeof(BinaryAlnIndexEntry), size) ||
+      !isInBuffer(header.mutations_offset, header.num_mutations,
+                  sizeof(BinaryAlnMutation), size) ||
+      !isInBuffer(header.names_offset, header.names_length, 1, size)) {
+    throw std::logic_error("Invalid binary alignment: file is truncated");
+  }
+  if (header.seq_type != cmaple::SeqRegion::SEQ_DNA &&
+      header.seq_type != cmaple::SeqRegion::SEQ_PROTEIN) {
+    throw std::logic_error("Invalid binary alignment: unknown sequence type");
+  }
+  if (header.ref_length >
+      static_cast<uint64_t>(std::numeric_limits<PositionType>::max())) {
+    throw std::logic_error(
+        "Invalid binary alignment: reference sequence is too long");
+  }
+  return header;
+}
+
+/**
+ Extract a sequence from a binary alignment
+ @throw std::logic_error if the index entry is invalid
+ */
+auto getBinarySequence(const char* const buffer,
+                       const BinaryAlnHeader& header,
+                       const size_t seq_index) -> Sequence {
+  BinaryAlnIndexEntry entry;
+  memcpy(&entry,
+         buffer + header.index_offset + seq_index * sizeof(BinaryAlnIndexEntry),
+         sizeof(entry));
+  if (entry.mutation_start > header.num_mutations ||
+      entry.num_mutations > header.num_mutations - entry.mutation_start ||
+      entry.name_start > header.names_length ||
+      entry.name_length > header.names_length - entry.name_start) {
+    throw std::logic_error("Invalid binary alignment: corrupted index");
+  }
+
+  vector<Mutation> mutations;
+  mutations.reserve(entry.num_mutations);
+  const char* mutation_bytes = buffer + header.mutations_offset +
+                               entry.mutation_start * sizeof(BinaryAlnMutation);
+  for (uint64_t i = 0; i < entry.num_mutations;
+       ++i, mutation_bytes += sizeof(BinaryAlnMutation)) {
+    BinaryAlnMutation mutation;
+    memcpy(&mutation, mutation_bytes, sizeof(mutation));
+    if (mutation.position < 0 || mutation.length <= 0) {
+      throw std::logic_error("Invalid binary alignment: corrupted mutation");
+    }
+    mutations.emplace_back(mutation.type, mutation.position, mutation.length);
+  }
+  return Sequence(string(buffer + header.names_offset + entry.name_start,
+                         entry.name_length),
+                  std::move(mutations));
+}
+}  // namespace
+
+auto cmaple::Alignment::isBinaryAln(std::istream& aln_stream) -> bool {
+  // don't throw if the stream is shorter than the magic bytes
+  const std::ios::iostate exceptions = aln_stream.exceptions();
+  aln_stream.exceptions(ios::badbit);
+
+  char magic[sizeof(BINARY_ALN_MAGIC)];
+  aln_stream.read(magic, sizeof(magic));
+  const bool is_binary = aln_stream.gcount() == sizeof(magic) &&
+                         !memcmp(magic, BINARY_ALN_MAGIC, sizeof(magic));
+
+  resetStream(aln_stream);
+  aln_stream.exceptions(exceptions);
+  return is_binary;
+}
+
+void cmaple::Alignment::readBinary(const char* const buffer,
+                                   const std::size_t size) {
+  if (cmaple::verbose_mode >= cmaple::VB_MAX) {
+    cout << "Reading an alignment in the binary format" << endl;
+  }
+
+  const BinaryAlnHeader header = getBinaryAlnHeader(buffer, size);
+  setSeqType(static_cast<cmaple::SeqRegion::SeqType>(header.seq_type));
+
+  // the reference sequence
+  ref_seq.resize(header.ref_length);
+  if (header.ref_length) {
+    memcpy(ref_seq.data(), buffer + header.ref_offset,
+           header.ref_length * sizeof(StateType));
+  }
+
+  // the (sorted) sequences
+  data.clear();
+  data.reserve(header.num_seqs);
+  for (size_t i = 0; i < header.num_seqs; ++i) {
+    data.push_back(getBinarySequence(buffer, header, i));
   }
 
   // validate the input
-  assert(ref_seq.size() > 0);
   if (ref_seq.size() == 0) {
     throw std::logic_error("Reference sequence is not found!");
   }
+  for (const StateType state : ref_seq) {
+    if (state >= num_states) {
+      throw std::logic_error(
+          "Invalid binary alignment: invalid reference state " +
+          convertIntToString(state));
+    }
+  }
   if (data.size() < MIN_NUM_TAXA) {
     throw std::logic_error("The number of taxa must be at least " +
                            convertIntToString(MIN_NUM_TAXA));
   }
+  validateSequences();
+}
 
-  resetStream(aln_stream);
+auto cmaple::Alignment::readBinarySequence(const std::string& aln_filename,
+                                           const size_t seq_index)
+    -> Sequence {
+  const MemoryMappedFile mapped_file(aln_filename);
+  if (!mapped_file.data()) {
+    throw ios::failure(string(ERR_READ_INPUT) + " " + aln_filename);
+  }
+
+  try {
+    const BinaryAlnHeader header =
+        getBinaryAlnHeader(mapped_file.data(), mapped_file.size());
+    if (seq_index >= header.num_seqs) {
+      throw std::logic_error("Sequence index " +
+                             convertInt64ToString(static_cast<int64_t>(seq_index)) +
+                             " is out of range");
+    }
+    return getBinarySequence(mapped_file.data(), header, seq_index);
+  } catch (std::logic_error& e) {
+    throw std::invalid_argument(e.what());
+  }
+}
+
+void cmaple::Alignment::writeBinary(std::ostream& aln_stream) {
+  // compute the layout
+  BinaryAlnHeader header{};
+  memcpy(header.magic, BINARY_ALN_MAGIC, sizeof(BINARY_ALN_MAGIC));
+  header.version = BINARY_ALN_VERSION;
+  header.byte_order = BINARY_ALN_BYTE_ORDER;
+  header.mutation_size = sizeof(BinaryAlnMutation);
+  header.seq_type = static_cast<uint32_t>(getSeqType());
+  header.ref_length = ref_seq.size();
+  header.num_seqs = data.size();
+
+  std::vector<BinaryAlnIndexEntry> index(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    index[i] = {header.num_mutations, data[i].size(), header.names_length,
+                data[i].seq_name.length()};
+    header.num_mutations += data[i].size();
+    header.names_length += data[i].seq_name.length();
+  }
+
+  header.ref_offset = alignOffset(sizeof(header));
+  header.index_offset =
+      alignOffset(header.ref_offset + header.ref_length * sizeof(StateType));
+  header.mutations_offset = alignOffset(
+      header.index_offset + header.num_seqs * sizeof(BinaryAlnIndexEntry));
+  header.names_offset = alignOffset(
+      header.mutations_offset +
+      header.num_mutations * sizeof(BinaryAlnMutation));
+
+  // write all parts (padded to 8-byte boundaries)
+  uint64_t offset = 0;
+  const auto write_bytes = [&aln_stream, &offset](const void* const bytes,
+                                                  const uint64_t length) {
+    aln_stream.write(static_cast<const char*>(bytes),
+                     static_cast<std::streamsize>(length));
+    offset += length;
+  };
+  const auto pad_to = [&aln_stream, &offset](const uint64_t target) {
+    for (; offset < target; ++offset) {
+      aln_stream.put('\0');
+    }
+  };
+
+  write_bytes(&header, sizeof(header));
+  pad_to(header.ref_offset);
+  write_bytes(ref_seq.data(), header.ref_length * sizeof(StateType));
+  pad_to(header.index_offset);
+  write_bytes(index.data(), header.num_seqs * sizeof(BinaryAlnIndexEntry));
+  pad_to(header.mutations_offset);
+  std::vector<BinaryAlnMutation> binary_mutations;
+  for (const Sequence& sequence : data) {
+    binary_mutations.clear();
+    for (const Mutation& mutation : sequence) {
+      binary_mutations.push_back(
+          {mutation.position, mutation.getLength(), mutation.type});
+    }
+    write_bytes(binary_mutations.data(),
+                binary_mutations.size() * sizeof(BinaryAlnMutation));
+  }
+  pad_to(header.names_offset);
+  for (const Sequence& sequence : data) {
+    write_bytes(sequence.seq_name.data(), sequence.seq_name.length());
+  }
 }
 
 auto cmaple::Alignment::convertState2Char(
@@ -1345,6 +2058,13 @@ void cmaple::Alignment::readFastaOrPhylip(std::istream& aln_stream,
   if (aln_format == IN_UNKNOWN) {
     throw std::logic_error("Unknown alignment format");
   }
+
+  // FASTA records are converted one by one without keeping all sequences
+  if (aln_format == IN_FASTA) {
+    readFastaStreaming(aln_stream, n_ref_seq);
+    return;
+  }
+
   StrVector sequences;
   StrVector seq_names;
   readSequences(aln_stream, sequences, seq_names, aln_format);
@@ -1387,51 +2107,638 @@ void cmaple::Alignment::readFastaOrPhylip(std::istream& aln_stream,
   extractMutations(sequences, seq_names, ref_sequence);
 }
 
-auto cmaple::Alignment::detectSequenceType(StrVector& sequences)
-    -> cmaple::SeqRegion::SeqType {
-  size_t num_nuc = 0;
-  size_t num_ungap = 0;
-  size_t num_bin = 0;
-  size_t num_alpha = 0;
-  size_t num_digit = 0;
-  double detectStart = getRealTime();
-  size_t sequenceCount = sequences.size();
-  assert(sequenceCount > 0);
+void cmaple::Alignment::readFastaStreaming(std::istream& aln_stream,
+                                           const std::string& n_ref_seq) {
+  const cmaple::SeqRegion::SeqType current_seq_type = getSeqType();
+  const bool detect_seq_type =
+      current_seq_type == cmaple::SeqRegion::SEQ_AUTO ||
+      current_seq_type == cmaple::SeqRegion::SEQ_UNKNOWN;
+  string ref_sequence = n_ref_seq;
+
+  // pass 1: detect the data type and build the reference sequence
+  if (detect_seq_type || !ref_sequence.length()) {
+    const char NULL_CHAR = '\0';
+    const char GAP = '-';
+    // the number of times each character appears at each site
+    std::vector<std::array<PositionType, 128>> num_appear;
+    // generateRef() picks the first character reaching half of the number of
+    // sequences, which is only known at the end of this pass. The highest
+    // count of (non-gap) characters at each site, and the characters raising
+    // it (each with the count it started from), tell which character reached
+    // any count first.
+    std::vector<PositionType> max_counts;
+    std::vector<std::vector<std::pair<PositionType, char>>> leaders;
+    string ref_str;
+    std::array<size_t, 5> char_counts{};
+    size_t num_records = 0;
+
+    readFastaRecords(
+        aln_stream,
+        [&](string& seq_name, string& sequence) {
+          // make sure all sequences have the same length
+          if (!num_records++) {
+            if (!ref_sequence.length()) {
+              num_appear.resize(sequence.length(),
+                                std::array<PositionType, 128>{});
+              max_counts.resize(sequence.length(), 0);
+              leaders.resize(sequence.length());
+              ref_str.assign(sequence.length(), NULL_CHAR);
+            }
+          } else if (sequence.length() != num_appear.size() &&
+                     !ref_sequence.length()) {
+            throw std::logic_error(
+                "Sequence " + seq_name +
+                " has a different length compared to the first sequence.");
+          }
 
-  // #pragma omp parallel for
-  // reduction(+:num_nuc,num_ungap,num_bin,num_alpha,num_digit)
-  for (size_t seqNum = 0; seqNum < sequenceCount; ++seqNum) {
-    auto start = sequences.at(seqNum).data();
-    auto stop = start + sequences.at(seqNum).size();
-    for (auto i = start; i != stop; ++i) {
-      if ((*i) == 'A' || (*i) == 'C' || (*i) == 'G' || (*i) == 'T' ||
-          (*i) == 'U') {
-        ++num_nuc;
-        ++num_ungap;
-        continue;
+          if (detect_seq_type) {
+            countSeqTypeChars(sequence, char_counts);
+          }
+
+          // count characters at each site
+          if (!ref_sequence.length()) {
+            for (size_t i = 0; i < ref_str.length(); ++i) {
+              const char c = sequence[i];
+              const PositionType count =
+                  ++num_appear[i][static_cast<unsigned char>(c) & 127];
+              if (c != GAP && count > max_counts[i]) {
+                max_counts[i] = count;
+                if (leaders[i].empty() || leaders[i].back().second != c) {
+                  leaders[i].emplace_back(count, c);
+                }
+              }
+            }
+          }
+        },
+        false);
+
+    // validate the input sequences
+    if (num_records < MIN_NUM_TAXA) {
+      throw std::logic_error("There must be at least " +
+                             convertIntToString(MIN_NUM_TAXA) + " sequences");
+    }
+
+    // detect the type of the input sequences
+    if (detect_seq_type) {
+      setSeqType(detectSequenceType(char_counts));
+    }
+
+    // generate reference sequence from the input sequences
+    if (!ref_sequence.length()) {
+      if (!ref_str.length()) {
+        throw std::logic_error(
+            "Empty input sequences. Please check & try again!");
       }
-      if ((*i) == '?' || (*i) == '-' || (*i) == '.') {
-        continue;
+      if (cmaple::verbose_mode >= cmaple::VB_MAX) {
+        cout << "Generating a reference sequence from the input alignment..."
+             << endl;
       }
-      if (*i != 'N' && *i != 'X' && (*i) != '~') {
-        num_ungap++;
-        if (isdigit(*i)) {
-          num_digit++;
-          if ((*i) == '0' || (*i) == '1') {
-            num_bin++;
+
+      const char DEFAULT_CHAR =
+          cmaple::Alignment::convertState2Char(0, seq_type_);
+      const PositionType threshold =
+          static_cast<PositionType>(num_records * 0.5);
+      for (size_t i = 0; i < ref_str.length(); ++i) {
+        // pick the character that first reached the threshold (if any)
+        if (max_counts[i] >= threshold) {
+          ref_str[i] =
+              std::prev(std::upper_bound(
+                            leaders[i].begin(), leaders[i].end(), threshold,
+                            [](const PositionType count,
+                               const std::pair<PositionType, char>& leader) {
+                              return count < leader.first;
+                            }))
+                  ->second;
+        }
+
+        // manually determine the most popular charater for the current site
+        // (if no character dominates all the others)
+        if (ref_str[i] == NULL_CHAR) {
+          PositionType max_count = 0;
+          for (size_t c = 0; c < num_appear[i].size(); ++c) {
+            if (static_cast<char>(c) != GAP && num_appear[i][c] > max_count) {
+              max_count = num_appear[i][c];
+              ref_str[i] = static_cast<char>(c);
+            }
           }
         }
+
+        // if not found -> all characters in this site are gaps -> choose the
+        // default state
+        if (ref_str[i] == NULL_CHAR) {
+          ref_str[i] = DEFAULT_CHAR;
+        }
+      }
+      ref_sequence = std::move(ref_str);
+    }
+  }
+
+  // parse ref_sequence into vector of states
+  parseRefSeq(ref_sequence, false);
+
+  assert(ref_sequence.length() > 0);
+
+  // pass 2: convert each sequence into mutations right after reading it
+  data.clear();
+  readFastaRecords(aln_stream, [&](string& seq_name, string& sequence) {
+    extractMutations(sequence, seq_name, ref_sequence);
+  });
+
+  // validate the input sequences
+  if (data.size() < MIN_NUM_TAXA) {
+    throw std::logic_error("There must be at least " +
+                           convertIntToString(MIN_NUM_TAXA) + " sequences");
+  }
+
+  // now try to cut down sequence name if possible
+  StrVector seq_names(data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    seq_names[i] = data[i].seq_name;
+  }
+  shortenSeqNames(seq_names);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i].seq_name = std::move(seq_names[i]);
+  }
+}
+
+void cmaple::Alignment::readFastaRecords(
+    std::istream& aln_stream,
+    const std::function<void(std::string&, std::string&)>& process_record,
+    bool show_notes) {
+  PositionType line_num = 1;
+  string line;
+  string seq_name;
+  string sequence;
+  bool found_record = false;
+
+  // remove the failbit
+  aln_stream.exceptions(ios::badbit);
+
+  for (; !aln_stream.eof(); ++line_num) {
+    safeGetline(aln_stream, line);
+    if (line == "") {
+      continue;
+    }
+
+    if (line[0] == '>') {  // next sequence
+      // process the previous record
+      if (found_record) {
+        process_record(seq_name, sequence);
+      }
+      found_record = true;
+
+      string::size_type pos = line.find_first_of("\n\r");
+      seq_name = line.substr(1, pos - 1);
+      trimString(seq_name);
+      sequence.clear();
+      continue;
+    }
+
+    // read sequence contents
+    if (!found_record) {
+      throw std::logic_error(
+          "First line must begin with '>' to define sequence name");
+    }
+
+    processSeq(sequence, line, line_num, show_notes);
+  }
+
+  // process the last record
+  if (found_record) {
+    process_record(seq_name, sequence);
+  }
+
+  // set the failbit again
+  aln_stream.exceptions(ios::failbit | ios::badbit);
+  // reset the stream
+  resetStream(aln_stream);
+}
+
+namespace {
+/**
+ Extract the next field (delimited by a delimiter) from a line then move the
+ line to the beginning of the following field
+ */
+inline auto nextVcfField(std::string_view& line, const char delimiter)
+    -> std::string_view {
+  const std::string_view::size_type pos = line.find(delimiter);
+  const std::string_view field = line.substr(0, pos);
+  line = pos == std::string_view::npos ? std::string_view()
+                                       : line.substr(pos + 1);
+  return field;
+}
+
+/**
+ Add a mutation into the mutations of a sample. Mutations overlapped by the
+ previous one (e.g., a deletion of a previous record) are ignored, and
+ consecutive 'N' are merged into one mutation.
+ */
+inline void addVcfMutation(std::vector<Mutation>& mutations,
+                           const StateType state,
+                           const PositionType pos,
+                           const PositionType length = 1) {
+  if (mutations.size()) {
+    const Mutation& prev_mutation = mutations.back();
+    const PositionType prev_end =
+        prev_mutation.position + prev_mutation.getLength();
+    if (pos < prev_end) {
+      return;
+    }
+    if (state == TYPE_N && prev_mutation.type == TYPE_N && pos == prev_end &&
+        prev_end + length - prev_mutation.position <=
+            std::numeric_limits<LengthType>::max()) {
+      mutations.back() = Mutation(TYPE_N, prev_mutation.position,
+                                  prev_end + length - prev_mutation.position);
+      return;
+    }
+  }
+
+  if (state == TYPE_N || state == TYPE_DEL) {
+    mutations.emplace_back(state, pos, length);
+  } else {
+    mutations.emplace_back(state, pos);
+  }
+}
+
+/**
+ Get the state of a nucleotide allele (A, C, G, T), or TYPE_INVALID if it's not
+ a (single) nucleotide
+ */
+inline auto getVcfNucleotideState(const std::string_view allele)
+    -> StateType {
+  if (allele.size() != 1) {
+    return TYPE_INVALID;
+  }
+  switch (toupper(allele[0])) {
+    case 'A':
+      return 0;
+    case 'C':
+      return 1;
+    case 'G':
+      return 2;
+    case 'T':
+      return 3;
+    default:
+      return TYPE_INVALID;
+  }
+}
+}  // namespace
+
+void cmaple::Alignment::readVcf(std::istream& aln_stream,
+                                const std::string& n_ref_seq) {
+  if (!n_ref_seq.length()) {
+    throw std::logic_error(
+        "Please specify the reference sequence to read an alignment in VCF "
+        "format");
+  }
+
+  // VCF only contains nucleotide data
+  const cmaple::SeqRegion::SeqType current_seq_type = getSeqType();
+  if (current_seq_type == cmaple::SeqRegion::SEQ_AUTO ||
+      current_seq_type == cmaple::SeqRegion::SEQ_UNKNOWN) {
+    setSeqType(cmaple::SeqRegion::SEQ_DNA);
+  } else if (current_seq_type != cmaple::SeqRegion::SEQ_DNA) {
+    throw std::logic_error("VCF format is only supported for DNA data");
+  }
+
+  if (cmaple::verbose_mode >= cmaple::VB_MAX) {
+    cout << "Reading an alignment in VCF format from a stream" << endl;
+  }
+
+  // parse the reference sequence into vector of states (keep the original
+  // sequence to validate the REF alleles)
+  string ref_sequence(n_ref_seq);
+  transform(ref_sequence.begin(), ref_sequence.end(), ref_sequence.begin(),
+            ::toupper);
+  const string original_ref_sequence(ref_sequence);
+  parseRefSeq(ref_sequence, false);
+  const PositionType ref_length = static_cast<PositionType>(ref_seq.size());
+
+  // remove the failbit
+  aln_stream.exceptions(ios::badbit);
+
+  // init dummy variables
+  const size_t NUM_FIXED_COLUMNS = 9;
+  string line;
+  string chrom;
+  PositionType line_num = 0;
+  PositionType prev_pos = 0;
+  bool header_found = false;
+  std::vector<std::string_view> alts;
+  std::vector<int> allele_indexes;
+
+  while (!aln_stream.eof()) {
+    safeGetline(aln_stream, line);
+    ++line_num;
+    if (line.empty() || line.starts_with("##")) {
+      continue;
+    }
+    std::string_view rest(line);
+
+    // the header line -> init a sequence for each sample
+    if (line[0] == '#') {
+      if (header_found) {
+        throw std::logic_error("Duplicated header line found at line " +
+                               convertIntToString(line_num));
+      }
+      header_found = true;
+      for (size_t i = 0; i < NUM_FIXED_COLUMNS; ++i) {
+        nextVcfField(rest, '\t');
+      }
+      while (rest.size()) {
+        const std::string_view sample_name = nextVcfField(rest, '\t');
+        if (sample_name.empty()) {
+          throw std::logic_error("Empty sample name found in the header line");
+        }
+        data.emplace_back(string(sample_name));
+      }
+      if (data.empty()) {
+        throw std::logic_error("No sample found in the VCF file");
+      }
+      continue;
+    }
+    if (!header_found) {
+      throw std::logic_error(
+          "VCF file must contain a header line (#CHROM...) before the "
+          "records. Please check and try again!");
+    }
+
+    // extract the fixed columns of a record
+    const std::string_view record_chrom = nextVcfField(rest, '\t');
+    const std::string_view pos_str = nextVcfField(rest, '\t');
+    nextVcfField(rest, '\t');  // ID
+    const std::string_view ref_allele = nextVcfField(rest, '\t');
+    std::string_view alt_str = nextVcfField(rest, '\t');
+    nextVcfField(rest, '\t');  // QUAL
+    nextVcfField(rest, '\t');  // FILTER
+    nextVcfField(rest, '\t');  // INFO
+    std::string_view format = nextVcfField(rest, '\t');
+    if (ref_allele.empty() || format.empty()) {
+      throw std::logic_error("Invalid VCF record at line " +
+                             convertIntToString(line_num) +
+                             ". Please check and try again!");
+    }
+
+    // validate the chromosome and the position
+    if (chrom.empty()) {
+      chrom = record_chrom;
+    } else if (chrom != record_chrom) {
+      throw std::logic_error(
+          "Found records of multiple chromosomes (" + chrom + ", " +
+          string(record_chrom) +
+          "). Only VCF files of a single chromosome are supported.");
+    }
+    PositionType pos = 0;
+    try {
+      pos = parsePositionToken(pos_str);
+    } catch (std::invalid_argument& e) {
+      throw std::logic_error(string(e.what()) + " at line " +
+                             convertIntToString(line_num));
+    }
+    const PositionType ref_allele_length =
+        static_cast<PositionType>(ref_allele.size());
+    if (pos <= 0 || pos + ref_allele_length - 1 > ref_length) {
+      throw std::logic_error(
+          "<Position> must be greater than 0 and less than the reference "
+          "sequence length (" +
+          convertPosTypeToString(ref_length) + ") at line " +
+          convertIntToString(line_num));
+    }
+    if (pos < prev_pos) {
+      throw std::logic_error("VCF records must be sorted by positions (line " +
+                             convertIntToString(line_num) + ")");
+    }
+    prev_pos = pos;
+    --pos;
+
+    // validate the REF allele
+    for (PositionType i = 0; i < ref_allele_length; ++i) {
+      const char ref_char = static_cast<char>(toupper(ref_allele[i]));
+      if (ref_char != original_ref_sequence[pos + i] && ref_char != 'N' &&
+          original_ref_sequence[pos + i] != 'N') {
+        throw std::logic_error(
+            "The REF allele " + string(ref_allele) + " at line " +
+            convertIntToString(line_num) +
+            " doesn't match the reference sequence. Please check and try "
+            "again!");
+      }
+    }
+
+    // extract the ALT alleles
+    alts.clear();
+    alts.push_back(ref_allele);
+    while (alt_str.size()) {
+      alts.push_back(nextVcfField(alt_str, ','));
+    }
+
+    // locate the GT field
+    int gt_index = -1;
+    for (int i = 0; format.size(); ++i) {
+      if (nextVcfField(format, ':') == "GT") {
+        gt_index = i;
+        break;
+      }
+    }
+    if (gt_index < 0) {
+      throw std::logic_error("GT field is not found at line " +
+                             convertIntToString(line_num));
+    }
+
+    // add the mutations of an allele into a sample
+    const auto add_allele = [&](Sequence& sequence,
+                                const std::string_view allele) {
+      // a spanning deletion -> already handled by the record of the deletion
+      if (allele == "*") {
+        return;
+      }
+      // a symbolic allele -> unknown
+      if (allele.empty() || allele[0] == '<') {
+        addVcfMutation(sequence, TYPE_N, pos, ref_allele_length);
+        return;
+      }
+
+      // a deletion at the beginning of the reference is padded by the base
+      // after the event
+      const PositionType allele_length =
+          static_cast<PositionType>(allele.size());
+      if (!pos && allele_length < ref_allele_length &&
+          ref_allele.ends_with(allele)) {
+        addVcfMutation(sequence, TYPE_DEL, pos,
+                       ref_allele_length - allele_length);
+        return;
+      }
+
+      // substitutions
+      const PositionType common_length =
+          std::min(allele_length, ref_allele_length);
+      for (PositionType i = 0; i < common_length; ++i) {
+        const StateType state =
+            convertChar2State(static_cast<char>(toupper(allele[i])));
+        if (state != ref_seq[pos + i]) {
+          addVcfMutation(sequence, state, pos + i);
+        }
+      }
+      // a deletion (inserted bases are ignored as in other formats)
+      if (ref_allele_length > allele_length) {
+        addVcfMutation(sequence, TYPE_DEL, pos + allele_length,
+                       ref_allele_length - allele_length);
+      }
+    };
+
+    // convert the genotype calls of samples one by one
+    for (Sequence& sequence : data) {
+      if (rest.data() == nullptr) {
+        throw std::logic_error(
+            "The number of samples at line " + convertIntToString(line_num) +
+            " is less than that in the header line");
+      }
+      std::string_view sample = nextVcfField(rest, '\t');
+      for (int i = 0; i < gt_index; ++i) {
+        nextVcfField(sample, ':');
+      }
+      std::string_view genotype = nextVcfField(sample, ':');
+
+      // parse the allele indexes (haploid or polyploid, phased or unphased)
+      allele_indexes.clear();
+      while (genotype.size()) {
+        const std::string_view::size_type sep_pos =
+            genotype.find_first_of("/|");
+        const std::string_view allele_str = genotype.substr(0, sep_pos);
+        genotype = sep_pos == std::string_view::npos
+                       ? std::string_view()
+                       : genotype.substr(sep_pos + 1);
+        if (allele_str == ".") {
+          continue;
+        }
+        int allele_index = 0;
+        const char* const allele_str_end =
+            allele_str.data() + allele_str.size();
+        const auto [ptr, ec] =
+            std::from_chars(allele_str.data(), allele_str_end, allele_index);
+        if (allele_str.empty() || ec != std::errc() || ptr != allele_str_end ||
+            allele_index < 0 ||
+            allele_index >= static_cast<int>(alts.size())) {
+          throw std::logic_error("Invalid genotype " + string(allele_str) +
+                                 " of sample " + sequence.seq_name +
+                                 " at line " + convertIntToString(line_num));
+        }
+        if (std::find(allele_indexes.begin(), allele_indexes.end(),
+                      allele_index) == allele_indexes.end()) {
+          allele_indexes.push_back(allele_index);
+        }
       }
-      if (isalpha(*i)) {
-        num_alpha++;
+
+      // missing data
+      if (allele_indexes.empty()) {
+        addVcfMutation(sequence, TYPE_N, pos, ref_allele_length);
+        // a single allele
+      } else if (allele_indexes.size() == 1) {
+        if (allele_indexes[0]) {
+          add_allele(sequence, alts[static_cast<size_t>(allele_indexes[0])]);
+        }
+        // heterozygous calls of nucleotides -> an ambiguous state
+        // (otherwise, unknown)
+      } else {
+        int state_bits = 0;
+        for (const int allele_index : allele_indexes) {
+          const StateType state = getVcfNucleotideState(
+              alts[static_cast<size_t>(allele_index)]);
+          if (state == TYPE_INVALID) {
+            state_bits = 0;
+            break;
+          }
+          state_bits |= 1 << state;
+        }
+        if (!state_bits || state_bits == 15) {
+          addVcfMutation(sequence, TYPE_N, pos, ref_allele_length);
+        } else if (std::has_single_bit(static_cast<unsigned>(state_bits))) {
+          add_allele(sequence, alts[static_cast<size_t>(allele_indexes[0])]);
+        } else {
+          // the same encoding of ambiguous states as in convertChar2State()
+          addVcfMutation(sequence, static_cast<StateType>(state_bits + 3),
+                         pos);
+        }
       }
     }
-  }  // end OMP parallel for
+    if (rest.data() != nullptr) {
+      throw std::logic_error(
+          "The number of samples at line " + convertIntToString(line_num) +
+          " is greater than that in the header line");
+    }
+  }
+
+  // validate the input
+  if (data.size() < MIN_NUM_TAXA) {
+    throw std::logic_error("The number of taxa must be at least " +
+                           convertIntToString(MIN_NUM_TAXA));
+  }
+
+  // set the failbit again
+  aln_stream.exceptions(ios::failbit | ios::badbit);
+
+  // reset the stream
+  resetStream(aln_stream);
+}
+
+auto cmaple::Alignment::detectSequenceType(StrVector& sequences)
+    -> cmaple::SeqRegion::SeqType {
+  double detectStart = getRealTime();
+  size_t sequenceCount = sequences.size();
+  assert(sequenceCount > 0);
+
+  std::array<size_t, 5> char_counts{};
+  for (size_t seqNum = 0; seqNum < sequenceCount; ++seqNum) {
+    countSeqTypeChars(sequences.at(seqNum), char_counts);
+  }
 
   if (verbose_mode >= VB_DEBUG) {
     cout << "Sequence Type detection took " << (getRealTime() - detectStart)
          << " seconds." << endl;
   }
+  return detectSequenceType(char_counts);
+}
+
+void cmaple::Alignment::countSeqTypeChars(const std::string& sequence,
+                                          std::array<size_t, 5>& char_counts) {
+  size_t& num_nuc = char_counts[0];
+  size_t& num_ungap = char_counts[1];
+  size_t& num_bin = char_counts[2];
+  size_t& num_alpha = char_counts[3];
+  size_t& num_digit = char_counts[4];
+
+  auto start = sequence.data();
+  auto stop = start + sequence.size();
+  for (auto i = start; i != stop; ++i) {
+    if ((*i) == 'A' || (*i) == 'C' || (*i) == 'G' || (*i) == 'T' ||
+        (*i) == 'U') {
+      ++num_nuc;
+      ++num_ungap;
+      continue;
+    }
+    if ((*i) == '?' || (*i) == '-' || (*i) == '.') {
+      continue;
+    }
+    if (*i != 'N' && *i != 'X' && (*i) != '~') {
+      num_ungap++;
+      if (isdigit(*i)) {
+        num_digit++;
+        if ((*i) == '0' || (*i) == '1') {
+          num_bin++;
+        }
+      }
+    }
+    if (isalpha(*i)) {
+      num_alpha++;
+    }
+  }
+}
+
+auto cmaple::Alignment::detectSequenceType(
+    const std::array<size_t, 5>& char_counts) -> cmaple::SeqRegion::SeqType {
+  const size_t num_nuc = char_counts[0];
+  const size_t num_ungap = char_counts[1];
+  const size_t num_alpha = char_counts[3];
+
   if (static_cast<double>(num_nuc) / num_ungap > 0.9) {
     if (cmaple::verbose_mode >= cmaple::VB_DEBUG) {
       std::cout << "DNA data detected." << std::endl;
@@ -1526,8 +2833,28 @@ auto cmaple::Alignment::detectMAPLEorFASTA(std::istream& aln_stream)
   return cmaple::Alignment::IN_FASTA;
 }
 
+auto cmaple::Alignment::detectVCF(std::istream& aln_stream)
+    -> cmaple::Alignment::InputType {
+  // VCF files start by the meta-information (##fileformat=VCF...) or the header
+  string line;
+  aln_stream.exceptions(ios::badbit);
+  safeGetline(aln_stream, line);
+  aln_stream.exceptions(ios::failbit | ios::badbit);
+  resetStream(aln_stream);
+
+  if (line.starts_with("##fileformat=VCF") || line.starts_with("#CHROM")) {
+    return cmaple::Alignment::IN_VCF;
+  }
+  return cmaple::Alignment::IN_UNKNOWN;
+}
+
 auto cmaple::Alignment::detectInputFile(std::istream& aln_stream)
     -> cmaple::Alignment::InputType {
+  // detect the binary format from its magic bytes
+  if (isBinaryAln(aln_stream)) {
+    return cmaple::Alignment::IN_BINARY;
+  }
+
   unsigned char ch = ' ';
   unsigned char ch2 = ' ';
   int count = 0;
@@ -1539,6 +2866,8 @@ auto cmaple::Alignment::detectInputFile(std::istream& aln_stream)
   resetStream(aln_stream);
   switch (ch) {
     // case '#': return IN_NEXUS;
+    case '#':
+      return detectVCF(aln_stream);
     // case '(': return IN_NEWICK;
     // case '[': return IN_NEWICK;
     case '>':
@@ -1571,6 +2900,12 @@ auto cmaple::Alignment::parseAlnFormat(const std::string& n_format)
   if (format == "FASTA") {
     return cmaple::Alignment::IN_FASTA;
   }
+  if (format == "BINARY") {
+    return cmaple::Alignment::IN_BINARY;
+  }
+  if (format == "VCF") {
+    return cmaple::Alignment::IN_VCF;
+  }
   if (format == "AUTO") {
     return cmaple::Alignment::IN_AUTO;
   }
@@ -1,3 +1,4 @@
+#include <functional>
 #include "../utils/timeutil.h"
 #include "sequence.h"
 
@@ -18,6 +19,8 @@ class Alignment {
                    format */
     IN_AUTO,    /*!< Auto detect */
     IN_UNKNOWN, /*!< Unknown format */
+    IN_BINARY,  /*!< CMAPLE binary format (sorted sequences with an index) */
+    IN_VCF,     /*!< VCF format (genotype calls against a reference sequence) */
   };
 
   // ----------------- BEGIN OF PUBLIC APIs ------------------------------------
@@ -31,9 +34,10 @@ class Alignment {
    * @param[in] aln_stream A stream of an alignment file
    * @param[in] ref_seq A reference sequence (optional). If not specified, it
    *            will be read from the alignment (in MAPLE format) or
-   * automatically generated from the alignment (in FASTA or PHYLIP format)
+   * automatically generated from the alignment (in FASTA or PHYLIP format).
+   * It is required for alignments in VCF format
    * @param[in] format Format of the alignment (optional): IN_MAPLE, IN_FASTA,
-   *            IN_PHYLIP, or IN_AUTO (auto detection)
+   *            IN_PHYLIP, IN_BINARY, IN_VCF, or IN_AUTO (auto detection)
    * @param[in] seqtype Data type of sequences (optional): SEQ_DNA (nucleotide
    *            data), SEQ_PROTEIN (amino acid data), or SEQ_AUTO (auto
    *            detection)
@@ -52,9 +56,10 @@ class Alignment {
    * @param[in] aln_filename Name of an alignment file
    * @param[in] ref_seq A reference sequence (optional). If not specified, it
    *            will be read from the alignment (in MAPLE format) or
-   * automatically generated from the alignment (in FASTA or PHYLIP format)
+   * automatically generated from the alignment (in FASTA or PHYLIP format).
+   * It is required for alignments in VCF format
    * @param[in] format Format of the alignment (optional): IN_MAPLE, IN_FASTA,
-   *            IN_PHYLIP, or IN_AUTO (auto detection)
+   *            IN_PHYLIP, IN_BINARY, IN_VCF, or IN_AUTO (auto detection)
    * @param[in] seqtype Data type of sequences (optional): SEQ_DNA (nucleotide
    *            data), SEQ_PROTEIN (amino acid data), or SEQ_AUTO (auto
    * detection)
@@ -70,6 +75,29 @@ class Alignment {
       const InputType format = IN_AUTO,
       const cmaple::SeqRegion::SeqType seqtype = cmaple::SeqRegion::SEQ_AUTO);
 
+  /*! \brief Constructor from sequences (i.e., lists of mutations) already in
+   * memory, without any round-trip through a text format
+   * @param[in] sequences The sequences (moved into the alignment). Each
+   * sequence has a (unique) name and a list of mutations compared with the
+   * reference sequence, sorted by their (0-based) positions and not
+   * overlapping. A mutation state is an ID as returned by convertState2Char()
+   * (e.g., 0-3 for A, C, G, T in DNA), TYPE_N, or TYPE_DEL; only TYPE_N and
+   * TYPE_DEL can have a length greater than 1
+   * @param[in] ref_seq The reference sequence
+   * @param[in] seqtype Data type of sequences (optional): SEQ_DNA (nucleotide
+   *            data), SEQ_PROTEIN (amino acid data), or SEQ_AUTO (auto
+   * detection from the reference sequence)
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - the reference sequence is empty or contains invalid states
+   * - the number of sequences is less than 3
+   * - any sequence has an empty or duplicated name
+   * - any mutation has an invalid state, position, or length
+   */
+  Alignment(
+      std::vector<Sequence>&& sequences,
+      const std::string& ref_seq,
+      const cmaple::SeqRegion::SeqType seqtype = cmaple::SeqRegion::SEQ_AUTO);
+
   /*! \brief Destructor
    */
   ~Alignment();
@@ -79,9 +107,10 @@ class Alignment {
    * @param[in] aln_stream A stream of an alignment file
    * @param[in] ref_seq A reference sequence (optional). If not specified, it
    * will be read from the alignment (in MAPLE format) or automatically
-   * generated from the alignment (in FASTA or PHYLIP format)
+   * generated from the alignment (in FASTA or PHYLIP format). It is required
+   * for alignments in VCF format
    * @param[in] format Format of the alignment (optional): IN_MAPLE, IN_FASTA,
-   * IN_PHYLIP, or IN_AUTO (auto detection)
+   * IN_PHYLIP, IN_BINARY, IN_VCF, or IN_AUTO (auto detection)
    * @param[in] seqtype Data type of sequences (optional): SEQ_DNA (nucleotide
    * data), SEQ_PROTEIN (amino acid data), or SEQ_AUTO (auto detection)
    * @throw std::invalid\_argument if any of the following situations occur.
@@ -99,9 +128,10 @@ class Alignment {
    * @param[in] aln_filename Name of an alignment file
    * @param[in] ref_seq A reference sequence (optional). If not specified, it
    * will be read from the alignment (in MAPLE format) or automatically
-   * generated from the alignment (in FASTA or PHYLIP format)
+   * generated from the alignment (in FASTA or PHYLIP format). It is required
+   * for alignments in VCF format
    * @param[in] format Format of the alignment (optional): IN_MAPLE, IN_FASTA,
-   * IN_PHYLIP, or IN_AUTO (auto detection)
+   * IN_PHYLIP, IN_BINARY, IN_VCF, or IN_AUTO (auto detection)
    * @param[in] seqtype Data type of sequences (optional): SEQ_DNA (nucleotide
    * data), SEQ_PROTEIN (amino acid data), or SEQ_AUTO (auto detection)
    * @throw std::invalid\_argument if any of the following situations occur.
@@ -116,21 +146,72 @@ class Alignment {
       const InputType format = IN_AUTO,
       const cmaple::SeqRegion::SeqType seqtype = cmaple::SeqRegion::SEQ_AUTO);
 
-  /** \brief Write the alignment to a stream in FASTA, PHYLIP, or
-   * [MAPLE](https://www.nature.com/articles/s41588-023-01368-0) format
+  /*! \brief Set the alignment from sequences (i.e., lists of mutations)
+   * already in memory, without any round-trip through a text format
+   * @param[in] sequences The sequences (moved into the alignment). Each
+   * sequence has a (unique) name and a list of mutations compared with the
+   * reference sequence, sorted by their (0-based) positions and not
+   * overlapping. A mutation state is an ID as returned by convertState2Char()
+   * (e.g., 0-3 for A, C, G, T in DNA), TYPE_N, or TYPE_DEL; only TYPE_N and
+   * TYPE_DEL can have a length greater than 1
+   * @param[in] ref_seq The reference sequence
+   * @param[in] seqtype Data type of sequences (optional): SEQ_DNA (nucleotide
+   * data), SEQ_PROTEIN (amino acid data), or SEQ_AUTO (auto detection from
+   * the reference sequence)
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - the reference sequence is empty or contains invalid states
+   * - the number of sequences is less than 3
+   * - any sequence has an empty or duplicated name
+   * - any mutation has an invalid state, position, or length
+   */
+  void read(
+      std::vector<Sequence>&& sequences,
+      const std::string& ref_seq,
+      const cmaple::SeqRegion::SeqType seqtype = cmaple::SeqRegion::SEQ_AUTO);
+
+  /*! \brief Add new sequences (i.e., lists of mutations) to the alignment,
+   * keeping the existing sequences (and their order) unchanged. The trees
+   * attached to the alignment place the new sequences at their next
+   * doPlacement() without re-processing the existing ones.
+   * @param[in] sequences The new sequences (moved into the alignment), in the
+   * same form as in read(sequences, ref_seq, seqtype)
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - the alignment is empty
+   * - any new sequence has an empty name or a name that already exists
+   * - any mutation has an invalid state, position, or length
+   */
+  void addSequences(std::vector<Sequence>&& sequences);
+
+  /*! \brief Add new sequences in
+   * [MAPLE](https://www.nature.com/articles/s41588-023-01368-0) format (i.e.,
+   * the records of the sequences without the reference sequence) to the
+   * alignment, keeping the existing sequences unchanged
+   * @param[in] aln_stream A stream of the new sequences
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - the alignment is empty
+   * - the records are in an incorrect format
+   * - any new sequence has an empty name or a name that already exists
+   * - any mutation has an invalid state, position, or length
+   */
+  void addSequences(std::istream& aln_stream);
+
+  /** \brief Write the alignment to a stream in FASTA, PHYLIP,
+   * [MAPLE](https://www.nature.com/articles/s41588-023-01368-0), or binary
+   * format
    * @param[in] aln_stream A stream of the output alignment file
    * @param[in] format Format of the output alignment (optional): IN_MAPLE,
-   * IN_FASTA, or IN_PHYLIP
+   * IN_FASTA, IN_PHYLIP, or IN_BINARY
    * @throw std::invalid\_argument if the format is unknown
    * @throw std::logic\_error if the alignment is empty (i.e., nothing to write)
    */
   void write(std::ostream& aln_stream, const InputType& format = IN_MAPLE);
 
-  /** \brief Write the alignment to a file in FASTA, PHYLIP, or
-   * [MAPLE](https://www.nature.com/articles/s41588-023-01368-0) format
+  /** \brief Write the alignment to a file in FASTA, PHYLIP,
+   * [MAPLE](https://www.nature.com/articles/s41588-023-01368-0), or binary
+   * format
    * @param[in] aln_filename Name of the output alignment file
    * @param[in] format Format of the output alignment (optional): IN_MAPLE,
-   * IN_FASTA, or IN_PHYLIP
+   * IN_FASTA, IN_PHYLIP, or IN_BINARY
    * @param[in] overwrite TRUE to overwrite the existing output file (optional)
    * @throw std::invalid\_argument if any of the following situations occur.
    * - aln_filename is empty
@@ -144,6 +225,18 @@ class Alignment {
              const InputType& format = IN_MAPLE,
              const bool overwrite = false);
 
+  /** \brief Read a single sequence from an alignment file in the binary
+   * format (written by write(..., IN_BINARY)) without loading the others
+   * @param[in] aln_filename Name of the alignment file
+   * @param[in] seq_index Index of the sequence (in the order of data)
+   * @return the sequence
+   * @throw std::invalid\_argument if the file is not a valid binary
+   * alignment or seq\_index is out of range
+   * @throw ios::failure if the file cannot be mapped into memory
+   */
+  static Sequence readBinarySequence(const std::string& aln_filename,
+                                     const size_t seq_index);
+
   // ----------------- END OF PUBLIC APIs ------------------------------------
   // //
 
@@ -240,6 +333,23 @@ class Alignment {
    */
   cmaple::SeqRegion::SeqType detectSequenceType(cmaple::StrVector& sequences);
 
+  /**
+   Count the characters of a sequence that are used to detect the data type
+   @param sequence a sequence
+   @param[in,out] char_counts the numbers of nucleotide, ungapped, binary,
+   alphabet, and digit characters
+   */
+  static void countSeqTypeChars(const std::string& sequence,
+                                std::array<size_t, 5>& char_counts);
+
+  /**
+   detect the data type from the counts of characters
+   @param char_counts the counts computed by countSeqTypeChars()
+   @return the data type of the input sequences
+   */
+  static cmaple::SeqRegion::SeqType detectSequenceType(
+      const std::array<size_t, 5>& char_counts);
+
   /**
    Compute the distance between a sequence and the ref sequence
    distance = num_differents * hamming_weight + num_ambiguities
@@ -280,14 +390,96 @@ class Alignment {
                         const std::string& ref_sequence);
 
   /**
-   Read an alignment in MAPLE format from a stream
-   @param aln_stream A stream of an alignment file
+   Extract Mutation from a sequence regarding the reference sequence, then
+   add that sequence into data
+   @param str_sequence a sequence
+   @param seq_name the sequence name
+   @param ref_sequence the reference sequence
+   @throw std::logic\_error if any of the following situations occur.
+   - the length of the sequence is different from that of the reference genome
+   - the sequence contains invalid states
+   */
+  void extractMutations(const std::string& str_sequence,
+                        const std::string& seq_name,
+                        const std::string& ref_sequence);
+
+  /**
+   Read an alignment in MAPLE format from a memory buffer (e.g., a
+   memory-mapped file or the content of a stream), parsing mutations directly from the bytes. Records
+   of taxa are split into chunks at '>' lines and parsed in parallel.
+   @param buffer the content of a MAPLE file
+   @param size the size of the buffer
    @throw std::logic\_error if any of the following situations occur.
    - the alignment is empty or in an incorrect format
    - the sequences contain invalid states
    - unexpected values/behaviors found during the operations
    */
-  void readMaple(std::istream& aln_stream);
+  void readMaple(const char* const buffer, const std::size_t size);
+
+  /**
+   Parse the records of taxa (in MAPLE format) in a chunk of a buffer
+   @param buffer the whole buffer (to compute line numbers in error messages)
+   @param begin, end the chunk, which starts by a '>' line (except for the
+   first chunk)
+   @param[out] sequences the parsed sequences
+   @throw std::logic\_error if the records are in an incorrect format
+   */
+  void parseMapleRecords(const char* const buffer,
+                         const char* const begin,
+                         const char* const end,
+                         std::vector<Sequence>& sequences);
+
+  /**
+   Read an alignment from the content of a MAPLE or binary file in memory
+   (e.g., a memory-mapped or decompressed file, or the content of a stream)
+   @param buffer the content of the file
+   @param size the size of the buffer
+   @param format the format of the alignment: IN_MAPLE or IN_BINARY
+   @param n_ref_seq the reference sequence (ignored)
+   @param seqtype the data type of sequences
+   @throw std::invalid\_argument if the alignment is invalid
+   */
+  void readBuffer(const char* const buffer,
+                  const std::size_t size,
+                  const InputType format,
+                  const std::string& n_ref_seq,
+                  const cmaple::SeqRegion::SeqType seqtype);
+
+  /**
+   Read an alignment in the binary format from a memory buffer. Sequences
+   are already sorted, so they are not sorted again.
+   @param buffer the content of a binary alignment file
+   @param size the size of the buffer
+   @throw std::logic\_error if the buffer is not a valid binary alignment
+   */
+  void readBinary(const char* const buffer, const std::size_t size);
+
+  /**
+   Write the alignment in the binary format: a header, the reference, an
+   index of (mutation offset, number of mutations, name offset, name length)
+   per sequence, all mutations, then all names
+   @param aln_stream the output stream
+   */
+  void writeBinary(std::ostream& aln_stream);
+
+  /**
+   Sort sequences and validate the data after reading an alignment
+   @param sort_seqs TRUE to sort sequences by their distances to the
+   reference
+   @throw std::invalid\_argument if the data doesn't fit the compiled
+   number of states
+   */
+  void finishReading(const bool sort_seqs = true);
+
+  /**
+   Validate the names and the mutations of the sequences against the
+   reference sequence
+   @param first the index of the first sequence to validate; the names of the
+   validated sequences must also differ from those of the sequences before it
+   @throw std::logic\_error if any sequence has an empty or duplicated name,
+   or any mutation has an invalid state, position, or length
+   */
+  void validateSequences(const std::vector<Sequence>::size_type first = 0);
 
   /**
    Read an alignment in FASTA or PHYLIP format from a stream
@@ -300,6 +492,52 @@ class Alignment {
   void readFastaOrPhylip(std::istream& aln_stream,
                          const std::string& ref_seq = "");
 
+  /**
+   Read an alignment in FASTA format from a stream in two passes without
+   keeping all sequences in memory. The first pass detects the data type and
+   builds the reference sequence from per-site counters (if ref_seq is not
+   specified); the second pass converts each sequence into mutations right
+   after reading it.
+   @param aln_stream A (seekable) stream of an alignment file
+   @param[in] ref_seq The reference sequence
+   @throw std::logic\_error if the alignment is empty or in an incorrect
+   format
+   */
+  void readFastaStreaming(std::istream& aln_stream,
+                          const std::string& ref_seq);
+
+  /**
+   Read the records of an alignment in FASTA format one by one
+   @param aln_stream A stream of the alignment
+   @param process_record a function called on (the name, the sequence) of
+   each record
+   @param show_notes TRUE to print notes about unknown characters
+   @throw std::logic\_error if the alignment is in an incorrect format
+   */
+  void readFastaRecords(
+      std::istream& aln_stream,
+      const std::function<void(std::string&, std::string&)>& process_record,
+      bool show_notes = true);
+
+  /**
+   Read an alignment in VCF format from a stream. Genotype calls (GT) are
+   converted into mutations of the samples record by record, thus neither the
+   full sequences nor the genotype matrix are kept in memory.
+   @param aln_stream A stream of the alignment
+   @param[in] ref_seq The reference sequence (required)
+   @throw std::logic\_error if any of the following situations occur.
+   - the reference sequence is not specified
+   - the alignment is empty or in an incorrect format
+   - the REF allele of a record doesn't match the reference sequence
+   */
+  void readVcf(std::istream& aln_stream, const std::string& ref_seq);
+
+  /**
+   Shorten sequence names (cut at whitespaces) if they remain unique
+   @param[in,out] seq_names the sequence names
+   */
+  static void shortenSeqNames(cmaple::StrVector& seq_names);
+
   /**
    Parse the reference sequence into vector of state
    @param ref_sequence reference genome in string
@@ -361,11 +599,13 @@ class Alignment {
 
   /**
    Read sequence from a string line
+   @param show_notes TRUE to print notes about unknown characters
    @throw std::logic\_error if the sequence is an incorrect format
    */
   void processSeq(std::string& sequence,
                   std::string& line,
-                  cmaple::PositionType line_num);
+                  cmaple::PositionType line_num,
+                  bool show_notes = true);
 
   /**
    Add a mutation to a sequence
@@ -420,9 +660,24 @@ class Alignment {
       IN_FASTA if in fasta format,
       IN_PHYLIP if in phylip format,
       IN_MAPLE if in MAPLE format,
+      IN_BINARY if in the binary format,
+      IN_VCF if in VCF format,
       IN_UNKNOWN if file format unknown.
    */
   InputType detectInputFile(std::istream& aln_stream);
+
+  /**
+   Detect whether an alignment (starting by '#') is in VCF format
+   @return IN_VCF if in VCF format, IN_UNKNOWN otherwise
+   */
+  static InputType detectVCF(std::istream& aln_stream);
+
+  /**
+  Check if an alignment is in the binary format (by its magic bytes)
+  @param aln_stream A stream of the alignment file
+  @return TRUE if the alignment is in the binary format
+   */
+  static bool isBinaryAln(std::istream& aln_stream);
     
   /*! \endcond */
 };
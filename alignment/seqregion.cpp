@@ -9,6 +9,25 @@
 #include <iomanip>
 using namespace cmaple;
 
+namespace {
+/**
+ Likelihood vectors of the IUPAC ambiguity codes R, Y, W, S, M, K, B, H, D, V.
+ They are shared (read-only) by all regions of these codes instead of
+ allocating one vector per region
+ */
+const std::array<SeqRegion::LHType, 10> ambiguity_lhs{
+    {{0.5, 0, 0.5, 0},
+     {0, 0.5, 0, 0.5},
+     {0.5, 0, 0, 0.5},
+     {0, 0.5, 0.5, 0},
+     {0.5, 0.5, 0, 0},
+     {0, 0, 0.5, 0.5},
+     {0, 1.0 / 3, 1.0 / 3, 1.0 / 3},
+     {1.0 / 3, 1.0 / 3, 0, 1.0 / 3},
+     {1.0 / 3, 0, 1.0 / 3, 1.0 / 3},
+     {1.0 / 3, 1.0 / 3, 1.0 / 3, 0}}};
+}  // namespace
+
 cmaple::SeqRegion::SeqRegion(StateType n_type,
                              PositionType n_position,
                              RealNumType n_plength_observation,
@@ -109,71 +128,61 @@ void cmaple::SeqRegion::convertAmbiguiousStateDNA(int max_num_states) {
     case 1 + 4 +
         3:  // 'R' -> A or G, Purine
     {
-      static constexpr LHType entries{0.5, 0, 0.5, 0};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[0]);
       break;
     }
     case 2 + EIGHT +
         3:  // 'Y' -> C or T, Pyrimidine
     {
-      static constexpr LHType entries{0, 0.5, 0, 0.5};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[1]);
       break;
     }
     case 1 + EIGHT +
         3:  // 'W' -> A or T, Weak
     {
-      static constexpr LHType entries{0.5, 0, 0, 0.5};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[2]);
       break;
     }
     case 2 + 4 +
         3:  // 'S' -> G or C, Strong
     {
-      static constexpr LHType entries{0, 0.5, 0.5, 0};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[3]);
       break;
     }
     case 1 + 2 +
         3:  // 'M' -> A or C, Amino
     {
-      static constexpr LHType entries{0.5, 0.5, 0, 0};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[4]);
       break;
     }
     case 4 + EIGHT +
         3:  // 'K' -> G or T, Keto
     {
-      static constexpr LHType entries{0, 0, 0.5, 0.5};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[5]);
       break;
     }
     case 2 + 4 + EIGHT +
         3:  // 'B' -> C or G or T
     {
-      static constexpr LHType entries{0, 1.0 / 3, 1.0 / 3, 1.0 / 3};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[6]);
       break;
     }
     case 1 + 2 + EIGHT +
         3:  // 'H' -> A or C or T
     {
-      static constexpr LHType entries{1.0 / 3, 1.0 / 3, 0, 1.0 / 3};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[7]);
       break;
     }
     case 1 + 4 + EIGHT +
         3:  // 'D' -> A or G or T
     {
-      static constexpr LHType entries{1.0 / 3, 0, 1.0 / 3, 1.0 / 3};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[8]);
       break;
     }
     case 1 + 2 + 4 +
         3:  // 'V' -> A or G or C
     {
-      static constexpr LHType entries{1.0 / 3, 1.0 / 3, 1.0 / 3, 0};
-      computeLhAmbiguity(entries);
+      computeLhAmbiguity(ambiguity_lhs[9]);
       break;
     }
     default:
@@ -185,10 +194,8 @@ void cmaple::SeqRegion::convertAmbiguiousStateDNA(int max_num_states) {
 void cmaple::SeqRegion::computeLhAmbiguity(const LHType& entries) {
   // change type to 'O'
   type = TYPE_O;
-  if (!likelihood) {
-    likelihood = cmaple::make_unique<LHType>();
-  }
-  (*likelihood) = entries;
+  // point to the shared vector of this ambiguity code
+  likelihood = LHPtrType::shared(entries);
 }
 
 auto cmaple::SeqRegion::operator==(const SeqRegion& seqregion_1) const -> bool {
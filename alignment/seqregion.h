@@ -14,9 +14,70 @@ class SeqRegion : public Mutation {
    */
   using LHType = std::array<cmaple::RealNumType, NUM_STATES>;
   /*!
-      Type of likelihood pointer
-   */
-  using LHPtrType = std::unique_ptr<LHType>;
+      Pointer to a likelihood vector: either owned by the region (writable) or
+      pointing to one of the shared, read-only vectors of the IUPAC ambiguity
+      codes. The vector is only readable through the pointer; writing needs
+      getWritable(), which first copies a shared vector
+   */
+  class LHPtrType {
+   public:
+    LHPtrType() noexcept = default;
+    LHPtrType(std::nullptr_t) noexcept {}
+    LHPtrType(std::unique_ptr<LHType>&& n_lh) noexcept
+        : owned_lh(std::move(n_lh)), lh(owned_lh.get()) {}
+    LHPtrType(LHPtrType&& other) noexcept
+        : owned_lh(std::move(other.owned_lh)), lh(other.lh) {
+      other.lh = nullptr;
+    }
+    LHPtrType& operator=(LHPtrType&& other) noexcept {
+      owned_lh = std::move(other.owned_lh);
+      lh = other.lh;
+      other.lh = nullptr;
+      return *this;
+    }
+
+    /*!
+        Point to a shared read-only vector (never freed nor written)
+     */
+    static LHPtrType shared(const LHType& shared_lh) noexcept {
+      LHPtrType ptr;
+      ptr.lh = &shared_lh;
+      return ptr;
+    }
+
+    explicit operator bool() const noexcept { return lh != nullptr; }
+    const LHType& operator*() const noexcept { return *lh; }
+    const LHType* operator->() const noexcept { return lh; }
+    const LHType* get() const noexcept { return lh; }
+
+    /*!
+        TRUE if the vector is shared (read-only)
+     */
+    bool isShared() const noexcept { return lh && !owned_lh; }
+
+    friend bool operator==(const LHPtrType& ptr, std::nullptr_t) noexcept {
+      return !ptr.lh;
+    }
+    friend bool operator!=(const LHPtrType& ptr, std::nullptr_t) noexcept {
+      return ptr.lh != nullptr;
+    }
+
+    /*!
+        Get the vector for writing (copying a shared vector first)
+     */
+    LHType& getWritable() {
+      assert(lh);
+      if (!owned_lh) {
+        owned_lh = cmaple::make_unique<LHType>(*lh);
+        lh = owned_lh.get();
+      }
+      return *owned_lh;
+    }
+
+   private:
+    std::unique_ptr<LHType> owned_lh;
+    const LHType* lh = nullptr;
+  };
   /*! \endcond */
 
   /*!
@@ -32,6 +93,7 @@ class SeqRegion : public Mutation {
  private:
   /**
    *  Compute the relative likelihood for an ambiguous state
+   *  @param entries the shared likelihood vector of that ambiguity code
    */
   void computeLhAmbiguity(const LHType& entries);
 
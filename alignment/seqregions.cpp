@@ -23,6 +23,19 @@ cmaple::SeqRegions::SeqRegions(const std::unique_ptr<SeqRegions>& n_regions) {
   for (const auto& region : *n_regions) {
     push_back(SeqRegion::clone(region));
   }
+  fingerprint_ = n_regions->fingerprint_;
+}
+
+void cmaple::SeqRegions::updateFingerprint() {
+  // FNV-1a over the (type, end position) of each region
+  uint64_t hash = 14695981039346656037ULL;
+  for (const auto& region : *this) {
+    hash ^= (static_cast<uint64_t>(static_cast<uint32_t>(region.position))
+             << 16) | region.type;
+    hash *= 1099511628211ULL;
+  }
+  // 0 is reserved for "unknown"
+  fingerprint_ = hash ? hash : 1;
 }
 
 auto cmaple::SeqRegions::compareWithSample(const SeqRegions& sequence2,
@@ -128,6 +141,12 @@ auto cmaple::SeqRegions::areDiffFrom(
     return true;
   }
 
+  // quick check: regions with different structures are always different
+  if (fingerprint_ && regions2->fingerprint_ &&
+      fingerprint_ != regions2->fingerprint_) {
+    return true;
+  }
+
   // init variables
   PositionType pos = 0;
   const SeqRegions& seq1_regions = *this;
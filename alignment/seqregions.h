@@ -30,6 +30,12 @@ static constexpr DoubleState ON = (DoubleState(TYPE_O) << 8) | TYPE_N;
  */
 class SeqRegions : public std::vector<SeqRegion> {
  private:
+  /**
+   Structural fingerprint (types and end positions of all regions), computed
+   when the regions are produced by a merge; 0 means "unknown"
+   */
+  uint64_t fingerprint_ = 0;
+
  public:
   /**
    *  Regions constructor
@@ -87,6 +93,48 @@ class SeqRegions : public std::vector<SeqRegion> {
     end_pos = minFast(seq1_region[i1].position, seq2_region[i2].position);
   }
 
+  /**
+   Extend the current shared segment, in which both regions are of type R,
+   over the following regions of the two sequences as long as they are also
+   of type R -> a run of R/R segments can be handled at once
+   @param seq1_region, seq2_region: the two sequences
+   @param i1, i2: the indexes of the current regions; will be moved to the
+   last regions of the run
+   @param end_pos: ending position of the shared segment; will be updated to
+   the ending position of the run
+   @param extend_seq1, extend_seq2: TRUE if the run can go through several
+   regions of seq1 (seq2); set to FALSE if the caller depends on the
+   branch lengths of the region of seq1 (seq2)
+   */
+  inline static void extendSharedRSegment(const SeqRegions& seq1_region,
+                                          const SeqRegions& seq2_region,
+                                          size_t& i1,
+                                          size_t& i2,
+                                          cmaple::PositionType& end_pos,
+                                          const bool extend_seq1,
+                                          const bool extend_seq2) {
+    assert(seq1_region[i1].type == TYPE_R && seq2_region[i2].type == TYPE_R);
+
+    while (true) {
+      const bool end_seq1 = seq1_region[i1].position == end_pos;
+      const bool end_seq2 = seq2_region[i2].position == end_pos;
+
+      // stop if the next region of a sequence cannot be merged into the run
+      if (end_seq1 && (!extend_seq1 || i1 + 1 == seq1_region.size() ||
+                       seq1_region[i1 + 1].type != TYPE_R)) {
+        return;
+      }
+      if (end_seq2 && (!extend_seq2 || i2 + 1 == seq2_region.size() ||
+                       seq2_region[i2 + 1].type != TYPE_R)) {
+        return;
+      }
+
+      i1 += end_seq1;
+      i2 += end_seq2;
+      end_pos = minFast(seq1_region[i1].position, seq2_region[i2].position);
+    }
+  }
+
   /**
    Count the number of shared segments
    */
@@ -107,10 +155,25 @@ class SeqRegions : public std::vector<SeqRegion> {
                         cmaple::PositionType seq_length,
                         const Alignment* aln) const;
 
+  /**
+   Compute and cache the structural fingerprint of the current regions.
+   The fingerprint only hashes the type and the end position of each region;
+   likelihoods and branch lengths are ignored so that the quick check in
+   areDiffFrom() does not depend on the approximation thresholds
+   */
+  void updateFingerprint();
+
+  /**
+   Get the cached structural fingerprint (0 if it has not been computed)
+   */
+  inline uint64_t getFingerprint() const { return fingerprint_; }
+
   /**
    Check if the current regions and regions2 represent the same partial
    likelihoods or not -> be used to stop traversing the tree further for
-   updating partial likelihoods
+   updating partial likelihoods.
+   If both regions carry a fingerprint and the fingerprints differ, the regions
+   are reported as different without walking through all regions
    */
   bool areDiffFrom(const std::unique_ptr<SeqRegions>& regions2,
                    cmaple::PositionType seq_length,
@@ -557,6 +620,21 @@ auto updateLHwithModel(const ModelBase* model,
   assert(model);
     
   RealNumType sum_lh = 0;
+  // JC model: closed-form formulas
+  if (model->jc_rates) {
+    const RealNumType sum_prior = sumVec<num_states>(prior.data());
+    for (StateType i = 0; i < num_states; ++i) {
+      RealNumType tot = prior[i];
+      if (total_blength > 0) {
+        tot += dotProductJC<num_states>(prior.data(), sum_prior, i) *
+               total_blength;
+      }
+      posterior[i] = tot * model->root_freqs[i];
+      sum_lh += posterior[i];
+    }
+    return sum_lh;
+  }
+
   RealNumType* mutation_mat_row = model->mutation_mat;
   for (StateType i = 0; i < num_states; ++i, mutation_mat_row += num_states) {
     RealNumType tot = 0;
@@ -575,13 +653,29 @@ auto updateLHwithModel(const ModelBase* model,
 }
 
 template <const StateType num_states>
-auto updateLHwithMat(const RealNumType* mat_row,
+auto updateLHwithMat(const ModelBase* model,
+                     const RealNumType* mat_row,
                      const SeqRegion::LHType& prior,
                      SeqRegion::LHType& posterior,
                      const RealNumType total_blength) -> RealNumType {
+  assert(model);
   assert(mat_row);
     
   RealNumType sum_lh = 0;
+  // JC model: closed-form formulas (the mutation matrix equals its transposed
+  // matrix)
+  if (model->jc_rates) {
+    const RealNumType sum_prior = sumVec<num_states>(prior.data());
+    for (StateType i = 0; i < num_states; ++i) {
+      const RealNumType tot =
+          dotProductJC<num_states>(prior.data(), sum_prior, i) *
+              total_blength + prior[i];
+      posterior[i] = tot;
+      sum_lh += tot;
+    }
+    return sum_lh;
+  }
+
   for (StateType i = 0; i < num_states; ++i, mat_row += num_states) {
     RealNumType tot = 0;
     tot += dotProduct<num_states>(&(prior)[0], mat_row);
@@ -595,13 +689,31 @@ auto updateLHwithMat(const RealNumType* mat_row,
 }
 
 template <const StateType num_states>
-auto updateMultLHwithMat(const RealNumType* mat_row,
+auto updateMultLHwithMat(const ModelBase* model,
+                         const RealNumType* mat_row,
                          const SeqRegion::LHType& prior,
                          SeqRegion::LHType& posterior,
                          const RealNumType total_blength) -> RealNumType {
+  assert(model);
   assert(mat_row);
     
   RealNumType sum_lh = 0;
+  // JC model: closed-form formulas (the mutation matrix equals its transposed
+  // matrix)
+  if (model->jc_rates) {
+    const RealNumType sum_prior = sumVec<num_states>(prior.data());
+    for (StateType i = 0; i < num_states; ++i) {
+      RealNumType tot = prior[i];
+      if (total_blength > 0) {
+        tot += dotProductJC<num_states>(prior.data(), sum_prior, i) *
+               total_blength;
+      }
+      posterior[i] *= tot;
+      sum_lh += posterior[i];
+    }
+    return sum_lh;
+  }
+
   for (StateType i = 0; i < num_states; ++i, mat_row += num_states) {
     RealNumType tot = 0;
     if (total_blength > 0)  // TODO: avoid
@@ -674,7 +786,8 @@ void merge_O_N(const SeqRegion& reg_o,
     auto new_lh = cmaple::make_unique<SeqRegion::LHType>();  // = new
     // RealNumType[num_states];
     RealNumType sum_lh = updateLHwithMat<num_states>(
-        model->transposed_mut_mat, *(reg_o.likelihood), *new_lh, total_blength);
+        model, model->transposed_mut_mat, *(reg_o.likelihood), *new_lh,
+        total_blength);
 
     // normalize the new partial likelihood
     normalize_arr(new_lh->data(), num_states, sum_lh);
@@ -708,7 +821,7 @@ void merge_O_ORACGT(const SeqRegion& seq1_region,
 
   // if total_blength_1 > 0 => compute new partial likelihood
   if (total_blength_1 > 0) {
-    updateLHwithMat<num_states>(model->transposed_mut_mat,
+    updateLHwithMat<num_states>(model, model->transposed_mut_mat,
                                 *(seq1_region.likelihood), *new_lh,
                                 total_blength_1);
     // otherwise, clone the partial likelihood from seq1
@@ -720,7 +833,7 @@ void merge_O_ORACGT(const SeqRegion& seq1_region,
 
   // seq1 = seq2 = O
   if (seq2_region.type == TYPE_O) {
-    sum_new_lh = updateMultLHwithMat<num_states>(model->mutation_mat,
+    sum_new_lh = updateMultLHwithMat<num_states>(model, model->mutation_mat,
                                                  *(seq2_region.likelihood),
                                                  *new_lh, total_blength_2);
   }
@@ -768,7 +881,8 @@ void merge_RACGT_O(const SeqRegion& seq2_region,
   assert(aln);
     
   RealNumType sum_new_lh = updateMultLHwithMat<num_states>(
-      model->mutation_mat, *(seq2_region.likelihood), new_lh, total_blength_2);
+      model, model->mutation_mat, *(seq2_region.likelihood), new_lh,
+      total_blength_2);
 
   // normalize the new partial likelihood
   normalize_arr(new_lh.data(), num_states, sum_new_lh);
@@ -857,8 +971,8 @@ void merge_RACGT_ORACGT(const SeqRegion& seq1_region,
                                    transposed_mut_mat_row,
                                    seq1_region.plength_observation2node);
 
-    updateLHwithMat<num_states>(model->transposed_mut_mat, root_vec, *new_lh,
-                                length_to_root);
+    updateLHwithMat<num_states>(model, model->transposed_mut_mat, root_vec,
+                                *new_lh, length_to_root);
   } else {
     if (total_blength_1 > 0) {
       RealNumType* mutation_mat_row =
@@ -908,6 +1022,7 @@ void SeqRegions::mergeUpperLower(std::unique_ptr<SeqRegions>& merged_regions,
   // init merged_regions
   if (merged_regions) {
     merged_regions->clear();
+    merged_regions->fingerprint_ = 0;
   } else {
     merged_regions = cmaple::make_unique<SeqRegions>();
   }
@@ -958,7 +1073,16 @@ void SeqRegions::mergeUpperLower(std::unique_ptr<SeqRegions>& merged_regions,
       merge_RACGT_N(*seq1_region, upper_plength, end_pos, threshold_prob,
                     *merged_regions);
     }
-    // seq1_entry = seq2_entry = R/ACGT
+    // seq1_entry = seq2_entry = R -> handle the whole run of R/R segments at
+    // once
+    else if (s1s2 == RR) [[likely]] {
+      cmaple::SeqRegions::extendSharedRSegment(seq1_regions, seq2_regions,
+                                               iseq1, iseq2, end_pos, true,
+                                               true);
+      addNonConsecutiveRRegion(*merged_regions, TYPE_R, -1, -1, end_pos,
+                               threshold_prob);
+    }
+    // seq1_entry = seq2_entry = ACGT
     // todo: improve condition: a == b & a == RACGT
     else if (seq1_region->type == seq2_region->type &&
              (seq1_region->type < num_states || seq1_region->type == TYPE_R)) {
@@ -1031,6 +1155,9 @@ void SeqRegions::mergeUpperLower(std::unique_ptr<SeqRegions>& merged_regions,
          max_elements);  // ensure we did the correct reserve, otherwise it was
   // a pessimization
 #endif
+
+  // record the structure of the merged regions for quick comparisons
+  merged_regions->updateFingerprint();
 }
 
 template <const StateType num_states>
@@ -1049,7 +1176,8 @@ auto merge_O_O_TwoLowers(const SeqRegion& seq2_region,
   assert(aln);
     
   RealNumType sum_lh = updateMultLHwithMat<num_states>(
-      model->mutation_mat, *seq2_region.likelihood, new_lh, total_blength_2);
+      model, model->mutation_mat, *seq2_region.likelihood, new_lh,
+      total_blength_2);
 
   if (sum_lh == 0) {
     merged_regions = nullptr;
@@ -1146,8 +1274,9 @@ auto merge_O_ORACGT_TwoLowers(const SeqRegion& seq1_region,
   RealNumType sum_lh = 0;
 
   if (total_blength_1 > 0) {
-    updateLHwithMat<num_states>(model->mutation_mat, *(seq1_region.likelihood),
-                                *new_lh, total_blength_1);
+    updateLHwithMat<num_states>(model, model->mutation_mat,
+                                *(seq1_region.likelihood), *new_lh,
+                                total_blength_1);
     // otherwise, clone the partial likelihood from seq1
   } else {
     *new_lh = *seq1_region.likelihood;
@@ -1186,7 +1315,8 @@ auto merge_RACGT_O_TwoLowers(const SeqRegion& seq2_region,
   assert(aln);
     
   RealNumType sum_lh = updateMultLHwithMat<num_states>(
-      model->mutation_mat, *(seq2_region.likelihood), new_lh, total_blength_2);
+      model, model->mutation_mat, *(seq2_region.likelihood), new_lh,
+      total_blength_2);
 
   if (sum_lh == 0) {
     merged_regions = nullptr;
@@ -1400,6 +1530,7 @@ RealNumType SeqRegions::mergeTwoLowers(
   // init merged_regions
   if (merged_regions) {
     merged_regions->clear();
+    merged_regions->fingerprint_ = 0;
   } else {
     merged_regions = cmaple::make_unique<SeqRegions>();
   }
@@ -1450,6 +1581,15 @@ RealNumType SeqRegions::mergeTwoLowers(
       merge_N_RACGT_TwoLowers(*seq1_region, end_pos, plength1, threshold_prob,
                               *merged_regions);
     }
+    // seq1_entry = seq2_entry = R and the log lh is not needed -> handle the
+    // whole run of R/R segments at once
+    else if (s1s2 == RR && !return_log_lh) {
+      cmaple::SeqRegions::extendSharedRSegment(seq1_regions, seq2_regions,
+                                               iseq1, iseq2, end_pos, true,
+                                               true);
+      addNonConsecutiveRRegion(*merged_regions, TYPE_R, -1, -1, end_pos,
+                               threshold_prob);
+    }
     // neither seq1_entry nor seq2_entry = N
     else {
       if (!merge_notN_notN_TwoLowers<num_states>(
@@ -1480,6 +1620,9 @@ RealNumType SeqRegions::mergeTwoLowers(
   // a pessimization
 #endif
 
+  // record the structure of the merged regions for quick comparisons
+  merged_regions->updateFingerprint();
+
   return log_lh;
 }
 
@@ -1629,6 +1772,8 @@ void SeqRegions::computeTotalLhAtRoot(std::unique_ptr<SeqRegions>& total_lh,
   } else {
     total_lh = cmaple::make_unique<SeqRegions>();
   }
+  // total_lh keeps the types and positions of the current regions
+  total_lh->fingerprint_ = fingerprint_;
 
   total_lh->reserve(size());  // avoid realloc of vector data
   for (const SeqRegion& elem : (*this)) {
@@ -1738,7 +1883,8 @@ bool calSiteLhs_O_O(std::vector<RealNumType>& site_lh_contributions,
   assert(model);
     
   RealNumType sum_lh = updateMultLHwithMat<num_states>(
-      model->mutation_mat, *seq2_region.likelihood, new_lh, total_blength_2);
+      model, model->mutation_mat, *seq2_region.likelihood, new_lh,
+      total_blength_2);
 
   if (sum_lh == 0) {
     merged_regions = nullptr;
@@ -1830,8 +1976,9 @@ bool calSiteLhs_O_ORACGT(std::vector<RealNumType>& site_lh_contributions,
   RealNumType sum_lh = 0;
 
   if (total_blength_1 > 0) {
-    updateLHwithMat<num_states>(model->mutation_mat, *(seq1_region.likelihood),
-                                *new_lh, total_blength_1);
+    updateLHwithMat<num_states>(model, model->mutation_mat,
+                                *(seq1_region.likelihood), *new_lh,
+                                total_blength_1);
     // otherwise, clone the partial likelihood from seq1
   } else {
     *new_lh = *seq1_region.likelihood;
@@ -1870,7 +2017,8 @@ bool calSiteLhs_RACGT_O(std::vector<RealNumType>& site_lh_contributions,
   assert(model);
     
   RealNumType sum_lh = updateMultLHwithMat<num_states>(
-      model->mutation_mat, *(seq2_region.likelihood), new_lh, total_blength_2);
+      model, model->mutation_mat, *(seq2_region.likelihood), new_lh,
+      total_blength_2);
 
   if (sum_lh == 0) {
     merged_regions = nullptr;
@@ -2082,6 +2230,7 @@ RealNumType SeqRegions::calculateSiteLhContributions(
   // init merged_regions
   if (merged_regions) {
     merged_regions->clear();
+    merged_regions->fingerprint_ = 0;
   } else {
     merged_regions = cmaple::make_unique<SeqRegions>();
   }
@@ -2165,6 +2314,9 @@ RealNumType SeqRegions::calculateSiteLhContributions(
 #endif
   // a pessimization
 
+  // record the structure of the merged regions for quick comparisons
+  merged_regions->updateFingerprint();
+
   return log_lh;
 }
 
@@ -1,4 +1,5 @@
 #include "cmaple.h"
+#include <cstdio>
 using namespace std;
 using namespace cmaple;
 
@@ -74,9 +75,11 @@ void cmaple::runCMAPLE(cmaple::Params &params)
         const std::string prefix = (params.output_prefix.length() ? params.output_prefix :  params.aln_path);
         assert(prefix.length() > 0);
         const std::string output_treefile = prefix + ".treefile";
+        const std::string output_jplace = prefix + ".jplace";
+        const std::string& output_file = params.query_placement ? output_jplace : output_treefile;
         // check whether output file is already exists
-        if (!params.overwrite_output && fileExists(output_treefile)) {
-          outError("File " + output_treefile +
+        if (!params.overwrite_output && fileExists(output_file)) {
+          outError("File " + output_file +
                    " already exists. Use `--overwrite` option if you really "
                    "want to overwrite it.\n");
         }
@@ -142,19 +145,64 @@ void cmaple::runCMAPLE(cmaple::Params &params)
             return;
         }
         
+        // Periodically write checkpoints during the inference (except in the
+        // server mode, where the tree keeps changing after the inference)
+        const std::string checkpoint_file = prefix + ".ckp";
+        if (!params.server_mode) {
+          params.checkpoint_filename = checkpoint_file;
+        }
+        const bool resume = params.resume && fileExists(checkpoint_file);
+        if (params.resume && !resume) {
+          outWarning("Checkpoint file " + checkpoint_file +
+                     " not found. Start a new run.");
+        }
+
         // Initialize a Tree
-        Tree tree(&aln, &model, params.input_treefile, params.fixed_blengths, cmaple::make_unique<cmaple::Params>(params));
+        Tree tree(&aln, &model, resume ? "" : params.input_treefile, params.fixed_blengths, cmaple::make_unique<cmaple::Params>(params));
+
+        // Restore the tree from the checkpoint (if users want to resume the run)
+        if (resume) {
+          if (cmaple::verbose_mode > cmaple::VB_QUIET) {
+            std::cout << "Resuming from checkpoint " << checkpoint_file
+                      << std::endl;
+          }
+          tree.loadCheckpoint(checkpoint_file);
+        }
         
-        // Infer a phylogenetic tree
-        const cmaple::Tree::TreeSearchType tree_search_type = cmaple::Tree::parseTreeSearchType(params.tree_search_type_str);
         std::ostream null_stream(nullptr);
         std::ostream& out_stream = cmaple::verbose_mode >= cmaple::VB_MED ? std::cout : null_stream;
+
+        // Place the queries onto the fixed input tree (if users want to do so)
+        if (params.query_placement)
+        {
+            ofstream out_jplace = ofstream(output_jplace);
+            tree.placeQueries(out_jplace, static_cast<int>(params.num_threads), out_stream);
+            out_jplace.close();
+
+            // Show information about output files
+            std::cout << "Analysis results written to:" << std::endl;
+            std::cout << "Query placements:              " << output_jplace << std::endl;
+            std::cout << "Screen log file:               " << prefix + ".log" << std::endl << std::endl;
+
+            // show runtime
+            auto end = getRealTime();
+            if (cmaple::verbose_mode > cmaple::VB_QUIET) {
+              cout << "Runtime: " << end - start << "s" << endl;
+            }
+            return;
+        }
+
+        // Infer a phylogenetic tree
+        const cmaple::Tree::TreeSearchType tree_search_type = cmaple::Tree::parseTreeSearchType(params.tree_search_type_str);
         tree.infer(tree_search_type, params.shallow_tree_search, out_stream);
 
         // Write the normal tree file
         ofstream out = ofstream(output_treefile);
-        out << tree.exportNewick(tree_format);
+        tree.exportNewick(out, tree_format);
         out.close();
+
+        // The inference completed -> the checkpoint is no longer needed
+        std::remove(checkpoint_file.c_str());
         
         // Compute branch supports (if users want to do so)
         if (params.compute_aLRT_SH)
@@ -170,7 +218,7 @@ void cmaple::runCMAPLE(cmaple::Params &params)
 
             // write the tree file with branch supports
             ofstream out_tree_branch_supports = ofstream(prefix + ".aLRT_SH.treefile");
-            out_tree_branch_supports << tree.exportNewick(tree_format, true);
+            tree.exportNewick(out_tree_branch_supports, tree_format, true);
             out_tree_branch_supports.close();
         }
         
@@ -181,7 +229,7 @@ void cmaple::runCMAPLE(cmaple::Params &params)
             
             // Overwrite the normal tree file
             ofstream overwrite_out = ofstream(output_treefile);
-            overwrite_out << tree.exportNewick(tree_format);
+            tree.exportNewick(overwrite_out, tree_format);
             overwrite_out.close();
         }
         
@@ -216,6 +264,10 @@ void cmaple::runCMAPLE(cmaple::Params &params)
         if (cmaple::verbose_mode > cmaple::VB_QUIET) {
           cout << "Runtime: " << end - start << "s" << endl;
         }
+        
+        // Keep the alignment, model, and tree in memory to place new sequences incrementally (if users want to do so)
+        if (params.server_mode)
+            runServer(aln, tree, params.server_socket);
     }
     catch (std::invalid_argument& e)
     {
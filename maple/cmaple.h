@@ -39,6 +39,36 @@ namespace cmaple
      */
     void runCMAPLE(cmaple::Params& params);
 
+    /** \brief Serve requests for placing new sequences incrementally onto a
+     * tree, which is kept in memory together with its alignment and model.
+     * Requests are lines: MAPLE records (`>name` followed by the mutation
+     * lines) of new sequences, then `PLACE` to add them to the alignment,
+     * place them by Tree::doPlacement(), and report their placements
+     * (Tree::exportPlacements()); `REMOVE <name>` to remove a sample from
+     * the tree (Tree::removeSamples()); `NEWICK` to output the current tree;
+     * `QUIT` to end the session; `SHUTDOWN` to end the session and stop the
+     * server. Each response ends with a line `OK` or `ERROR <message>`.
+     * @param[in,out] aln the alignment
+     * @param[in,out] tree the tree (attached to aln)
+     * @param[in] request_stream the stream of requests
+     * @param[out] response_stream the stream of responses
+     * @return TRUE if the server was asked to shut down
+     */
+    bool servePlacements(Alignment& aln, Tree& tree,
+            std::istream& request_stream, std::ostream& response_stream);
+    
+    /** \brief Serve placement requests (see servePlacements()) on a
+     * Unix-domain socket, one client after another, until a client sends
+     * `SHUTDOWN`; or on the standard input/output if socket_path is empty
+     * @param[in,out] aln the alignment
+     * @param[in,out] tree the tree (attached to aln)
+     * @param[in] socket_path the path of the socket
+     * @throw std::invalid\_argument if the socket path is invalid or sockets
+     * are unsupported
+     * @throw ios::failure if failing to listen on the socket
+     */
+    void runServer(Alignment& aln, Tree& tree, const std::string& socket_path);
+    
     /** \brief Function for testing only
      * @param[in] params user-specified (parameters via command-line)
      */
@@ -0,0 +1,287 @@
+#include "cmaple.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#if !defined(WIN32) && !defined(WIN64)
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+using namespace std;
+using namespace cmaple;
+
+namespace {
+#if !defined(WIN32) && !defined(WIN64)
+/**
+ A stream buffer reading from and writing to a file descriptor (e.g., a
+ connected socket)
+ */
+class FdStreamBuf : public std::streambuf {
+ public:
+  explicit FdStreamBuf(const int n_fd) : fd(n_fd) {
+    setg(in_buffer.data(), in_buffer.data(), in_buffer.data());
+    setp(out_buffer.data(), out_buffer.data() + out_buffer.size());
+  }
+
+  ~FdStreamBuf() override { flushBuffer(); }
+
+ protected:
+  int_type underflow() override {
+    ssize_t num_bytes;
+    do {
+      num_bytes = ::read(fd, in_buffer.data(), in_buffer.size());
+    } while (num_bytes < 0 && errno == EINTR);
+    if (num_bytes <= 0) {
+      return traits_type::eof();
+    }
+
+    setg(in_buffer.data(), in_buffer.data(), in_buffer.data() + num_bytes);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  int_type overflow(int_type c) override {
+    if (flushBuffer() < 0) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() override { return flushBuffer(); }
+
+ private:
+  /**
+   Write out the buffered output
+   @return 0 if successful, -1 otherwise
+   */
+  int flushBuffer() {
+    const char* data = pbase();
+    while (data < pptr()) {
+      const ssize_t num_bytes = ::write(fd, data, pptr() - data);
+      if (num_bytes < 0 && errno == EINTR) {
+        continue;
+      }
+      if (num_bytes <= 0) {
+        setp(out_buffer.data(), out_buffer.data() + out_buffer.size());
+        return -1;
+      }
+      data += num_bytes;
+    }
+    setp(out_buffer.data(), out_buffer.data() + out_buffer.size());
+    return 0;
+  }
+
+  const int fd;
+  std::array<char, 1 << 13> in_buffer;
+  std::array<char, 1 << 13> out_buffer;
+};
+#endif
+
+/**
+ Redirect std::cout until the end of the scope (even if an exception is thrown)
+ */
+class CoutRedirect {
+ public:
+  explicit CoutRedirect(std::streambuf* const buf)
+      : src_buf(std::cout.rdbuf(buf)) {}
+  ~CoutRedirect() { std::cout.rdbuf(src_buf); }
+  CoutRedirect(const CoutRedirect&) = delete;
+  CoutRedirect& operator=(const CoutRedirect&) = delete;
+
+ private:
+  std::streambuf* const src_buf;
+};
+
+/**
+ Undo a failed placement request: remove its sequences that were already
+ placed, then drop their records from the alignment
+ */
+void rollbackRequest(Alignment& aln,
+                     Tree& tree,
+                     const std::vector<std::string>& names) {
+  // the sequences not placed are reported as NA
+  std::ostringstream placement_stream;
+  tree.exportPlacements(names, placement_stream);
+  std::istringstream placements(placement_stream.str());
+  std::vector<std::string> placed_names;
+  std::string line;
+  while (std::getline(placements, line)) {
+    const std::string::size_type tab_pos = line.find('\t');
+    if (line.compare(tab_pos, std::string::npos, "\tNA")) {
+      placed_names.push_back(line.substr(0, tab_pos));
+    }
+  }
+  if (!placed_names.empty()) {
+    tree.removeSamples(placed_names);
+  }
+
+  // re-attach the tree to the alignment without the new records (the
+  // likelihoods are kept as the reference sequence is unchanged)
+  aln.data.erase(aln.data.end() - static_cast<std::ptrdiff_t>(names.size()),
+                 aln.data.end());
+  tree.changeAln(&aln);
+}
+
+/**
+ Place the sequences (MAPLE records) pending in a request, then report their
+ placements. If the placement fails, the tree and the alignment are restored.
+ */
+void placeRequest(Alignment& aln,
+                  Tree& tree,
+                  const std::string& records,
+                  std::ostream& response_stream) {
+  const std::vector<Sequence>::size_type first = aln.data.size();
+  std::istringstream records_stream(records);
+  aln.addSequences(records_stream);
+
+  std::vector<std::string> names;
+  names.reserve(aln.data.size() - first);
+  for (std::vector<Sequence>::size_type i = first; i < aln.data.size(); ++i) {
+    names.push_back(aln.data[i].seq_name);
+  }
+
+  {
+    // discard the logs (std::cout may be the response stream), and restore
+    // std::cout even if the placement fails
+    const CoutRedirect discard_logs(nullptr);
+    try {
+      std::ostream null_stream(nullptr);
+      tree.doPlacement(null_stream);
+    } catch (...) {
+      rollbackRequest(aln, tree, names);
+      throw;
+    }
+  }
+  tree.exportPlacements(names, response_stream);
+}
+}  // namespace
+
+auto cmaple::servePlacements(Alignment& aln,
+                             Tree& tree,
+                             std::istream& request_stream,
+                             std::ostream& response_stream) -> bool {
+  std::string records;
+  std::string line;
+  while (std::getline(request_stream, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+
+    // collect the records of new sequences until they are placed
+    const bool is_remove = line.rfind("REMOVE ", 0) == 0;
+    if (!line.empty() && (line.front() == '>' || !records.empty()) &&
+        line != "PLACE" && line != "NEWICK" && line != "QUIT" &&
+        line != "SHUTDOWN" && !is_remove) {
+      records.append(line).push_back('\n');
+      continue;
+    }
+
+    try {
+      if (line.empty()) {
+        continue;
+      } else if (line == "PLACE") {
+        if (records.empty()) {
+          throw std::invalid_argument("No sequences to place");
+        }
+        // the records are consumed even if they are invalid
+        const std::string request_records = std::move(records);
+        records.clear();
+        placeRequest(aln, tree, request_records, response_stream);
+      } else if (is_remove) {
+        tree.removeSamples({line.substr(7)});
+      } else if (line == "NEWICK") {
+        tree.exportNewick(response_stream, Tree::BIN_TREE, false);
+        response_stream << "\n";
+      } else if (line == "QUIT") {
+        return false;
+      } else if (line == "SHUTDOWN") {
+        return true;
+      } else {
+        throw std::invalid_argument("Unknown request: " + line);
+      }
+      response_stream << "OK" << std::endl;
+    } catch (std::exception& e) {
+      response_stream << "ERROR " << e.what() << std::endl;
+    }
+  }
+
+  // end of the requests
+  return false;
+}
+
+void cmaple::runServer(Alignment& aln,
+                       Tree& tree,
+                       const std::string& socket_path) {
+  // serve the standard input
+  if (!socket_path.length()) {
+    std::cout << "READY" << std::endl;
+    servePlacements(aln, tree, std::cin, std::cout);
+    return;
+  }
+
+#if defined(WIN32) || defined(WIN64)
+  throw std::invalid_argument(
+      "Unix-domain sockets are not supported on Windows. Please use -server "
+      "to serve the requests from the standard input");
+#else
+  sockaddr_un address{};
+  if (socket_path.length() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("The socket path is too long: " + socket_path);
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(),
+               sizeof(address.sun_path) - 1);
+
+  // remove a stale socket left by a previous server
+  struct stat file_stat;
+  if (stat(socket_path.c_str(), &file_stat) == 0 &&
+      S_ISSOCK(file_stat.st_mode)) {
+    unlink(socket_path.c_str());
+  }
+
+  const int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server_fd < 0) {
+    throw ios::failure("Failed to create a socket: " +
+                       std::string(std::strerror(errno)));
+  }
+  if (bind(server_fd, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) < 0 ||
+      listen(server_fd, SOMAXCONN) < 0) {
+    const std::string error = std::strerror(errno);
+    close(server_fd);
+    throw ios::failure("Failed to listen on " + socket_path + ": " + error);
+  }
+
+  // a client disconnecting early must not terminate the server
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::cout << "READY " << socket_path << std::endl;
+  // serve the clients one after another until one of them asks to shut down
+  bool shutdown = false;
+  while (!shutdown) {
+    const int client_fd = accept(server_fd, nullptr, nullptr);
+    if (client_fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    {
+      FdStreamBuf client_buf(client_fd);
+      std::istream request_stream(&client_buf);
+      std::ostream response_stream(&client_buf);
+      shutdown = servePlacements(aln, tree, request_stream, response_stream);
+    }
+    close(client_fd);
+  }
+
+  close(server_fd);
+  unlink(socket_path.c_str());
+#endif
+}
@@ -85,6 +85,7 @@ void cmaple::ModelDNA::initMutationMat() {
 
   // init the normalized factor
   normalized_factor = 1.0;
+  jc_rates = sub_model == JC;
 
   // for JC model
   if (sub_model == JC) {
@@ -265,6 +265,13 @@ class ModelBase {
    */
   bool fixed_params = false;
 
+  /**
+   TRUE if the mutation matrix is the JC one (equal state frequencies and equal
+   rates) -> the likelihood kernels can use the closed-form formulas instead of
+   matrix products
+   */
+  bool jc_rates = false;
+
   /**
    Get the model name
    */
@@ -217,52 +217,70 @@ const std::string cmaple::PhyloNode::exportString(
     const bool binary,
     const std::vector<std::string>& seq_names,
     const bool show_branch_supports) {
+  string output;
+  exportString(output, binary, seq_names, show_branch_supports);
+  return output;
+}
+
+void cmaple::PhyloNode::exportString(
+    std::string& output,
+    const bool binary,
+    const std::vector<std::string>& seq_names,
+    const bool show_branch_supports) {
   if (!isInternal()) {
-    string length_str = getUpperLength() <= 0
-                            ? "0"
-                            : convertDoubleToString(getUpperLength(), 12);
-    // without minor sequences -> simply return node's name and its branch
+    // without minor sequences -> simply export node's name and its branch
     // length
     std::vector<NumSeqsType>& less_info_seqs = getLessInfoSeqs();
     const std::vector<NumSeqsType>::size_type num_less_info_seqs = less_info_seqs.size();
     if (num_less_info_seqs == 0) {
-      return seq_names[getSeqNameIndex()] + ":" + length_str;
-      // with minor sequences -> return minor sequences' names with zero
+      output += seq_names[getSeqNameIndex()];
+      // with minor sequences -> export minor sequences' names with zero
       // branch lengths
     } else {
-      string branch_support = show_branch_supports ? "0" : "";
+      const char* branch_support = show_branch_supports ? "0" : "";
 
-      string output = "";
       // export less informative sequences in binary tree format
       if (binary) {
-        output.resize(num_less_info_seqs, '(');
+        output.append(num_less_info_seqs, '(');
         output += seq_names[getSeqNameIndex()];
         
         // add the first less-info-seq
-        output += ":0," + seq_names[less_info_seqs[0]] + ":0)";
+        output += ":0,";
+        output += seq_names[less_info_seqs[0]];
+        output += ":0)";
         
         // add the remaining less-info-seqs
         for (std::vector<NumSeqsType>::size_type  i = 1; i < less_info_seqs.size(); ++i) {
-          output += branch_support + ":0," + seq_names[less_info_seqs[i]] + ":0)";
+          output += branch_support;
+          output += ":0,";
+          output += seq_names[less_info_seqs[i]];
+          output += ":0)";
         }
-        
-        output += branch_support + ":" + length_str;
       }
       // export less informative sequences in mutifurcating tree format
       else {
-        output = "(" + seq_names[getSeqNameIndex()] + ":0";
+        output += '(';
+        output += seq_names[getSeqNameIndex()];
+        output += ":0";
         
         for (auto minor_seq_name_index : less_info_seqs) {
-          output += "," + seq_names[minor_seq_name_index] + ":0";
+          output += ',';
+          output += seq_names[minor_seq_name_index];
+          output += ":0";
         }
         
-        output += ")" + branch_support + ":" + length_str;
+        output += ')';
       }
-      return output;
+      output += branch_support;
     }
-  }
 
-  return "";
+    output += ':';
+    if (getUpperLength() <= 0) {
+      output += '0';
+    } else {
+      appendDoubleToString(output, getUpperLength(), 12);
+    }
+  }
 }
 
 auto cmaple::PhyloNode::getNodelhIndex() const -> const NumSeqsType {
@@ -276,6 +276,14 @@ class PhyloNode {
   const std::string exportString(const bool binary,
                                  const std::vector<std::string>& seq_names,
                                  const bool show_branch_supports);
+
+  /**
+   Append the string of this node (name + branch length) to an output string
+   */
+  void exportString(std::string& output,
+                    const bool binary,
+                    const std::vector<std::string>& seq_names,
+                    const bool show_branch_supports);
 };
 
 /** An intermediate data structure to store data for calculating aLRT-SH  */
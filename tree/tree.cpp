@@ -2,6 +2,15 @@
 
 #include <utils/matrix.h>
 #include <cassert>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#if defined(WIN32) || defined(WIN64)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>  // for MoveFileExA
+#endif
 
 using namespace std;
 using namespace cmaple;
@@ -36,6 +45,7 @@ void cmaple::Tree::initTree(Alignment* n_aln,
   // node_lh_index is usigned int -> we use 0 for UNINITIALIZED node_lh
   node_lhs.clear();
   node_lhs.push_back(NodeLh(0));
+  last_checkpoint_time = getRealTime();
 
   // Attach alignment and model
   attachAlnModel(n_aln, n_model->model_base);
@@ -162,6 +172,14 @@ void cmaple::Tree::makeTreeInOutConsistent() {
 
 std::string cmaple::Tree::exportNewick(const TreeType tree_type,
                                        const bool show_branch_supports) {
+  std::ostringstream out_stream;
+  exportNewick(out_stream, tree_type, show_branch_supports);
+  return std::move(out_stream).str();
+}
+
+void cmaple::Tree::exportNewick(std::ostream& out_stream,
+                                const TreeType tree_type,
+                                const bool show_branch_supports) {
   assert(aln);
   assert(model);
     
@@ -174,11 +192,11 @@ std::string cmaple::Tree::exportNewick(const TreeType tree_type,
   // output the tree according to its type
   switch (tree_type) {
     case BIN_TREE:
-      return exportNewick(true, show_branch_supports_checked);
-      // break;
+      writeNewick(out_stream, true, show_branch_supports_checked);
+      break;
     case MUL_TREE:
-      return exportNewick(false, show_branch_supports_checked);
-      // break;
+      writeNewick(out_stream, false, show_branch_supports_checked);
+      break;
     case UNKNOWN_TREE:
     default:
       throw std::invalid_argument(
@@ -188,7 +206,7 @@ std::string cmaple::Tree::exportNewick(const TreeType tree_type,
 }
 
 std::ostream& cmaple::operator<<(std::ostream& out_stream, cmaple::Tree& tree) {
-  out_stream << tree.exportNewick();
+  tree.exportNewick(out_stream);
   return out_stream;
 }
 
@@ -202,6 +220,546 @@ std::istream& cmaple::operator>>(std::istream& in_stream, cmaple::Tree& tree) {
   return in_stream;
 }
 
+namespace {
+/** Magic bytes of a tree checkpoint */
+const char CHECKPOINT_MAGIC[8] = {'C', 'M', 'A', 'P', 'L', 'E', 'C', 'P'};
+/** Version of the checkpoint format */
+const uint32_t CHECKPOINT_VERSION = 2;
+
+/** States of a sequence stored in checkpoints (since version 2) */
+enum CheckpointSeqState : uint8_t {
+  SEQ_NOT_ADDED,
+  SEQ_ADDED,
+  SEQ_REMOVED,
+};
+
+static_assert(std::is_trivially_copyable_v<NodeLh>,
+              "NodeLhs are stored as raw bytes in checkpoints");
+static_assert(std::is_trivially_copyable_v<Index>,
+              "Indexes are stored as raw bytes in checkpoints");
+
+template <typename T>
+void writeCheckpointValue(std::ostream& out_stream, const T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  out_stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeCheckpointArray(std::ostream& out_stream,
+                          const T* const values,
+                          const uint64_t num_values) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  out_stream.write(reinterpret_cast<const char*>(values),
+                   static_cast<std::streamsize>(num_values * sizeof(T)));
+}
+
+/**
+ Read a value from a checkpoint
+ @throw std::invalid_argument if the checkpoint is truncated
+ */
+template <typename T>
+auto readCheckpointValue(std::istream& in_stream) -> T {
+  static_assert(std::is_trivially_copyable_v<T>);
+  T value;
+  if (!in_stream.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::invalid_argument("Invalid checkpoint: file is truncated");
+  }
+  return value;
+}
+
+/**
+ Read an array of values from a checkpoint
+ @throw std::invalid_argument if the checkpoint is truncated
+ */
+template <typename T>
+void readCheckpointArray(std::istream& in_stream,
+                         T* const values,
+                         const uint64_t num_values) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  if (!in_stream.read(reinterpret_cast<char*>(values),
+                      static_cast<std::streamsize>(num_values * sizeof(T)))) {
+    throw std::invalid_argument("Invalid checkpoint: file is truncated");
+  }
+}
+
+/**
+ Read the number of elements of a vector, making sure it doesn't exceed an
+ upper bound (to avoid allocating huge vectors from a corrupted checkpoint)
+ @throw std::invalid_argument if the number exceeds the upper bound
+ */
+auto readCheckpointSize(std::istream& in_stream, const uint64_t max_size)
+    -> uint64_t {
+  const auto size = readCheckpointValue<uint64_t>(in_stream);
+  if (size > max_size) {
+    throw std::invalid_argument("Invalid checkpoint: file is corrupted");
+  }
+  return size;
+}
+
+void writeCheckpointString(std::ostream& out_stream, const std::string& str) {
+  writeCheckpointValue<uint64_t>(out_stream, str.length());
+  out_stream.write(str.data(), static_cast<std::streamsize>(str.length()));
+}
+
+auto readCheckpointString(std::istream& in_stream) -> std::string {
+  std::string str(readCheckpointSize(in_stream, UINT32_MAX), '\0');
+  readCheckpointArray(in_stream, str.data(), str.length());
+  return str;
+}
+
+/**
+ Write a (possibly null) vector of regions. Shared likelihood vectors of
+ ambiguity codes are written (and later restored) as normal vectors.
+ */
+void writeCheckpointRegions(std::ostream& out_stream,
+                            const std::unique_ptr<SeqRegions>& regions) {
+  writeCheckpointValue<uint8_t>(out_stream, regions ? 1 : 0);
+  if (!regions) {
+    return;
+  }
+  writeCheckpointValue<uint64_t>(out_stream, regions->size());
+  for (const SeqRegion& region : *regions) {
+    writeCheckpointValue(out_stream, region.type);
+    writeCheckpointValue(out_stream, region.position);
+    writeCheckpointValue(out_stream, region.plength_observation2node);
+    writeCheckpointValue(out_stream, region.plength_observation2root);
+    writeCheckpointValue<uint8_t>(out_stream, region.likelihood ? 1 : 0);
+    if (region.likelihood) {
+      writeCheckpointValue(out_stream, *region.likelihood);
+    }
+  }
+}
+
+/**
+ Read a (possibly null) vector of regions
+ @throw std::invalid_argument if the checkpoint is truncated or corrupted
+ */
+auto readCheckpointRegions(std::istream& in_stream,
+                           const uint64_t max_num_regions)
+    -> std::unique_ptr<SeqRegions> {
+  if (!readCheckpointValue<uint8_t>(in_stream)) {
+    return nullptr;
+  }
+  const uint64_t num_regions = readCheckpointSize(in_stream, max_num_regions);
+  std::unique_ptr<SeqRegions> regions = cmaple::make_unique<SeqRegions>();
+  regions->reserve(num_regions);
+  for (uint64_t i = 0; i < num_regions; ++i) {
+    const auto type = readCheckpointValue<StateType>(in_stream);
+    const auto position = readCheckpointValue<PositionType>(in_stream);
+    const auto plength_observation2node =
+        readCheckpointValue<RealNumType>(in_stream);
+    const auto plength_observation2root =
+        readCheckpointValue<RealNumType>(in_stream);
+    SeqRegion::LHPtrType likelihood = nullptr;
+    if (readCheckpointValue<uint8_t>(in_stream)) {
+      likelihood = cmaple::make_unique<SeqRegion::LHType>(
+          readCheckpointValue<SeqRegion::LHType>(in_stream));
+    }
+    regions->emplace_back(type, position, plength_observation2node,
+                          plength_observation2root, std::move(likelihood));
+  }
+  return regions;
+}
+
+/**
+ The parameters of a model, which are updated during the inference
+ */
+struct CheckpointModelParams {
+  std::vector<RealNumType> root_freqs, root_log_freqs, inverse_root_freqs,
+      diagonal_mut_mat, mutation_mat, transposed_mut_mat, freqi_freqj_qij,
+      freq_j_transposed_ij, pseu_mutation_count;
+  RealNumType normalized_factor = 1.0;
+  bool jc_rates = false;
+};
+
+void writeCheckpointModel(std::ostream& out_stream, const ModelBase& model) {
+  const uint64_t num_states = static_cast<uint64_t>(model.num_states_);
+  const uint64_t mat_size = num_states * num_states;
+  writeCheckpointValue<uint32_t>(out_stream, model.sub_model);
+  writeCheckpointArray(out_stream, model.root_freqs, num_states);
+  writeCheckpointArray(out_stream, model.root_log_freqs, num_states);
+  writeCheckpointArray(out_stream, model.inverse_root_freqs, num_states);
+  writeCheckpointArray(out_stream, model.diagonal_mut_mat, num_states);
+  writeCheckpointArray(out_stream, model.mutation_mat, mat_size);
+  writeCheckpointArray(out_stream, model.transposed_mut_mat, mat_size);
+  writeCheckpointArray(out_stream, model.freqi_freqj_qij, mat_size);
+  writeCheckpointArray(out_stream, model.freq_j_transposed_ij, mat_size);
+  // pseu_mutation_count is only allocated for models with estimated rates
+  writeCheckpointValue<uint8_t>(out_stream,
+                                model.pseu_mutation_count ? 1 : 0);
+  if (model.pseu_mutation_count) {
+    writeCheckpointArray(out_stream, model.pseu_mutation_count, mat_size);
+  }
+  writeCheckpointValue(out_stream, model.normalized_factor);
+  writeCheckpointValue<uint8_t>(out_stream, model.jc_rates);
+}
+
+/**
+ Read the model parameters from a checkpoint
+ @throw std::invalid_argument if the checkpoint is truncated or doesn't match
+ the model
+ */
+auto readCheckpointModel(std::istream& in_stream, const ModelBase& model)
+    -> CheckpointModelParams {
+  const uint64_t num_states = static_cast<uint64_t>(model.num_states_);
+  const uint64_t mat_size = num_states * num_states;
+  if (readCheckpointValue<uint32_t>(in_stream) != model.sub_model) {
+    throw std::invalid_argument(
+        "The checkpoint was written with a different substitution model");
+  }
+
+  CheckpointModelParams model_params;
+  const auto read_array = [&in_stream](std::vector<RealNumType>& values,
+                                       const uint64_t num_values) {
+    values.resize(num_values);
+    readCheckpointArray(in_stream, values.data(), num_values);
+  };
+  read_array(model_params.root_freqs, num_states);
+  read_array(model_params.root_log_freqs, num_states);
+  read_array(model_params.inverse_root_freqs, num_states);
+  read_array(model_params.diagonal_mut_mat, num_states);
+  read_array(model_params.mutation_mat, mat_size);
+  read_array(model_params.transposed_mut_mat, mat_size);
+  read_array(model_params.freqi_freqj_qij, mat_size);
+  read_array(model_params.freq_j_transposed_ij, mat_size);
+  if (readCheckpointValue<uint8_t>(in_stream)) {
+    read_array(model_params.pseu_mutation_count, mat_size);
+  }
+  model_params.normalized_factor = readCheckpointValue<RealNumType>(in_stream);
+  model_params.jc_rates = readCheckpointValue<uint8_t>(in_stream);
+  return model_params;
+}
+
+/**
+ Copy the values of a vector into a (possibly unallocated) array of the model
+ */
+void restoreModelArray(RealNumType*& model_array,
+                       const std::vector<RealNumType>& values) {
+  if (values.empty()) {
+    return;
+  }
+  if (model_array == nullptr) {
+    model_array = new RealNumType[values.size()];
+  }
+  memcpy(model_array, values.data(), values.size() * sizeof(RealNumType));
+}
+}  // namespace
+
+void cmaple::Tree::saveCheckpoint(std::ostream& out_stream) {
+  assert(aln && model && cumulative_rate);
+  const uint64_t seq_length = aln->ref_seq.size();
+  const uint64_t num_states = static_cast<uint64_t>(model->num_states_);
+
+  // header
+  out_stream.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+  writeCheckpointValue(out_stream, CHECKPOINT_VERSION);
+  writeCheckpointValue<uint32_t>(out_stream, sizeof(SeqRegion::LHType));
+  writeCheckpointValue<uint64_t>(out_stream, seq_length);
+  writeCheckpointValue<uint64_t>(out_stream, seq_names.size());
+
+  // the sequences and whether they were added to the tree
+  for (const std::string& seq_name : seq_names) {
+    writeCheckpointString(out_stream, seq_name);
+  }
+  for (std::vector<bool>::size_type i = 0; i < sequence_added.size(); ++i) {
+    writeCheckpointValue<uint8_t>(
+        out_stream, sequence_added[i]     ? SEQ_ADDED
+                    : sequence_removed[i] ? SEQ_REMOVED
+                                          : SEQ_NOT_ADDED);
+  }
+  writeCheckpointValue<uint8_t>(out_stream, fixed_blengths);
+  writeCheckpointValue(out_stream, progress);
+
+  // model parameters and the cumulative rates/bases derived from them
+  writeCheckpointModel(out_stream, *model);
+  writeCheckpointArray(out_stream, cumulative_rate, seq_length + 1);
+  for (const std::vector<PositionType>& bases : cumulative_base) {
+    writeCheckpointArray(out_stream, bases.data(), num_states);
+  }
+
+  // the tree
+  writeCheckpointValue(out_stream, root_vector_index);
+  writeCheckpointValue<uint64_t>(out_stream, node_lhs.size());
+  writeCheckpointArray(out_stream, node_lhs.data(), node_lhs.size());
+  writeCheckpointValue<uint64_t>(out_stream, nodes.size());
+  for (PhyloNode& node : nodes) {
+    writeCheckpointValue<uint8_t>(out_stream, node.isInternal());
+    writeCheckpointValue<uint8_t>(out_stream, node.isOutdated());
+    writeCheckpointValue<uint8_t>(out_stream, node.getSPRCount());
+    writeCheckpointValue(out_stream, node.getUpperLength());
+    writeCheckpointRegions(out_stream, node.getTotalLh());
+    writeCheckpointRegions(out_stream, node.getMidBranchLh());
+    if (node.isInternal()) {
+      for (const MiniIndex mini_index : {TOP, LEFT, RIGHT}) {
+        writeCheckpointValue(out_stream, node.getNeighborIndex(mini_index));
+        writeCheckpointRegions(out_stream, node.getPartialLh(mini_index));
+      }
+      writeCheckpointValue(out_stream, node.getNodelhIndex());
+    } else {
+      writeCheckpointValue(out_stream, node.getSeqNameIndex());
+      writeCheckpointValue(out_stream, node.getNeighborIndex(TOP));
+      writeCheckpointRegions(out_stream, node.getPartialLh(TOP));
+      const std::vector<NumSeqsType>& less_info_seqs = node.getLessInfoSeqs();
+      writeCheckpointValue<uint64_t>(out_stream, less_info_seqs.size());
+      writeCheckpointArray(out_stream, less_info_seqs.data(),
+                           less_info_seqs.size());
+    }
+  }
+
+  if (!out_stream) {
+    throw ios::failure("Failed to write the checkpoint");
+  }
+}
+
+void cmaple::Tree::saveCheckpoint(const std::string& checkpoint_filename) {
+  if (!checkpoint_filename.length()) {
+    throw std::invalid_argument("The checkpoint file name is empty");
+  }
+
+  std::ofstream out_stream(checkpoint_filename, ios::out | ios::binary);
+  saveCheckpoint(out_stream);
+  out_stream.close();
+  if (!out_stream) {
+    throw ios::failure("Failed to write the checkpoint file " +
+                       checkpoint_filename);
+  }
+}
+
+void cmaple::Tree::loadCheckpoint(std::istream& in_stream) {
+  assert(aln && model);
+  const uint64_t seq_length = aln->ref_seq.size();
+  const uint64_t num_seqs = aln->data.size();
+  const uint64_t num_states = static_cast<uint64_t>(model->num_states_);
+
+  // validate the header
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  readCheckpointArray(in_stream, magic, sizeof(magic));
+  if (memcmp(magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC))) {
+    throw std::invalid_argument("Invalid checkpoint: unknown file type");
+  }
+  const auto version = readCheckpointValue<uint32_t>(in_stream);
+  // version 1 only differs by not recording the removed sequences
+  if (version < 1 || version > CHECKPOINT_VERSION) {
+    throw std::invalid_argument(
+        "Unsupported version of checkpoint: " +
+        convertIntToString(static_cast<int>(version)));
+  }
+  if (readCheckpointValue<uint32_t>(in_stream) != sizeof(SeqRegion::LHType)) {
+    throw std::invalid_argument(
+        "The checkpoint was written for a different sequence type");
+  }
+  if (readCheckpointValue<uint64_t>(in_stream) != seq_length ||
+      readCheckpointValue<uint64_t>(in_stream) != num_seqs) {
+    throw std::invalid_argument(
+        "The checkpoint was written with a different alignment");
+  }
+
+  // the sequences must be the same (and in the same order) as in the alignment
+  for (uint64_t i = 0; i < num_seqs; ++i) {
+    if (readCheckpointString(in_stream) != aln->data[i].seq_name) {
+      throw std::invalid_argument(
+          "The checkpoint was written with a different alignment");
+    }
+  }
+  std::vector<bool> new_sequence_added(num_seqs);
+  std::vector<bool> new_sequence_removed(num_seqs);
+  for (uint64_t i = 0; i < num_seqs; ++i) {
+    const auto seq_state = readCheckpointValue<uint8_t>(in_stream);
+    if (seq_state > SEQ_REMOVED) {
+      throw std::invalid_argument("Invalid checkpoint: file is corrupted");
+    }
+    new_sequence_added[i] = seq_state == SEQ_ADDED;
+    new_sequence_removed[i] = seq_state == SEQ_REMOVED;
+  }
+  const bool new_fixed_blengths = readCheckpointValue<uint8_t>(in_stream);
+  const auto new_progress = readCheckpointValue<InferenceProgress>(in_stream);
+  if (new_progress.stage > TREE_SEARCH_STAGE) {
+    throw std::invalid_argument("Invalid checkpoint: file is corrupted");
+  }
+
+  // model parameters and cumulative rates/bases
+  const CheckpointModelParams model_params =
+      readCheckpointModel(in_stream, *model);
+  std::vector<RealNumType> new_cumulative_rate(seq_length + 1);
+  readCheckpointArray(in_stream, new_cumulative_rate.data(), seq_length + 1);
+  std::vector<std::vector<PositionType>> new_cumulative_base(
+      seq_length + 1, std::vector<PositionType>(num_states));
+  for (std::vector<PositionType>& bases : new_cumulative_base) {
+    readCheckpointArray(in_stream, bases.data(), num_states);
+  }
+
+  // the tree
+  const auto new_root_vector_index = readCheckpointValue<NumSeqsType>(in_stream);
+  std::vector<NodeLh> new_node_lhs(
+      readCheckpointSize(in_stream, num_seqs + num_seqs), NodeLh(0));
+  readCheckpointArray(in_stream, new_node_lhs.data(), new_node_lhs.size());
+  const uint64_t num_nodes = readCheckpointSize(in_stream, num_seqs + num_seqs);
+  std::vector<PhyloNode> new_nodes;
+  new_nodes.reserve(std::max(num_nodes, num_seqs + num_seqs));
+  const auto read_index = [&in_stream, num_nodes]() {
+    const auto index = readCheckpointValue<Index>(in_stream);
+    if (index.getMiniIndex() != UNDEFINED &&
+        index.getVectorIndex() >= num_nodes) {
+      throw std::invalid_argument("Invalid checkpoint: file is corrupted");
+    }
+    return index;
+  };
+  for (uint64_t i = 0; i < num_nodes; ++i) {
+    const bool is_internal = readCheckpointValue<uint8_t>(in_stream);
+    const bool outdated = readCheckpointValue<uint8_t>(in_stream);
+    const auto spr_count = readCheckpointValue<uint8_t>(in_stream);
+    const auto length = readCheckpointValue<RealNumType>(in_stream);
+    std::unique_ptr<SeqRegions> total_lh =
+        readCheckpointRegions(in_stream, seq_length);
+    std::unique_ptr<SeqRegions> mid_branch_lh =
+        readCheckpointRegions(in_stream, seq_length);
+
+    if (is_internal) {
+      new_nodes.emplace_back(InternalNode());
+      PhyloNode& node = new_nodes.back();
+      for (const MiniIndex mini_index : {TOP, LEFT, RIGHT}) {
+        node.setNeighborIndex(mini_index, read_index());
+        node.setPartialLh(mini_index,
+                          readCheckpointRegions(in_stream, seq_length));
+      }
+      const auto node_lh_index = readCheckpointValue<NumSeqsType>(in_stream);
+      if (node_lh_index >= new_node_lhs.size()) {
+        throw std::invalid_argument("Invalid checkpoint: file is corrupted");
+      }
+      node.setNodeLhIndex(node_lh_index);
+    } else {
+      const auto seq_name_index = readCheckpointValue<NumSeqsType>(in_stream);
+      if (seq_name_index >= num_seqs) {
+        throw std::invalid_argument("Invalid checkpoint: file is corrupted");
+      }
+      new_nodes.emplace_back(LeafNode(seq_name_index));
+      PhyloNode& node = new_nodes.back();
+      node.setNeighborIndex(TOP, read_index());
+      node.setPartialLh(TOP, readCheckpointRegions(in_stream, seq_length));
+      std::vector<NumSeqsType>& less_info_seqs = node.getLessInfoSeqs();
+      less_info_seqs.resize(readCheckpointSize(in_stream, num_seqs));
+      readCheckpointArray(in_stream, less_info_seqs.data(),
+                          less_info_seqs.size());
+    }
+
+    PhyloNode& node = new_nodes.back();
+    node.setOutdated(outdated);
+    node.setSPRCount(spr_count);
+    node.setUpperLength(length);
+    node.setTotalLh(std::move(total_lh));
+    node.setMidBranchLh(std::move(mid_branch_lh));
+  }
+  if (num_nodes && new_root_vector_index >= num_nodes) {
+    throw std::invalid_argument("Invalid checkpoint: file is corrupted");
+  }
+
+  // the whole checkpoint is valid -> update the tree and the model
+  nodes = std::move(new_nodes);
+  node_lhs = std::move(new_node_lhs);
+  root_vector_index = new_root_vector_index;
+  initFreeNodes();
+  mutation_leaves.clear();
+  mutation_counts.clear();
+  sequence_added = std::move(new_sequence_added);
+  sequence_removed = std::move(new_sequence_removed);
+  fixed_blengths = new_fixed_blengths;
+  progress = new_progress;
+  resume_progress = true;
+  cumulative_base = std::move(new_cumulative_base);
+  if (cumulative_rate == nullptr) {
+    cumulative_rate = new RealNumType[seq_length + 1];
+  }
+  memcpy(cumulative_rate, new_cumulative_rate.data(),
+         (seq_length + 1) * sizeof(RealNumType));
+
+  restoreModelArray(model->root_freqs, model_params.root_freqs);
+  restoreModelArray(model->root_log_freqs, model_params.root_log_freqs);
+  restoreModelArray(model->inverse_root_freqs,
+                    model_params.inverse_root_freqs);
+  restoreModelArray(model->diagonal_mut_mat, model_params.diagonal_mut_mat);
+  restoreModelArray(model->mutation_mat, model_params.mutation_mat);
+  restoreModelArray(model->transposed_mut_mat,
+                    model_params.transposed_mut_mat);
+  restoreModelArray(model->freqi_freqj_qij, model_params.freqi_freqj_qij);
+  restoreModelArray(model->freq_j_transposed_ij,
+                    model_params.freq_j_transposed_ij);
+  restoreModelArray(model->pseu_mutation_count,
+                    model_params.pseu_mutation_count);
+  model->normalized_factor = model_params.normalized_factor;
+  model->jc_rates = model_params.jc_rates;
+}
+
+void cmaple::Tree::loadCheckpoint(const std::string& checkpoint_filename) {
+  if (!checkpoint_filename.length()) {
+    throw std::invalid_argument("The checkpoint file name is empty");
+  }
+
+  std::ifstream in_stream;
+  try {
+    in_stream.exceptions(ios::badbit);
+    in_stream.open(checkpoint_filename, ios::in | ios::binary);
+    if (!in_stream.is_open()) {
+      throw ios::failure(ERR_READ_INPUT);
+    }
+    loadCheckpoint(in_stream);
+    in_stream.close();
+  } catch (ios::failure const& e) {
+    std::string error_msg(ERR_READ_INPUT);
+    throw ios::failure(error_msg + checkpoint_filename);
+  }
+}
+
+namespace {
+/**
+ Replace the target file by the source file, overwriting the target if it
+ already exists (std::rename fails on Windows in that case)
+ @return TRUE on success
+ */
+auto replaceFile(const std::string& source, const std::string& target)
+    -> bool {
+#if defined(WIN32) || defined(WIN64)
+  return MoveFileExA(source.c_str(), target.c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return !std::rename(source.c_str(), target.c_str());
+#endif
+}
+}  // namespace
+
+void cmaple::Tree::writeAutoCheckpoint(const InferenceStage stage,
+                                       const int32_t round,
+                                       const int32_t subround,
+                                       const bool force) {
+  // do nothing if users don't specify a checkpoint file
+  if (!params || !params->checkpoint_filename.length()) {
+    return;
+  }
+
+  // don't write checkpoints too often
+  if (!force &&
+      getRealTime() - last_checkpoint_time < params->checkpoint_interval) {
+    return;
+  }
+
+  progress.stage = stage;
+  progress.round = round;
+  progress.subround = subround;
+
+  // write to a temporary file first, then replace the checkpoint file by it
+  const std::string& checkpoint_filename = params->checkpoint_filename;
+  const std::string tmp_filename = checkpoint_filename + ".tmp";
+  saveCheckpoint(tmp_filename);
+  if (!replaceFile(tmp_filename, checkpoint_filename)) {
+    throw ios::failure("Failed to write the checkpoint file " +
+                       checkpoint_filename);
+  }
+
+  if (cmaple::verbose_mode >= cmaple::VB_MAX) {
+    std::cout << "Checkpoint written to " << checkpoint_filename << std::endl;
+  }
+  last_checkpoint_time = getRealTime();
+}
+
 void cmaple::Tree::setupFuncPtrs() {
   assert(aln);
 
@@ -216,6 +774,8 @@ void cmaple::Tree::setupFuncPtrs() {
       doInferencePtr = &Tree::doInferenceTemplate<4>;
       computeLhPtr = &Tree::computeLhTemplate<4>;
       computeBranchSupportPtr = &Tree::computeBranchSupportTemplate<4>;
+      placeQueriesPtr = &Tree::placeQueriesTemplate<4>;
+      removeSamplesPtr = &Tree::removeSamplesTemplate<4>;
       makeTreeInOutConsistentPtr = &Tree::makeTreeInOutConsistentTemplate<4>;
       break;
     case 20:
@@ -228,6 +788,8 @@ void cmaple::Tree::setupFuncPtrs() {
       doInferencePtr = &Tree::doInferenceTemplate<20>;
       computeLhPtr = &Tree::computeLhTemplate<20>;
       computeBranchSupportPtr = &Tree::computeBranchSupportTemplate<20>;
+      placeQueriesPtr = &Tree::placeQueriesTemplate<20>;
+      removeSamplesPtr = &Tree::removeSamplesTemplate<20>;
       makeTreeInOutConsistentPtr = &Tree::makeTreeInOutConsistentTemplate<20>;
       break;
 
@@ -254,12 +816,47 @@ void cmaple::Tree::setupBlengthThresh() {
   params->threshold_prob2 = params->threshold_prob * params->threshold_prob;
 }
 
+namespace {
+/**
+ Hash the mutations of a sequence (to find identical sequences)
+ */
+auto hashMutations(const Sequence& sequence) -> std::size_t {
+  std::size_t hash = sequence.size();
+  for (const Mutation& mutation : sequence) {
+    const std::size_t value =
+        (static_cast<std::size_t>(mutation.position) << 24) ^
+        (static_cast<std::size_t>(mutation.getLength()) << 8) ^ mutation.type;
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+}  // namespace
+
 void cmaple::Tree::resetSeqAdded() {
   assert(aln);
   const std::vector<cmaple::Sequence>::size_type num_sequences = aln->data.size();
   sequence_added.resize(num_sequences);
   for (std::vector<bool>::size_type i = 0; i < num_sequences; ++i)
     sequence_added[i] = false;
+  sequence_removed.assign(num_sequences, false);
+}
+
+void cmaple::Tree::registerNewSeqs() {
+  assert(aln);
+  const std::vector<cmaple::Sequence>::size_type num_sequences = aln->data.size();
+  if (sequence_added.size() >= num_sequences) {
+    return;
+  }
+
+  sequence_added.resize(num_sequences, false);
+  sequence_removed.resize(num_sequences, false);
+  seq_names.reserve(num_sequences);
+  seq_hashes.reserve(num_sequences);
+  for (std::vector<std::string>::size_type i = seq_names.size();
+       i < num_sequences; ++i) {
+    seq_names.push_back(aln->data[i].seq_name);
+    seq_hashes.push_back(hashMutations(aln->data[i]));
+  }
 }
 
 void cmaple::Tree::attachAlnModel(Alignment* n_aln, ModelBase* n_model) {
@@ -299,10 +896,13 @@ void cmaple::Tree::attachAlnModel(Alignment* n_aln, ModelBase* n_model) {
   // init params & thresholds
   setupBlengthThresh();
 
-  // extract a backup vector of sequence names
+  // extract a backup vector of sequence names (and their mutations' hashes)
   seq_names.resize(num_seqs);
-  for (std::vector<cmaple::Sequence>::size_type i = 0; i < num_seqs; ++i)
+  seq_hashes.resize(num_seqs);
+  for (std::vector<cmaple::Sequence>::size_type i = 0; i < num_seqs; ++i) {
     seq_names[i] = aln->data[i].seq_name;
+    seq_hashes[i] = hashMutations(aln->data[i]);
+  }
 
   // update model according to the data from the alignment
   try {
@@ -321,6 +921,7 @@ void cmaple::Tree::updateModelByAln() {
     
   // extract related info (freqs, log_freqs) of the ref sequence
   model->extractRefInfo(aln);
+  attached_ref_seq = aln->ref_seq;
 
   // update the mutation matrix
   model->updateMutationMatEmpirical();
@@ -338,6 +939,10 @@ void cmaple::Tree::loadTreeTemplate(std::istream& tree_stream,
   // reset nodes
   nodes.clear();
   nodes.reserve(num_seqs + num_seqs);
+  free_internal_vec_indexes.clear();
+  free_leaf_vec_indexes.clear();
+  mutation_leaves.clear();
+  mutation_counts.clear();
   // reset node_lhs
   node_lhs.clear();
   node_lhs.reserve(num_seqs);
@@ -428,6 +1033,12 @@ void cmaple::Tree::changeAlnTemplate(Alignment* n_aln) {
     std::cout << "Changing the alignment" << std::endl;
   }
 
+  // the partial likelihoods and model params only depend on the reference
+  // sequence and the sequences already in the tree. Thus, if the reference and
+  // the mutations of those sequences (matched by names) are unchanged, keep
+  // them and only queue the new sequences for the next placement
+  bool same_ref = n_aln->ref_seq == attached_ref_seq;
+
   // change the alignment
   aln = n_aln;
   // record the current tree in the list of trees that the alignment is attached
@@ -436,15 +1047,24 @@ void cmaple::Tree::changeAlnTemplate(Alignment* n_aln) {
 
   // re-mark taxa in the new alignment, which already existed in the current
   // tree
-  remarkExistingSeqs();
+  same_ref = remarkExistingSeqs() && same_ref;
 
-  // extract a backup vector of sequence names
+  // extract a backup vector of sequence names (and their mutations' hashes)
   seq_names.resize(aln->data.size());
-  for (std::vector<cmaple::Sequence>::size_type i = 0; i < aln->data.size(); ++i)
+  seq_hashes.resize(aln->data.size());
+  for (std::vector<cmaple::Sequence>::size_type i = 0; i < aln->data.size();
+       ++i) {
     seq_names[i] = aln->data[i].seq_name;
+    seq_hashes[i] = hashMutations(aln->data[i]);
+  }
 
   // update model according to the data in the new alignment
-  updateModelByAln();
+  if (!same_ref) {
+    updateModelByAln();
+    // the mutations are re-indexed on demand
+    mutation_leaves.clear();
+    mutation_counts.clear();
+  }
 
   // make sure users can only keep the blengths fixed if they input a complete
   // tree with branch lengths
@@ -459,7 +1079,26 @@ void cmaple::Tree::changeAlnTemplate(Alignment* n_aln) {
   }
 
   // update Model params and partial lhs along the current tree (if any)
-  updateModelLhAfterLoading<num_states>();
+  if (!same_ref) {
+    // re-compute the lower lhs at the leaves from the new sequences
+    const PositionType seq_length =
+        static_cast<PositionType>(aln->ref_seq.size());
+    for (std::vector<cmaple::PhyloNode>::size_type i = 0; i < nodes.size();
+         ++i) {
+      if (!nodes[i].isInternal() && !isFreeNode(i)) {
+        PhyloNode& leaf = nodes[i];
+        leaf.setPartialLh(TOP, aln->data[leaf.getSeqNameIndex()].getLowerLhVector(
+                                   seq_length, num_states, aln->getSeqType()));
+      }
+    }
+
+    updateModelLhAfterLoading<num_states>();
+  } else if (cmaple::verbose_mode >= cmaple::VB_MED) {
+    std::cout << "Keeping the partial likelihoods of the current tree as the "
+                 "reference sequence and the sequences in the tree are "
+                 "unchanged"
+              << std::endl;
+  }
 }
 
 template <const cmaple::StateType num_states>
@@ -541,6 +1180,78 @@ void cmaple::Tree::doInferenceTemplate(
   cout.rdbuf(src_cout);
 }
 
+namespace {
+/**
+ Get the bit of a mutation (to a specific state) in the masks of mutations
+ */
+auto getMutationMaskBit(const Mutation& mutation, const StateType num_states)
+    -> std::uint16_t {
+  const std::uint64_t key =
+      static_cast<std::uint64_t>(mutation.position) * num_states +
+      mutation.type;
+  // the top 8 bits of a multiplicative hash: 0..255
+  return static_cast<std::uint16_t>((key * 0x9e3779b97f4a7c15ULL) >> 56);
+}
+
+/**
+ Get the size of the blocks of positions in the masks of missing data, such
+ that the whole sequence fits in 256 blocks
+ */
+auto getMissingDataBlockSize(const PositionType seq_length) -> PositionType {
+  return std::max<PositionType>(1, (seq_length + 255) / 256);
+}
+
+/**
+ Compute the parsimony distance between two sequences, i.e., the number of
+ positions where one sequence has a mutation to a specific state while the
+ other has the reference or another specific state (positions with missing or
+ ambiguous data in either sequence are ignored)
+ */
+auto computeParsimonyDistance(const Sequence& sequence1,
+                              const Sequence& sequence2,
+                              const StateType num_states) -> PositionType {
+  // count the mutations in sequence1 not shared by sequence2; then the
+  // mutations in sequence2 at the reference positions of sequence1
+  PositionType distance = 0;
+  for (int pass = 0; pass < 2; ++pass) {
+    const Sequence& mutations = pass ? sequence2 : sequence1;
+    const Sequence& others = pass ? sequence1 : sequence2;
+    Sequence::const_iterator other = others.begin();
+    for (const Mutation& mutation : mutations) {
+      if (mutation.type >= num_states) {
+        continue;
+      }
+
+      while (other != others.end() &&
+             other->position + other->getLength() <= mutation.position) {
+        ++other;
+      }
+      if (other == others.end() || other->position > mutation.position) {
+        ++distance;
+      } else if (!pass && other->type < num_states &&
+                 other->type != mutation.type) {
+        ++distance;
+      }
+    }
+  }
+  return distance;
+}
+
+/**
+ TRUE if two sequences have the same mutations
+ */
+auto haveSameMutations(const Sequence& sequence1, const Sequence& sequence2)
+    -> bool {
+  return std::equal(sequence1.begin(), sequence1.end(), sequence2.begin(),
+                    sequence2.end(),
+                    [](const Mutation& mutation1, const Mutation& mutation2) {
+                      return mutation1.position == mutation2.position &&
+                             mutation1.type == mutation2.type &&
+                             mutation1.getLength() == mutation2.getLength();
+                    });
+}
+}  // namespace
+
 template <const StateType num_states>
 void cmaple::Tree::doPlacementTemplate(std::ostream& out_stream) {
   assert(cumulative_rate);
@@ -561,6 +1272,8 @@ void cmaple::Tree::doPlacementTemplate(std::ostream& out_stream) {
   if (aln->attached_trees.find(this) == aln->attached_trees.end()) {
     changeAln(aln);
   }
+  // also place the sequences appended to the alignment since then
+  registerNewSeqs();
 
   // show information
   if (cmaple::verbose_mode >= cmaple::VB_MED) {
@@ -578,53 +1291,140 @@ void cmaple::Tree::doPlacementTemplate(std::ostream& out_stream) {
   std::vector<cmaple::Sequence>::size_type num_new_sequences = num_seqs;
   Sequence* sequence = &aln->data.front();
   // make sure we allocate enough space to store all nodes
+  // (grow the capacity geometrically if the tree is extended repeatedly)
   if (nodes.capacity() < num_seqs + num_seqs)
-    nodes.reserve(num_seqs + num_seqs);
+    nodes.reserve(std::max(num_seqs + num_seqs,
+                           nodes.capacity() + nodes.capacity() / 2));
   std::vector<cmaple::Sequence>::size_type i = 0;
   std::vector<cmaple::Sequence>::size_type count_every_1K = 0;
+  // the number of samples in the tree (including the identical ones)
+  std::vector<cmaple::Sequence>::size_type num_placed = static_cast<
+      std::vector<cmaple::Sequence>::size_type>(
+      std::count(sequence_added.begin(), sequence_added.end(), true));
+  // TRUE if the model parameters were updated in this pass
+  bool model_updated = false;
+  // the order to place the samples in (the first one becomes the root)
+  const std::vector<NumSeqsType> placement_order = computePlacementOrder();
+
+  // index the mutations of the existing leaves to seed the placement search
+  if ((params->seed_placement || params->parsimony_placement_radius >= 0) &&
+      mutation_leaves.empty()) {
+    buildMutationIndex();
+  }
+  // (re)build the masks of mutations to bound the placement costs (the tree may
+  // have changed since they were last built)
+  if (params->bound_placement) {
+    buildMutationMasks();
+  }
+
+  // the leaves holding the sequences already in the tree (by the hashes of
+  // their mutations), to attach identical sequences directly to them
+  std::unordered_multimap<std::size_t, std::pair<NumSeqsType, NumSeqsType>>
+      leaves_by_mutations;
+  if (from_input_tree && std::find(sequence_added.begin(), sequence_added.end(),
+                                   false) != sequence_added.end()) {
+    for (const NumSeqsType vec_index : collectLeafVecIndexes()) {
+      const NumSeqsType seq_index = nodes[vec_index].getSeqNameIndex();
+      leaves_by_mutations.emplace(seq_hashes[seq_index],
+                                  std::make_pair(seq_index, vec_index));
+      for (const NumSeqsType less_info_seq : nodes[vec_index].getLessInfoSeqs())
+        leaves_by_mutations.emplace(seq_hashes[less_info_seq],
+                                    std::make_pair(less_info_seq, vec_index));
+    }
+  }
 
   // if users don't input a tree -> create the root from the first sequence
   if (!from_input_tree) {
     // place the root node
-    root_vector_index = 0;
-    nodes.emplace_back(LeafNode(0));
+    root_vector_index = createALeafNode(0);
     PhyloNode& root = nodes[0];
     root.setPartialLh(TOP, std::move(sequence->getLowerLhVector(
                                seq_length, num_states, aln->getSeqType())));
     root.getPartialLh(TOP)->computeTotalLhAtRoot<num_states>(root.getTotalLh(),
                                                              model);
     root.setUpperLength(0);
+    leaves_by_mutations.emplace(seq_hashes[0],
+                                std::make_pair(0, root_vector_index));
+    if (params->bound_placement) {
+      updateMutationMasks(root_vector_index);
+    }
 
     // move to the next sequence in the alignment
     sequence_added[i] = true;
     ++sequence;
     ++i;
-  }
+    ++num_placed;
+  }
+
+  // the most recent placements (in a ring buffer), to start seeking the
+  // placements of similar samples next to them
+  struct PlacementHint {
+    NumSeqsType seq_index = 0;
+    NumSeqsType leaf_vec_index = 0;
+    RealNumType lh_diff = 0;
+  };
+  const std::size_t max_num_placement_hints = 16;
+  std::vector<PlacementHint> placement_hints;
+  std::size_t next_placement_hint = 0;
+  // the number of samples placed by searching next to such hints (or not, if
+  // that local search failed)
+  NumSeqsType num_placed_by_hints = 0;
+  NumSeqsType num_failed_hints = 0;
 
   // iteratively place other samples (sequences)
-  for (; i < num_seqs; ++i, ++sequence) {
-    // don't add sequence that was already added in the input tree
-    if (from_input_tree && sequence_added[i]) {
+  for (; i < num_seqs; ++i) {
+    const NumSeqsType seq_index = placement_order[i];
+    sequence = &aln->data[seq_index];
+
+    // don't add sequence that was already added in the input tree (or removed
+    // from it)
+    if (from_input_tree &&
+        (sequence_added[seq_index] || sequence_removed[seq_index])) {
       --num_new_sequences;
       continue;
     }
     // otherwise, mark the current sequence as added
     else {
-      sequence_added[i] = true;
-    }
+      // write a checkpoint (if needed) before placing the current sequence
+      const std::vector<cmaple::Sequence>::size_type checkpoint_period =
+          static_cast<std::vector<cmaple::Sequence>::size_type>(
+              params->checkpoint_placement_period);
+      writeAutoCheckpoint(PLACEMENT_STAGE, 0, -1,
+                          checkpoint_period && !(i % checkpoint_period));
 
-    // get the lower likelihood vector of the current sequence
-    std::unique_ptr<SeqRegions> lower_regions =
-        sequence->getLowerLhVector(seq_length, num_states, aln->getSeqType());
+      sequence_added[seq_index] = true;
+    }
 
     // update the mutation matrix from empirical number of mutations observed
-    // from the recent sequences (if allowed)
-    if (!(i % (static_cast<std::vector<cmaple::Sequence>
+    // from the recent sequences (if allowed). The period is counted by the
+    // samples in the tree, so that adding a few samples to an existing tree
+    // rarely changes the model (and thus all likelihoods)
+    if (!(num_placed % (static_cast<std::vector<cmaple::Sequence>
                ::size_type>(params->mutation_update_period)))) {
       if (model->updateMutationMatEmpirical()) {
         computeCumulativeRate();
+        model_updated = true;
       }
     }
+    ++num_placed;
+
+    // if the sequence is identical to one already in the tree -> add it into
+    // the list of minor sequences of the leaf holding that sequence
+    const std::size_t mutations_hash = seq_hashes[seq_index];
+    const auto identical_range = leaves_by_mutations.equal_range(mutations_hash);
+    const auto identical_it = std::find_if(
+        identical_range.first, identical_range.second,
+        [this, sequence](const auto& entry) {
+          return haveSameMutations(aln->data[entry.second.first], *sequence);
+        });
+    if (identical_it != identical_range.second) {
+      nodes[identical_it->second.second].addLessInfoSeqs(seq_index);
+      continue;
+    }
+
+    // get the lower likelihood vector of the current sequence
+    std::unique_ptr<SeqRegions> lower_regions =
+        sequence->getLowerLhVector(seq_length, num_states, aln->getSeqType());
 
     // NHANLT: debug
     // if ((*sequence)->seq_name == "39")
@@ -637,27 +1437,100 @@ void cmaple::Tree::doPlacementTemplate(std::ostream& out_stream) {
     RealNumType best_up_lh_diff = MIN_NEGATIVE;
     RealNumType best_down_lh_diff = MIN_NEGATIVE;
     Index best_child_index;
-    seekSamplePlacement<num_states>(
-        Index(root_vector_index, TOP), static_cast<NumSeqsType>(i),
-        lower_regions, selected_node_index, best_lh_diff, is_mid_branch,
-        best_up_lh_diff, best_down_lh_diff, best_child_index);
-
-    // if new sample is not less informative than existing nodes (~selected_node
-    // != NULL) -> place the new sample in the existing tree
-    if (selected_node_index.getMiniIndex() != UNDEFINED) {
+
+    // find the recent placement of the most similar sample (if any)
+    const PlacementHint* hint = nullptr;
+    PositionType hint_distance = 0;
+    for (const PlacementHint& placement_hint : placement_hints) {
+      const PositionType distance = computeParsimonyDistance(
+          *sequence, aln->data[placement_hint.seq_index], num_states);
+      if (distance <= params->placement_hint_distance &&
+          (!hint || distance < hint_distance)) {
+        hint = &placement_hint;
+        hint_distance = distance;
+      }
+    }
+
+    // search around the placement of that sample first (from a few levels
+    // above it)
+    bool placed_by_hint = false;
+    if (hint) {
+      const NumSeqsType start_vec_index = liftPlacementStart(
+          hint->leaf_vec_index, params->failure_limit_sample);
+      seekSamplePlacement<num_states>(
+          Index(start_vec_index, TOP), seq_index, lower_regions,
+          selected_node_index, best_lh_diff, is_mid_branch, best_up_lh_diff,
+          best_down_lh_diff, best_child_index);
+
+      // the local search fails if the best placement is at the border of the
+      // searched subtree (so a better one may be outside) or much worse than
+      // that of the similar sample (allowing the cost of a mutation on a
+      // default-length branch per difference)
+      placed_by_hint =
+          selected_node_index.getMiniIndex() == UNDEFINED ||
+          ((selected_node_index.getVectorIndex() != start_vec_index ||
+            start_vec_index == root_vector_index) &&
+           best_lh_diff >=
+               hint->lh_diff + hint_distance * log(default_blength));
+      ++(placed_by_hint ? num_placed_by_hints : num_failed_hints);
+    }
+
+    // otherwise, fall back to seeking the placement from the usual start
+    if (!placed_by_hint) {
+      selected_node_index = Index();
+      best_lh_diff = MIN_NEGATIVE;
+      is_mid_branch = false;
+      best_up_lh_diff = MIN_NEGATIVE;
+      best_down_lh_diff = MIN_NEGATIVE;
+      best_child_index = Index();
+      int max_depth;
+      const Index start_index = selectPlacementStart(seq_index, max_depth);
+      seekSamplePlacement<num_states>(
+          start_index, seq_index, lower_regions, selected_node_index,
+          best_lh_diff, is_mid_branch, best_up_lh_diff, best_down_lh_diff,
+          best_child_index, max_depth);
+    }
+
+    // if new sample is less informative than an existing leaf -> add it into
+    // the list of minor sequences of that leaf
+    NumSeqsType leaf_vec_index = selected_node_index.getVectorIndex();
+    if (selected_node_index.getMiniIndex() == UNDEFINED) {
+      nodes[leaf_vec_index].addLessInfoSeqs(seq_index);
+    }
+    // otherwise, place the new sample in the existing tree
+    else {
       // place new sample as a descendant of a mid-branch point
       if (is_mid_branch) {
-        placeNewSampleMidBranch<num_states>(selected_node_index, lower_regions,
-                                    static_cast<NumSeqsType>(i), best_lh_diff);
+        leaf_vec_index = placeNewSampleMidBranch<num_states>(
+            selected_node_index, lower_regions, seq_index, best_lh_diff);
         // otherwise, best lk so far is for appending directly to existing
         // node
       } else {
-        placeNewSampleAtNode<num_states>(selected_node_index, lower_regions,
-                                         static_cast<NumSeqsType>(i),
-                                         best_lh_diff, best_up_lh_diff,
-                                         best_down_lh_diff, best_child_index);
+        leaf_vec_index = placeNewSampleAtNode<num_states>(
+            selected_node_index, lower_regions, seq_index, best_lh_diff,
+            best_up_lh_diff, best_down_lh_diff, best_child_index);
       }
     }
+    leaves_by_mutations.emplace(mutations_hash,
+                                std::make_pair(seq_index, leaf_vec_index));
+    if (params->bound_placement &&
+        selected_node_index.getMiniIndex() != UNDEFINED) {
+      updateMutationMasks(leaf_vec_index);
+    }
+
+    // record the placement as a hint for the next samples (replacing the
+    // oldest one)
+    if (params->placement_hint_distance >= 0) {
+      const PlacementHint placement_hint{
+          seq_index, leaf_vec_index,
+          selected_node_index.getMiniIndex() == UNDEFINED ? 0 : best_lh_diff};
+      if (placement_hints.size() < max_num_placement_hints) {
+        placement_hints.push_back(placement_hint);
+      } else {
+        placement_hints[next_placement_hint] = placement_hint;
+      }
+      next_placement_hint = (next_placement_hint + 1) % max_num_placement_hints;
+    }
 
     // NHANLT: debug
     // cout << "Added node " << (*sequence)->seq_name << endl;
@@ -681,6 +1554,20 @@ void cmaple::Tree::doPlacementTemplate(std::ostream& out_stream) {
     }
   }
 
+  if (params->placement_hint_distance >= 0 &&
+      cmaple::verbose_mode >= cmaple::VB_MED) {
+    std::cout << "Placed " << num_placed_by_hints
+              << " samples next to the placements of similar samples ("
+              << num_failed_hints << " local searches fell back)" << std::endl;
+  }
+
+  // the placement pass is completed (unless we resume a tree search from a
+  // checkpoint, which is completed later by infer())
+  if (!resume_progress || progress.stage == PLACEMENT_STAGE) {
+    resume_progress = false;
+    progress = InferenceProgress();
+  }
+
   // flag denotes whether there is any new nodes added
   // show the number of new sequences added to the tree
   if (num_new_sequences > 0) {
@@ -690,8 +1577,12 @@ void cmaple::Tree::doPlacementTemplate(std::ostream& out_stream) {
     }
 
     // traverse the intial tree from root to re-calculate all likelihoods
-    // regarding the latest/final estimated model parameters
-    refreshAllLhs<num_states>();
+    // regarding the latest/final estimated model parameters. If the samples
+    // were added to an existing tree without changing the model, the
+    // likelihoods were already updated along the paths of the placements
+    if (!from_input_tree || model_updated) {
+      refreshAllLhs<num_states>();
+    }
   } else if (cmaple::verbose_mode > cmaple::VB_QUIET) {
     std::cout << "All sequences were presented in the input tree. No new "
                  "sequence has been added!"
@@ -716,7 +1607,7 @@ void cmaple::Tree::doPlacementTemplate(std::ostream& out_stream) {
                : BIN_TREE;
 
     ofstream out = ofstream(prefix + "_init.treefile");
-    out << exportNewick(tree_format);
+    exportNewick(out, tree_format);
     out.close();
   }
 
@@ -778,12 +1669,16 @@ void cmaple::Tree::applySPRTemplate(
       tree_search_type = EXHAUSTIVE_TREE_SEARCH;
     }
 
-    // apply short-range SPR search
-    optimizeTreeTopology<num_states>(true);
-    // exportOutput(output_file + "_short_search.treefile");
+    // skip the shallow search if it was completed before the checkpoint that
+    // we resume from
+    if (!resume_progress || progress.stage != TREE_SEARCH_STAGE) {
+      // apply short-range SPR search
+      optimizeTreeTopology<num_states>(true);
+      // exportOutput(output_file + "_short_search.treefile");
 
-    // reset the SPR flags so that we can start a deeper SPR search later
-    resetSPRFlags(true, true);
+      // reset the SPR flags so that we can start a deeper SPR search later
+      resetSPRFlags(true, true);
+    }
 
     // Output the tree after the shallow-search for debugging
     if (cmaple::verbose_mode >= cmaple::VB_DEBUG) {
@@ -796,7 +1691,7 @@ void cmaple::Tree::applySPRTemplate(
                  : BIN_TREE;
 
       ofstream out = ofstream(prefix + "_shallow_search.treefile");
-      out << exportNewick(tree_format);
+      exportNewick(out, tree_format);
       out.close();
     }
   }
@@ -822,6 +1717,10 @@ void cmaple::Tree::applySPRTemplate(
     // exportOutput(output_file + "_topo.treefile");
   }
 
+  // the inference is completed -> later checkpoints must not resume it
+  resume_progress = false;
+  progress = InferenceProgress();
+
   // traverse the tree from root to re-calculate all likelihoods after
   // optimizing the tree topology
   refreshAllLhs<num_states>();
@@ -844,7 +1743,7 @@ void cmaple::Tree::applySPRTemplate(
                : BIN_TREE;
 
     ofstream out = ofstream(prefix + "_topo.treefile");
-    out << exportNewick(tree_format);
+    exportNewick(out, tree_format);
     out.close();
   }
 
@@ -905,30 +1804,49 @@ void cmaple::Tree::optimizeTreeTopology(bool short_range_search) {
   auto start = getRealTime();
   int num_tree_improvement =
       short_range_search ? 1 : params->num_tree_improvement;
+  const InferenceStage stage =
+      short_range_search ? SHALLOW_SEARCH_STAGE : TREE_SEARCH_STAGE;
 
-  for (int i = 0; i < num_tree_improvement; ++i) {
+  // resume from the round (and subround) recorded in the checkpoint (if any)
+  int start_round = 0;
+  int start_subround = -1;
+  if (resume_progress && progress.stage == stage) {
+    start_round = progress.round;
+    start_subround = progress.subround;
+    resume_progress = false;
+  }
+
+  for (int i = start_round; i < num_tree_improvement; ++i) {
     // first, set all nodes outdated
     // no need to do so anymore as new nodes were already marked as outdated
     // resetSPRFlags(true, true);
 
-    // traverse the tree from root to try improvements on the entire tree
-    RealNumType improvement = improveEntireTree<num_states>(short_range_search);
+    if (start_subround < 0) {
+      writeAutoCheckpoint(stage, i, -1);
 
-    // stop trying if the improvement is so small
-    if (improvement < params->thresh_entire_tree_improvement) {
-      if (cmaple::verbose_mode >= cmaple::VB_DEBUG) {
-        cout << "Small improvement, stopping topological search." << endl;
+      // traverse the tree from root to try improvements on the entire tree
+      RealNumType improvement =
+          improveEntireTree<num_states>(short_range_search);
+
+      // stop trying if the improvement is so small
+      if (improvement < params->thresh_entire_tree_improvement) {
+        if (cmaple::verbose_mode >= cmaple::VB_DEBUG) {
+          cout << "Small improvement, stopping topological search." << endl;
+        }
+        break;
       }
-      break;
     }
 
     // run improvements only on the nodes that have been affected by some
     // changes in the last round, and so on
-    for (int j = 0; j < 20; ++j) {
+    for (int j = std::max(start_subround, 0); j < 20; ++j) {
+      writeAutoCheckpoint(stage, i, j);
+
       // forget SPR_applied flag to allow new SPR moves
       resetSPRFlags(false, true);
 
-      improvement = improveEntireTree<num_states>(short_range_search);
+      const RealNumType improvement =
+          improveEntireTree<num_states>(short_range_search);
       if (cmaple::verbose_mode >= cmaple::VB_DEBUG) {
         cout << "Tree was improved by " + convertDoubleToString(improvement) +
                     " at subround " + convertIntToString(j + 1)
@@ -940,6 +1858,9 @@ void cmaple::Tree::optimizeTreeTopology(bool short_range_search) {
         break;
       }
     }
+
+    // only the resumed round starts from a subround
+    start_subround = -1;
   }
 
   // show the runtime for optimize the tree
@@ -1021,7 +1942,7 @@ void cmaple::Tree::optimizeBranchTemplate(std::ostream& out_stream) {
                : BIN_TREE;
 
     ofstream out = ofstream(prefix + "_opt_blengths.treefile");
-    out << exportNewick(tree_format);
+    exportNewick(out, tree_format);
     out.close();
   }
 
@@ -1063,15 +1984,674 @@ RealNumType cmaple::Tree::computeLhTemplate() {
   return total_lh;
 }
 
-void cmaple::Tree::computeBranchSupport(
-    const int num_threads,
-    const int num_replicates,
-    const double epsilon,
-    const bool allow_replacing_ML_tree,
-    std::ostream& out_stream) {
-    assert(computeBranchSupportPtr);
-  (this->*computeBranchSupportPtr)(num_threads, num_replicates, epsilon,
-                                          allow_replacing_ML_tree, out_stream);
+void cmaple::Tree::computeBranchSupport(
+    const int num_threads,
+    const int num_replicates,
+    const double epsilon,
+    const bool allow_replacing_ML_tree,
+    std::ostream& out_stream) {
+    assert(computeBranchSupportPtr);
+  (this->*computeBranchSupportPtr)(num_threads, num_replicates, epsilon,
+                                          allow_replacing_ML_tree, out_stream);
+}
+
+void cmaple::Tree::placeQueries(std::ostream& jplace_stream,
+                                const int num_threads,
+                                std::ostream& out_stream) {
+  assert(placeQueriesPtr);
+  (this->*placeQueriesPtr)(jplace_stream, num_threads, out_stream);
+}
+
+void cmaple::Tree::removeSamples(const std::vector<std::string>& names) {
+  assert(removeSamplesPtr);
+  (this->*removeSamplesPtr)(names);
+}
+
+template <const StateType num_states>
+void cmaple::Tree::removeSamplesTemplate(
+    const std::vector<std::string>& names) {
+  // make sure the tree is not empty
+  if (nodes.size() < 3) {
+    throw std::logic_error("The tree is empty. Please build the tree first!");
+  }
+
+  // index the names of the samples to remove
+  std::unordered_set<std::string_view> removing(names.begin(), names.end());
+
+  // locate the samples in a single pass through the leaves
+  std::unordered_set<std::string_view> found;
+  std::vector<NumSeqsType> leaf_vec_indexes;
+  NumSeqsType num_detached_leaves = 0;
+  const std::vector<NumSeqsType> tree_leaf_vec_indexes = collectLeafVecIndexes();
+  for (const NumSeqsType vec_index : tree_leaf_vec_indexes) {
+    PhyloNode& node = nodes[vec_index];
+    const std::string& leaf_name = seq_names[node.getSeqNameIndex()];
+    const bool remove_leaf = removing.count(leaf_name) > 0;
+    if (remove_leaf) {
+      found.insert(leaf_name);
+    }
+    std::vector<NumSeqsType>::size_type num_removed_less_info_seqs = 0;
+    for (const NumSeqsType seq_index : node.getLessInfoSeqs()) {
+      if (removing.count(seq_names[seq_index])) {
+        found.insert(seq_names[seq_index]);
+        ++num_removed_less_info_seqs;
+      }
+    }
+    if (remove_leaf || num_removed_less_info_seqs) {
+      leaf_vec_indexes.push_back(vec_index);
+      num_detached_leaves +=
+          remove_leaf &&
+          num_removed_less_info_seqs == node.getLessInfoSeqs().size();
+    }
+  }
+
+  // validate the request before changing the tree
+  for (const std::string_view name : removing) {
+    if (!found.count(name)) {
+      throw std::invalid_argument("Sequence " + std::string(name) +
+                                  " not found in the tree");
+    }
+  }
+  if (tree_leaf_vec_indexes.size() - num_detached_leaves < 2) {
+    throw std::invalid_argument(
+        "Cannot remove the samples: fewer than two samples would remain in "
+        "the tree");
+  }
+
+  const PositionType seq_length =
+      static_cast<PositionType>(aln->ref_seq.size());
+  for (const NumSeqsType leaf_vec_index : leaf_vec_indexes) {
+    PhyloNode& leaf = nodes[leaf_vec_index];
+
+    // drop the removed less-info sequences
+    std::vector<NumSeqsType>& less_info_seqs = leaf.getLessInfoSeqs();
+    less_info_seqs.erase(
+        std::remove_if(less_info_seqs.begin(), less_info_seqs.end(),
+                       [this, &removing](const NumSeqsType seq_index) {
+                         if (!removing.count(seq_names[seq_index])) {
+                           return false;
+                         }
+                         sequence_added[seq_index] = false;
+                         sequence_removed[seq_index] = true;
+                         return true;
+                       }),
+        less_info_seqs.end());
+
+    if (!removing.count(seq_names[leaf.getSeqNameIndex()])) {
+      continue;
+    }
+    sequence_added[leaf.getSeqNameIndex()] = false;
+    sequence_removed[leaf.getSeqNameIndex()] = true;
+
+    // the most informative less-info sequence takes the place of the removed
+    // sample
+    if (!less_info_seqs.empty()) {
+      std::vector<std::unique_ptr<SeqRegions>> less_info_regions;
+      std::vector<NumSeqsType>::size_type best = 0;
+      for (std::vector<NumSeqsType>::size_type i = 0;
+           i < less_info_seqs.size(); ++i) {
+        less_info_regions.push_back(
+            aln->data[less_info_seqs[i]].getLowerLhVector(
+                seq_length, num_states, aln->getSeqType()));
+        if (i && less_info_regions[best]->compareWithSample(
+                     *less_info_regions[i], seq_length, aln) == -1) {
+          best = i;
+        }
+      }
+      const NumSeqsType seq_index = less_info_seqs[best];
+      std::unique_ptr<SeqRegions> best_regions =
+          std::move(less_info_regions[best]);
+
+      // the other sequences stay with the leaf only if they are less
+      // informative than the promoted one; the rest are placed again by the
+      // next doPlacement()
+      std::vector<NumSeqsType>::size_type num_kept = 0;
+      for (std::vector<NumSeqsType>::size_type i = 0;
+           i < less_info_seqs.size(); ++i) {
+        if (i == best) {
+          continue;
+        }
+        if (best_regions->compareWithSample(*less_info_regions[i], seq_length,
+                                            aln) == 1) {
+          less_info_seqs[num_kept++] = less_info_seqs[i];
+        } else {
+          sequence_added[less_info_seqs[i]] = false;
+        }
+      }
+      less_info_seqs.resize(num_kept);
+
+      indexLeafMutations(leaf_vec_index, false);
+      leaf.setSeqNameIndex(seq_index);
+      indexLeafMutations(leaf_vec_index, true);
+      leaf.setPartialLh(TOP, std::move(best_regions));
+
+      // update the likelihoods at the leaf and above it
+      stack<Index> node_stack;
+      node_stack.push(Index(leaf_vec_index, TOP));
+      node_stack.push(leaf.getNeighborIndex(TOP));
+      updatePartialLh<num_states>(node_stack);
+      continue;
+    }
+
+    // otherwise, detach the leaf then free it and its parent node
+    const NumSeqsType parent_vec_index =
+        leaf.getNeighborIndex(TOP).getVectorIndex();
+    pruneSubTree<num_states>(leaf);
+    indexLeafMutations(leaf_vec_index, false);
+    freeNode(parent_vec_index);
+    freeNode(leaf_vec_index);
+  }
+}
+
+auto cmaple::Tree::collectLeafVecIndexes() -> std::vector<NumSeqsType> {
+  std::vector<NumSeqsType> leaf_vec_indexes;
+  if (!nodes.size()) {
+    return leaf_vec_indexes;
+  }
+
+  // traverse the tree from the root
+  std::stack<NumSeqsType> node_stack;
+  node_stack.push(root_vector_index);
+  while (!node_stack.empty()) {
+    const PhyloNode& node = nodes[node_stack.top()];
+    if (node.isInternal()) {
+      node_stack.pop();
+      node_stack.push(node.getNeighborIndex(RIGHT).getVectorIndex());
+      node_stack.push(node.getNeighborIndex(LEFT).getVectorIndex());
+    } else {
+      leaf_vec_indexes.push_back(node_stack.top());
+      node_stack.pop();
+    }
+  }
+  return leaf_vec_indexes;
+}
+
+void cmaple::Tree::freeNode(const NumSeqsType vec_index) {
+  PhyloNode& node = nodes[vec_index];
+  // release the likelihoods and detach the node
+  if (node.isInternal()) {
+    node.setNode(InternalNode());
+    free_internal_vec_indexes.push_back(vec_index);
+  } else {
+    node.setNode(LeafNode(0));
+    free_leaf_vec_indexes.push_back(vec_index);
+  }
+  node.setTotalLh(nullptr);
+  node.setMidBranchLh(nullptr);
+  node.setOutdated(true);
+  node.setSPRCount(0);
+  node.setUpperLength(0);
+}
+
+void cmaple::Tree::initFreeNodes() {
+  free_internal_vec_indexes.clear();
+  free_leaf_vec_indexes.clear();
+  for (NumSeqsType vec_index = 0; vec_index < nodes.size(); ++vec_index) {
+    if (isFreeNode(vec_index)) {
+      if (nodes[vec_index].isInternal())
+        free_internal_vec_indexes.push_back(vec_index);
+      else
+        free_leaf_vec_indexes.push_back(vec_index);
+    }
+  }
+}
+
+void cmaple::Tree::buildMutationIndex() {
+  assert(aln);
+  const std::size_t num_mutations = aln->ref_seq.size() * aln->num_states;
+  mutation_leaves.clear();
+  mutation_leaves.resize(num_mutations);
+  mutation_counts.assign(num_mutations, 0);
+
+  for (const NumSeqsType vec_index : collectLeafVecIndexes()) {
+    indexLeafMutations(vec_index, true);
+  }
+}
+
+void cmaple::Tree::indexLeafMutations(const NumSeqsType vec_index,
+                                      const bool add) {
+  // do nothing if the index is not built
+  if (mutation_leaves.empty()) {
+    return;
+  }
+
+  const StateType num_states = aln->num_states;
+  const NumSeqsType rare_mutation_limit = params->seed_rare_mutation_limit;
+  for (const Mutation& mutation :
+       aln->data[nodes[vec_index].getSeqNameIndex()]) {
+    // only index mutations to a specific state
+    if (mutation.type >= num_states) {
+      continue;
+    }
+
+    const std::size_t key =
+        static_cast<std::size_t>(mutation.position) * num_states +
+        mutation.type;
+    std::vector<NumSeqsType>& leaves = mutation_leaves[key];
+    NumSeqsType& count = mutation_counts[key];
+
+    // the list of leaves is only complete (and kept) while the mutation is
+    // rare
+    if (add) {
+      if (leaves.size() == count && count < rare_mutation_limit) {
+        leaves.push_back(vec_index);
+      } else if (!leaves.empty()) {
+        std::vector<NumSeqsType>().swap(leaves);
+      }
+      ++count;
+    } else {
+      assert(count > 0);
+      --count;
+      const std::vector<NumSeqsType>::iterator it =
+          std::find(leaves.begin(), leaves.end(), vec_index);
+      if (it != leaves.end()) {
+        *it = leaves.back();
+        leaves.pop_back();
+      }
+    }
+  }
+}
+
+void cmaple::Tree::buildMutationMasks() {
+  mutation_masks.assign(nodes.size(), {});
+  if (nodes.empty()) {
+    return;
+  }
+
+  for (const NumSeqsType vec_index : collectLeafVecIndexes()) {
+    updateMutationMasks(vec_index);
+  }
+}
+
+void cmaple::Tree::updateMutationMasks(const NumSeqsType vec_index) {
+  if (mutation_masks.size() < nodes.size()) {
+    mutation_masks.resize(nodes.size());
+  }
+
+  // the less informative sequences of a leaf carry no other mutations
+  const StateType num_states = aln->num_states;
+  const PositionType block_size = getMissingDataBlockSize(
+      static_cast<PositionType>(aln->ref_seq.size()));
+  std::array<std::uint64_t, 8>& leaf_mask = mutation_masks[vec_index];
+  leaf_mask = {};
+  for (const Mutation& mutation :
+       aln->data[nodes[vec_index].getSeqNameIndex()]) {
+    if (mutation.type < num_states) {
+      const std::uint16_t bit = getMutationMaskBit(mutation, num_states);
+      leaf_mask[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+    }
+    // missing or ambiguous data: mark the blocks it covers
+    else {
+      const PositionType last_block =
+          (mutation.position + mutation.getLength() - 1) / block_size;
+      for (PositionType block = mutation.position / block_size;
+           block <= last_block; ++block) {
+        leaf_mask[4 + (block >> 6)] |= std::uint64_t(1) << (block & 63);
+      }
+    }
+  }
+
+  // merge the masks of the children of the ancestors until nothing changes
+  for (NumSeqsType node_vec_index = vec_index;
+       node_vec_index != root_vector_index;) {
+    node_vec_index =
+        nodes[node_vec_index].getNeighborIndex(TOP).getVectorIndex();
+    const PhyloNode& node = nodes[node_vec_index];
+    const std::array<std::uint64_t, 8>& left_mask =
+        mutation_masks[node.getNeighborIndex(LEFT).getVectorIndex()];
+    const std::array<std::uint64_t, 8>& right_mask =
+        mutation_masks[node.getNeighborIndex(RIGHT).getVectorIndex()];
+    std::array<std::uint64_t, 8>& mask = mutation_masks[node_vec_index];
+    bool changed = false;
+    for (std::size_t i = 0; i < mask.size(); ++i) {
+      const std::uint64_t merged_mask = mask[i] | left_mask[i] | right_mask[i];
+      changed |= merged_mask != mask[i];
+      mask[i] = merged_mask;
+    }
+    if (!changed) {
+      break;
+    }
+  }
+}
+
+auto cmaple::Tree::getMutationMaskBits(const NumSeqsType seq_name_index) const
+    -> std::vector<SampleMutationBits> {
+  const StateType num_states = aln->num_states;
+  const PositionType block_size = getMissingDataBlockSize(
+      static_cast<PositionType>(aln->ref_seq.size()));
+  std::vector<SampleMutationBits> bits;
+  for (const Mutation& mutation : aln->data[seq_name_index]) {
+    if (mutation.type < num_states) {
+      bits.push_back(SampleMutationBits{
+          mutation.position, mutation.type,
+          getMutationMaskBit(mutation, num_states),
+          static_cast<std::uint16_t>(256 + mutation.position / block_size)});
+    }
+  }
+  return bits;
+}
+
+auto cmaple::Tree::computeAbsentMutationBound() const -> RealNumType {
+  // at a placement, a mutation (of the sample) to a state that the leaves
+  // below all lack (with no missing data at its position) is explained by a
+  // substitution on the new branch or on the branch next to it, each not longer
+  // than max_blength. In calculateSamplePlacementCost(), the probability of
+  // such a substitution from state i to state j is at most
+  // (mutation_mat[i][j] + freqi_freqj_qij[j][i]) times the total length of
+  // those branches (see calculateSampleCost_R_ACGT())
+  const StateType num_states = aln->num_states;
+  RealNumType max_rate = 0;
+  for (StateType i = 0; i < num_states; ++i) {
+    for (StateType j = 0; j < num_states; ++j) {
+      if (i != j) {
+        max_rate = std::max(
+            max_rate, model->mutation_mat[model->row_index[i] + j] +
+                          model->freqi_freqj_qij[model->row_index[j] + i]);
+      }
+    }
+  }
+  return log(max_rate * (max_blength + max_blength));
+}
+
+auto cmaple::Tree::boundSamplePlacementCost(
+    const NumSeqsType vec_index,
+    const std::vector<SampleMutationBits>& sample_mask_bits,
+    const RealNumType absent_mutation_bound) -> RealNumType {
+  // the upper likelihood of the root is unknown
+  if (vec_index == root_vector_index) {
+    return 0;
+  }
+
+  const std::array<std::uint64_t, 8>& mask = mutation_masks[vec_index];
+  const SeqRegions& upper_regions =
+      *getPartialLhAtNode(nodes[vec_index].getNeighborIndex(TOP));
+  const StateType num_states = aln->num_states;
+  NumSeqsType num_absent_mutations = 0;
+  for (const SampleMutationBits& bits : sample_mask_bits) {
+    if (((mask[bits.mutation_bit >> 6] >> (bits.mutation_bit & 63)) & 1) ||
+        ((mask[bits.missing_data_bit >> 6] >> (bits.missing_data_bit & 63)) &
+         1)) {
+      continue;
+    }
+
+    // the region of the upper likelihood covering the mutation
+    const SeqRegion& upper_region = *std::lower_bound(
+        upper_regions.begin(), upper_regions.end(), bits.position,
+        [](const SeqRegion& region, const PositionType position) {
+          return region.position < position;
+        });
+    const StateType upper_state =
+        upper_region.type == TYPE_R
+            ? aln->ref_seq[static_cast<std::vector<StateType>::size_type>(
+                  bits.position)]
+            : upper_region.type;
+    num_absent_mutations += upper_state < num_states && upper_state != bits.state;
+  }
+  return num_absent_mutations * absent_mutation_bound;
+}
+
+auto cmaple::Tree::findRelatedLeaves(const NumSeqsType seq_name_index)
+    -> std::vector<NumSeqsType> {
+  // count the rare mutations each leaf shares with the sample
+  const StateType num_states = aln->num_states;
+  std::unordered_map<NumSeqsType, NumSeqsType> num_shared_mutations;
+  for (const Mutation& mutation : aln->data[seq_name_index]) {
+    if (mutation.type >= num_states) {
+      continue;
+    }
+
+    const std::size_t key =
+        static_cast<std::size_t>(mutation.position) * num_states +
+        mutation.type;
+    const std::vector<NumSeqsType>& leaves = mutation_leaves[key];
+    if (leaves.size() == mutation_counts[key]) {
+      for (const NumSeqsType vec_index : leaves) {
+        ++num_shared_mutations[vec_index];
+      }
+    }
+  }
+
+  // select the leaves sharing the most rare mutations
+  NumSeqsType best_num_shared_mutations = 0;
+  for (const auto& [vec_index, num_shared] : num_shared_mutations) {
+    best_num_shared_mutations = std::max(best_num_shared_mutations, num_shared);
+  }
+  std::vector<NumSeqsType> related_leaves;
+  for (const auto& [vec_index, num_shared] : num_shared_mutations) {
+    if (num_shared == best_num_shared_mutations) {
+      related_leaves.push_back(vec_index);
+    }
+  }
+  return related_leaves;
+}
+
+auto cmaple::Tree::liftPlacementStart(NumSeqsType vec_index,
+                                      const int num_levels) -> NumSeqsType {
+  // the start node must not be inside a polytomy (i.e., with a zero-length
+  // branch above it), where no placements are examined
+  for (int i = 0; vec_index != root_vector_index &&
+                  (i < num_levels || nodes[vec_index].getUpperLength() <= 0);
+       ++i) {
+    vec_index = nodes[vec_index].getNeighborIndex(TOP).getVectorIndex();
+  }
+  return vec_index;
+}
+
+auto cmaple::Tree::seekPlacementStart(const NumSeqsType seq_name_index)
+    -> Index {
+  const std::vector<NumSeqsType> related_leaves =
+      findRelatedLeaves(seq_name_index);
+  if (related_leaves.empty()) {
+    return Index(root_vector_index, TOP);
+  }
+
+  // find their most recent common ancestor: mark the path from one of them to
+  // the root, then climb from the others until reaching that path
+  std::unordered_map<NumSeqsType, NumSeqsType> path_depths;
+  NumSeqsType best_vec_index = related_leaves.front();
+  for (NumSeqsType node_vec_index = best_vec_index, depth = 0;; ++depth) {
+    path_depths.emplace(node_vec_index, depth);
+    if (node_vec_index == root_vector_index) {
+      break;
+    }
+    node_vec_index =
+        nodes[node_vec_index].getNeighborIndex(TOP).getVectorIndex();
+  }
+  NumSeqsType lca_depth = 0;
+  for (NumSeqsType node_vec_index : related_leaves) {
+    std::unordered_map<NumSeqsType, NumSeqsType>::const_iterator it;
+    while ((it = path_depths.find(node_vec_index)) == path_depths.end()) {
+      node_vec_index =
+          nodes[node_vec_index].getNeighborIndex(TOP).getVectorIndex();
+    }
+    if (it->second > lca_depth) {
+      lca_depth = it->second;
+      best_vec_index = node_vec_index;
+    }
+  }
+
+  // start a few levels above that ancestor, so that the local search also
+  // covers its close relatives
+  return Index(liftPlacementStart(best_vec_index, params->failure_limit_sample),
+               TOP);
+}
+
+auto cmaple::Tree::seekParsimonyPlacementStart(
+    const NumSeqsType seq_name_index) -> Index {
+  // select the related leaf closest to the sample in parsimony (the first one
+  // in the vector of nodes if tied)
+  const Sequence& sequence = aln->data[seq_name_index];
+  const StateType num_states = aln->num_states;
+  NumSeqsType best_vec_index = 0;
+  PositionType best_distance = std::numeric_limits<PositionType>::max();
+  for (const NumSeqsType vec_index : findRelatedLeaves(seq_name_index)) {
+    const PositionType distance = computeParsimonyDistance(
+        sequence, aln->data[nodes[vec_index].getSeqNameIndex()], num_states);
+    if (distance < best_distance ||
+        (distance == best_distance && vec_index < best_vec_index)) {
+      best_distance = distance;
+      best_vec_index = vec_index;
+    }
+  }
+  if (best_distance == std::numeric_limits<PositionType>::max()) {
+    return Index();
+  }
+
+  return Index(liftPlacementStart(best_vec_index,
+                                  params->parsimony_placement_radius),
+               TOP);
+}
+
+auto cmaple::Tree::selectPlacementStart(const NumSeqsType seq_name_index,
+                                        int& max_depth) -> Index {
+  max_depth = -1;
+  if (params->parsimony_placement_radius >= 0) {
+    const Index start_index = seekParsimonyPlacementStart(seq_name_index);
+    if (start_index.getMiniIndex() != UNDEFINED) {
+      // only search the neighbourhood of the most parsimonious leaf
+      max_depth = params->parsimony_placement_radius +
+                  params->parsimony_placement_radius;
+      return start_index;
+    }
+  } else if (params->seed_placement) {
+    return seekPlacementStart(seq_name_index);
+  }
+  return Index(root_vector_index, TOP);
+}
+
+auto cmaple::Tree::computePlacementOrder() -> std::vector<NumSeqsType> {
+  // by default, follow the alignment (sorted by the distances to the reference)
+  const NumSeqsType num_seqs = static_cast<NumSeqsType>(aln->data.size());
+  std::vector<NumSeqsType> placement_order(num_seqs);
+  std::iota(placement_order.begin(), placement_order.end(), 0);
+  if (!params->cluster_placement_order) {
+    return placement_order;
+  }
+
+  // group the samples by the MinHash of their mutations (to a specific state)
+  std::unordered_map<std::uint64_t, std::vector<NumSeqsType>> groups;
+  std::vector<std::uint64_t> group_keys;
+  for (NumSeqsType i = 0; i < num_seqs; ++i) {
+    const std::uint64_t min_hash = computeMutationMinHash(i);
+    std::vector<NumSeqsType>& group = groups[min_hash];
+    if (group.empty()) {
+      group_keys.push_back(min_hash);
+    }
+    group.push_back(i);
+  }
+
+  if (cmaple::verbose_mode >= cmaple::VB_MED) {
+    std::cout << "Grouped " << num_seqs << " samples into " << group_keys.size()
+              << " groups of similar samples" << std::endl;
+  }
+
+  // place each group at once when reaching its sample closest to the reference
+  // (the first sample stays first)
+  placement_order.clear();
+  for (const std::uint64_t key : group_keys) {
+    const std::vector<NumSeqsType>& group = groups[key];
+    placement_order.insert(placement_order.end(), group.begin(), group.end());
+  }
+  return placement_order;
+}
+
+auto cmaple::Tree::computeMutationMinHash(
+    const NumSeqsType seq_name_index) const -> std::uint64_t {
+  const StateType num_states = aln->num_states;
+  std::uint64_t min_hash = std::numeric_limits<std::uint64_t>::max();
+  for (const Mutation& mutation : aln->data[seq_name_index]) {
+    if (mutation.type >= num_states) {
+      continue;
+    }
+
+    // the finalizer of SplitMix64
+    std::uint64_t hash =
+        static_cast<std::uint64_t>(mutation.position) * num_states +
+        mutation.type;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    min_hash = std::min(min_hash, hash);
+  }
+  return min_hash;
+}
+
+void cmaple::Tree::exportPlacements(const std::vector<std::string>& names,
+                                    std::ostream& out_stream) {
+  // index the requested names
+  std::unordered_map<std::string_view, std::vector<std::string>::size_type>
+      requested;
+  requested.reserve(names.size());
+  for (std::vector<std::string>::size_type i = 0; i < names.size(); ++i)
+    requested.emplace(names[i], i);
+
+  // locate the requested sequences in a single pass through the leaves
+  std::vector<Index> leaves(names.size());
+  std::vector<bool> less_info(names.size(), false);
+  std::vector<bool> found(names.size(), false);
+  for (const NumSeqsType vec_index : collectLeafVecIndexes()) {
+    PhyloNode& node = nodes[vec_index];
+    auto it = requested.find(seq_names[node.getSeqNameIndex()]);
+    if (it != requested.end()) {
+      leaves[it->second] = Index(vec_index, TOP);
+      found[it->second] = true;
+    }
+    for (const NumSeqsType seq_index : node.getLessInfoSeqs()) {
+      it = requested.find(seq_names[seq_index]);
+      if (it != requested.end()) {
+        leaves[it->second] = Index(vec_index, TOP);
+        less_info[it->second] = true;
+        found[it->second] = true;
+      }
+    }
+  }
+
+  for (std::vector<std::string>::size_type i = 0; i < names.size(); ++i) {
+    out_stream << names[i];
+    if (!found[i]) {
+      out_stream << "\tNA\n";
+      continue;
+    }
+
+    const PhyloNode& leaf = nodes[leaves[i].getVectorIndex()];
+    // a less-informative sequence is represented by its leaf
+    if (less_info[i]) {
+      out_stream << "\t0\t" << seq_names[leaf.getSeqNameIndex()] << "\t0\n";
+      continue;
+    }
+
+    // the tree consists of this sample only
+    if (leaves[i].getVectorIndex() == root_vector_index) {
+      out_stream << "\t0\tNA\tNA\n";
+      continue;
+    }
+
+    // descend the sibling clade along the shortest branches
+    // (non-positive lengths denote zero-length branches)
+    const auto length = [](const PhyloNode& node) -> RealNumType {
+      return node.getUpperLength() > 0 ? node.getUpperLength() : 0;
+    };
+    const Index parent_index = leaf.getNeighborIndex(TOP);
+    Index node_index = nodes[parent_index.getVectorIndex()].getNeighborIndex(
+        parent_index.getFlipMiniIndex());
+    RealNumType distance = length(leaf);
+    while (nodes[node_index.getVectorIndex()].isInternal()) {
+      const PhyloNode& node = nodes[node_index.getVectorIndex()];
+      distance += length(node);
+      const Index left_index = node.getNeighborIndex(LEFT);
+      const Index right_index = node.getNeighborIndex(RIGHT);
+      node_index = length(nodes[right_index.getVectorIndex()]) <
+                           length(nodes[left_index.getVectorIndex()])
+                       ? right_index
+                       : left_index;
+    }
+    const PhyloNode& close_sample = nodes[node_index.getVectorIndex()];
+    distance += length(close_sample);
+
+    out_stream << "\t" << length(leaf) << "\t"
+               << seq_names[close_sample.getSeqNameIndex()] << "\t" << distance
+               << "\n";
+  }
 }
 
 template <const StateType num_states>
@@ -1166,63 +2746,325 @@ void cmaple::Tree::computeBranchSupportTemplate(
   cout.rdbuf(src_cout);
 }
 
-std::string cmaple::Tree::exportNodeString(const bool binary,
-                                           const NumSeqsType node_vec_index,
-                                           const bool show_branch_supports) {
-  PhyloNode& node = nodes[node_vec_index];
-  string output = "(";
+namespace {
+/**
+ Append a string to a JSON string literal, escaping special characters
+ */
+void appendJsonString(std::string& output, const std::string_view str) {
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        output += "\\\"";
+        break;
+      case '\\':
+        output += "\\\\";
+        break;
+      case '\n':
+        output += "\\n";
+        break;
+      case '\t':
+        output += "\\t";
+        break;
+      default:
+        output += c;
+    }
+  }
+}
+}  // namespace
+
+template <const StateType num_states>
+void cmaple::Tree::placeQueriesTemplate(std::ostream& jplace_stream,
+                                        const int num_threads,
+                                        std::ostream& out_stream) {
+  // Make sure the tree is not empty
+  if (nodes.size() < 3) {
+    throw std::logic_error(
+        "Tree is empty. Please build/infer a tree from the alignment first!");
+  }
 
-  // if it's a leaf
-  if (!node.isInternal()) {
-    return node.exportString(binary, seq_names, show_branch_supports);
-    // if it's an internal node
-  } else {
-    /*bool add_comma = false;
-     for (Index neighbor_index:node.getNeighborIndexes(TOP))
-     {
-     if (!add_comma)
-     add_comma = true;
-     else
-     output += ",";
-     output += exportNodeString(binary, neighbor_index.getVectorIndex());
-     }*/
-    output +=
-        exportNodeString(binary, node.getNeighborIndex(RIGHT).getVectorIndex(),
-                         show_branch_supports);
-    output += ",";
-    output +=
-        exportNodeString(binary, node.getNeighborIndex(LEFT).getVectorIndex(),
-                         show_branch_supports);
-  }
-
-  string branch_support = "";
-  if (show_branch_supports) {
-    // Make sure Branch supports have been computed
-    if (!node.getNodelhIndex()) {
-      throw std::logic_error(
-          "Branch supports is not available. Please compute them first!");
+  // set num_threads
+  if (num_threads < 0) {
+    throw std::invalid_argument("Number of threads must be non-negative!");
+  }
+  setNumThreads(num_threads);
+
+  // Redirect the original src_cout to the target_cout
+  streambuf* src_cout = cout.rdbuf();
+  cout.rdbuf(out_stream.rdbuf());
+
+  // record the start time
+  auto start = getRealTime();
+
+  // compute the likelihood of the tree, which also makes sure all likelihoods
+  // are up-to-date regarding the current alignment and model parameters
+  const RealNumType tree_lh = computeLh();
+  registerNewSeqs();
+
+  // collect the queries (the sequences removed from the tree are not queries)
+  std::vector<NumSeqsType> queries;
+  for (std::vector<Sequence>::size_type i = 0; i < aln->data.size(); ++i) {
+    if (!sequence_added[i] && !sequence_removed[i]) {
+      queries.push_back(static_cast<NumSeqsType>(i));
+    }
+  }
+  const NumSeqsType num_queries = static_cast<NumSeqsType>(queries.size());
+
+  // index the mutations of the leaves to seed the placement search
+  if ((params->seed_placement || params->parsimony_placement_radius >= 0) &&
+      mutation_leaves.empty()) {
+    buildMutationIndex();
+  }
+  if (params->bound_placement) {
+    buildMutationMasks();
+  }
+
+  if (cmaple::verbose_mode >= cmaple::VB_MED) {
+    std::cout << "Placing " << num_queries << " queries onto the tree"
+              << std::endl;
+  }
+
+  // the best placement of each query: the node above which the query is
+  // attached, the distal & pendant lengths, and the lh difference
+  struct QueryPlacement {
+    NumSeqsType node_vec_index = 0;
+    RealNumType distal_length = 0;
+    RealNumType pendant_length = 0;
+    RealNumType lh_diff = 0;
+  };
+  std::vector<QueryPlacement> query_placements(num_queries);
+
+  // place the queries independently of each other; the tree is only read
+  const PositionType seq_length = static_cast<PositionType>(aln->ref_seq.size());
+  std::exception_ptr exception = nullptr;
+#pragma omp parallel for schedule(dynamic)
+  for (NumSeqsType j = 0; j < num_queries; ++j) {
+    try {
+      const NumSeqsType seq_name_index = queries[j];
+      std::unique_ptr<SeqRegions> lower_regions =
+          aln->data[seq_name_index].getLowerLhVector(seq_length, num_states,
+                                                     aln->getSeqType());
+
+      // seek a position for the query
+      Index selected_node_index;
+      RealNumType best_lh_diff = MIN_NEGATIVE;
+      bool is_mid_branch = false;
+      RealNumType best_up_lh_diff = MIN_NEGATIVE;
+      RealNumType best_down_lh_diff = MIN_NEGATIVE;
+      Index best_child_index;
+      int max_depth;
+      const Index start_index = selectPlacementStart(seq_name_index, max_depth);
+      seekSamplePlacement<num_states>(
+          start_index, seq_name_index, lower_regions, selected_node_index,
+          best_lh_diff, is_mid_branch, best_up_lh_diff, best_down_lh_diff,
+          best_child_index, max_depth);
+
+      QueryPlacement& query_placement = query_placements[j];
+      query_placement.node_vec_index = selected_node_index.getVectorIndex();
+
+      // the query is less informative than an existing leaf -> it's placed
+      // at that leaf with a zero-length branch
+      if (selected_node_index.getMiniIndex() == UNDEFINED) {
+        continue;
+      }
+
+      // compute the split and the branch lengths
+      SamplePlacement placement;
+      if (is_mid_branch) {
+        computePlacementMidBranch<num_states>(placement, selected_node_index,
+                                              lower_regions, best_lh_diff,
+                                              true);
+      } else {
+        computePlacementAtNode<num_states>(
+            placement, selected_node_index, lower_regions, best_lh_diff,
+            best_up_lh_diff, best_down_lh_diff, best_child_index, true);
+      }
+      query_placement.node_vec_index = placement.sibling_index.getVectorIndex();
+      query_placement.distal_length = std::max(placement.down_distance, 0.0);
+      query_placement.pendant_length = std::max(placement.blength, 0.0);
+      query_placement.lh_diff = placement.lh_diff;
+    } catch (...) {
+#pragma omp critical
+      if (!exception) {
+        exception = std::current_exception();
+      }
     }
+  }
+  if (exception) {
+    cout.rdbuf(src_cout);
+    std::rethrow_exception(exception);
+  }
+
+  // write the tree with the edge numbers
+  std::vector<NumSeqsType> edge_nums;
+  std::ostringstream tree_stream;
+  writeNewick(tree_stream, false, false, &edge_nums);
+  std::string output = "{\n  \"tree\": \"";
+  appendJsonString(output, tree_stream.str());
+  output += "\",\n  \"placements\": [";
+
+  // write the placements
+  for (NumSeqsType j = 0; j < num_queries; ++j) {
+    const QueryPlacement& query_placement = query_placements[j];
+    output += j ? ",\n    " : "\n    ";
+    output += "{\"p\": [[";
+    output += std::to_string(edge_nums[query_placement.node_vec_index]);
+    output += ", ";
+    appendDoubleToString(output, tree_lh + query_placement.lh_diff, 12);
+    output += ", 1, ";
+    appendDoubleToString(output, query_placement.distal_length, 12);
+    output += ", ";
+    appendDoubleToString(output, query_placement.pendant_length, 12);
+    output += ", ";
+    appendDoubleToString(output, query_placement.lh_diff, 12);
+    output += "]], \"n\": [\"";
+    appendJsonString(output, seq_names[queries[j]]);
+    output += "\"]}";
+  }
+  output += num_queries ? "\n  ],\n" : "],\n";
+  output += "  \"metadata\": {\"invocation\": \"CMAPLE placement of queries "
+            "onto a fixed tree\"},\n"
+            "  \"version\": 3,\n"
+            "  \"fields\": [\"edge_num\", \"likelihood\", "
+            "\"like_weight_ratio\", \"distal_length\", \"pendant_length\", "
+            "\"lh_diff\"]\n}\n";
+  jplace_stream << output;
+
+  if (cmaple::verbose_mode > cmaple::VB_QUIET) {
+    std::cout << num_queries << " queries have been placed onto the tree."
+              << std::endl;
+  }
 
-    branch_support =
-        convertDoubleToString(node_lhs[node.getNodelhIndex()].get_aLRT_SH());
+  // show the runtime for placing the queries
+  auto end = getRealTime();
+  if (cmaple::verbose_mode >= cmaple::VB_MAX) {
+    cout << " - Time spent on placing queries: " << std::setprecision(3)
+         << end - start << endl;
   }
-  string length = node.getUpperLength() <= 0
-                      ? "0"
-                      : convertDoubleToString(node.getUpperLength(), 12);
-  output += ")" + branch_support + ":" + length;
 
-  return output;
+  // Restore the source cout
+  cout.rdbuf(src_cout);
 }
 
-std::string cmaple::Tree::exportNewick(const bool binary,
-                                       const bool show_branch_supports) {
+void cmaple::Tree::writeNewick(std::ostream& out_stream,
+                               const bool binary,
+                               const bool show_branch_supports,
+                               std::vector<NumSeqsType>* edge_nums) {
   // make sure tree is not empty
   if (nodes.size() < 3) {
-    return "";
+    return;
+  }
+
+  // the output is buffered and written to the stream in blocks
+  const std::string::size_type BLOCK_SIZE = 1 << 20;
+  std::string output;
+  output.reserve(BLOCK_SIZE + 1024);
+
+  // label a branch by the next edge number (if needed)
+  NumSeqsType edge_num = 0;
+  auto append_edge_num = [&output, &edge_num]() {
+    output += '{';
+    output += std::to_string(edge_num);
+    output += '}';
+    return edge_num++;
+  };
+  if (edge_nums) {
+    edge_nums->assign(nodes.size(), 0);
+  }
+
+  // traverse the tree in the order: node, right subtree, left subtree, without
+  // any stack: when returning from a child, the mini-index of its parent tells
+  // us whether it's the right (then go to the left child) or the left child
+  NumSeqsType node_vec_index = root_vector_index;
+  bool going_down = true;
+  while (true) {
+    PhyloNode& node = nodes[node_vec_index];
+
+    // entering an internal node -> move down to its right child
+    if (going_down && node.isInternal()) {
+      output += '(';
+      node_vec_index = node.getNeighborIndex(RIGHT).getVectorIndex();
+      continue;
+    }
+
+    // a leaf -> export its name (and its less-info-seqs)
+    if (!node.isInternal()) {
+      if (!edge_nums) {
+        node.exportString(output, binary, seq_names, show_branch_supports);
+      } else {
+        const std::vector<NumSeqsType>& less_info_seqs =
+            node.getLessInfoSeqs();
+        if (less_info_seqs.empty()) {
+          output += seq_names[node.getSeqNameIndex()];
+        } else {
+          output += '(';
+          output += seq_names[node.getSeqNameIndex()];
+          output += ":0";
+          append_edge_num();
+          for (const NumSeqsType minor_seq_name_index : less_info_seqs) {
+            output += ',';
+            output += seq_names[minor_seq_name_index];
+            output += ":0";
+            append_edge_num();
+          }
+          output += ')';
+        }
+      }
+    }
+    // leaving an internal node (after its two subtrees)
+    else {
+      output += ')';
+      if (show_branch_supports) {
+        // Make sure Branch supports have been computed
+        if (!node.getNodelhIndex()) {
+          throw std::logic_error(
+              "Branch supports is not available. Please compute them first!");
+        }
+
+        appendDoubleToString(output,
+                             node_lhs[node.getNodelhIndex()].get_aLRT_SH());
+      }
+    }
+
+    // the branch above the node (which was already exported for a leaf
+    // without edge numbers)
+    if (node.isInternal() || edge_nums) {
+      output += ':';
+      if (node.getUpperLength() <= 0) {
+        output += '0';
+      } else {
+        appendDoubleToString(output, node.getUpperLength(), 12);
+      }
+      if (edge_nums) {
+        (*edge_nums)[node_vec_index] = append_edge_num();
+      }
+    }
+
+    // flush the output if the block is full
+    if (output.size() >= BLOCK_SIZE) {
+      out_stream.write(output.data(),
+                       static_cast<std::streamsize>(output.size()));
+      output.clear();
+    }
+
+    // stop at the root
+    if (node_vec_index == root_vector_index) {
+      break;
+    }
+
+    // move back to the parent: right child -> move to the left sibling
+    const Index parent_index = node.getNeighborIndex(TOP);
+    node_vec_index = parent_index.getVectorIndex();
+    if (parent_index.getMiniIndex() == RIGHT) {
+      output += ',';
+      node_vec_index = nodes[node_vec_index].getNeighborIndex(LEFT).getVectorIndex();
+      going_down = true;
+    } else {
+      going_down = false;
+    }
   }
 
-  return exportNodeString(binary, root_vector_index, show_branch_supports) +
-         ";";
+  output += ';';
+  out_stream.write(output.data(), static_cast<std::streamsize>(output.size()));
 }
 
 template <const StateType num_states>
@@ -2769,15 +4611,7 @@ void cmaple::Tree::seekSubTreePlacement(
 }
 
 template <const StateType num_states>
-void cmaple::Tree::applyOneSPR(const Index subtree_index,
-                               PhyloNode& subtree,
-                               const Index best_node_index,
-                               const bool is_mid_branch,
-                               const RealNumType branch_length,
-                               const RealNumType best_lh_diff) {
-  // record the SPR applied at this subtree
-  subtree.setSPRCount(subtree.getSPRCount() + 1);
-  // remove subtree from the tree
+void cmaple::Tree::pruneSubTree(PhyloNode& subtree) {
   const Index parent_index = subtree.getNeighborIndex(TOP);
   PhyloNode& parent_subtree =
       nodes[parent_index.getVectorIndex()];  // subtree->neighbor->getTopNode();
@@ -2891,6 +4725,19 @@ void cmaple::Tree::applyOneSPR(const Index subtree_index,
     node_stack.push(grandparent_index);  // sibling_subtree->neighbor);
     updatePartialLh<num_states>(node_stack);
   }
+}
+
+template <const StateType num_states>
+void cmaple::Tree::applyOneSPR(const Index subtree_index,
+                               PhyloNode& subtree,
+                               const Index best_node_index,
+                               const bool is_mid_branch,
+                               const RealNumType branch_length,
+                               const RealNumType best_lh_diff) {
+  // record the SPR applied at this subtree
+  subtree.setSPRCount(subtree.getSPRCount() + 1);
+  // remove subtree from the tree
+  pruneSubTree<num_states>(subtree);
 
   // replace the node and re-update the vector lists
   const std::unique_ptr<SeqRegions>& subtree_lower_regions =
@@ -3793,7 +5640,7 @@ void cmaple::Tree::estimateLengthNewBranch(
 }
 
 template <const StateType num_states>
-void cmaple::Tree::connectNewSample2Branch(
+auto cmaple::Tree::connectNewSample2Branch(
     std::unique_ptr<SeqRegions>& sample,
     const NumSeqsType seq_name_index,
     const Index sibling_node_index,
@@ -3802,7 +5649,8 @@ void cmaple::Tree::connectNewSample2Branch(
     const RealNumType down_distance,
     const RealNumType best_blength,
     std::unique_ptr<SeqRegions>& best_child_regions,
-    const std::unique_ptr<SeqRegions>& upper_left_right_regions) {
+    const std::unique_ptr<SeqRegions>& upper_left_right_regions)
+    -> NumSeqsType {
   const RealNumType threshold_prob = params->threshold_prob;
 
   // create new internal node and append child to it
@@ -3814,12 +5662,10 @@ void cmaple::Tree::connectNewSample2Branch(
   new_internal_node->next = next_node_2;
   next_node_2->next = next_node_1;
   next_node_1->next = new_internal_node;*/
-  createAnInternalNode();
-  createALeafNode(seq_name_index);
-  const NumSeqsType leaf_vec_index = static_cast<NumSeqsType>(nodes.size()) - 1;
+  const NumSeqsType internal_vec_index = createAnInternalNode();
+  const NumSeqsType leaf_vec_index = createALeafNode(seq_name_index);
   PhyloNode& leaf = nodes[static_cast<std::vector<cmaple::PhyloNode>
                             ::size_type>(leaf_vec_index)];
-  const NumSeqsType internal_vec_index = leaf_vec_index - 1;
   PhyloNode& internal = nodes[static_cast<std::vector<cmaple::PhyloNode>
                                 ::size_type>(internal_vec_index)];
 
@@ -3936,6 +5782,8 @@ void cmaple::Tree::connectNewSample2Branch(
   node_stack.push(sibling_node_index);
   node_stack.push(parent_index);
   updatePartialLh<num_states>(node_stack);
+
+  return leaf_vec_index;
 }
 
 template <const StateType num_states>
@@ -4114,14 +5962,14 @@ void cmaple::Tree::estimateLengthNewBranchAtRoot(
 }
 
 template <const StateType num_states>
-void cmaple::Tree::connectNewSample2Root(
+auto cmaple::Tree::connectNewSample2Root(
     std::unique_ptr<SeqRegions>& sample,
     const NumSeqsType seq_name_index,
     const Index sibling_node_index,
     PhyloNode& sibling_node,
     const RealNumType best_root_blength,
     const RealNumType best_length2,
-    std::unique_ptr<SeqRegions>& best_parent_regions) {
+    std::unique_ptr<SeqRegions>& best_parent_regions) -> NumSeqsType {
   const RealNumType threshold_prob = params->threshold_prob;
   // const MiniIndex sibling_node_mini_index =
   // sibling_node_index.getMiniIndex();
@@ -4135,12 +5983,10 @@ void cmaple::Tree::connectNewSample2Root(
   next_node_2->next = next_node_1;
   next_node_1->next = new_root;*/
 
-  createAnInternalNode();
-  createALeafNode(seq_name_index);
-  const NumSeqsType leaf_vec_index = static_cast<NumSeqsType>(nodes.size()) - 1;
+  const NumSeqsType new_root_vec_index = createAnInternalNode();
+  const NumSeqsType leaf_vec_index = createALeafNode(seq_name_index);
   PhyloNode& leaf = nodes[static_cast<std::vector<cmaple::PhyloNode>
                             ::size_type>(leaf_vec_index)];
-  const NumSeqsType new_root_vec_index = leaf_vec_index - 1;
   PhyloNode& new_root = nodes[static_cast<std::vector<cmaple::PhyloNode>::
                               size_type>(new_root_vec_index)];
 
@@ -4251,6 +6097,8 @@ void cmaple::Tree::connectNewSample2Root(
   stack<Index> node_stack;
   node_stack.push(sibling_node_index);
   updatePartialLh<num_states>(node_stack);
+
+  return leaf_vec_index;
 }
 
 template <const StateType num_states>
@@ -4645,12 +6493,24 @@ void cmaple::Tree::estimateBlength_O_X(
     // l' = [sum_x(q_xx + sum_y(q_xy))]/[sum_x(1 + q_xx * t + sum_y(q_xy * t))]
     // coeff1 = numerator = sum_x(q_xx + sum_y(q_xy))
     // coeff0 = denominator = sum_x(1 + q_xx * t + sum_y(q_xy * t))
-    for (StateType i = 0; i < num_states; ++i, mutation_mat_row += num_states) {
-      RealNumType seq1_lh_i = seq1_region.getLH(i);
-      coeff0 += seq1_lh_i * seq2_region.getLH(i);
+    // JC model: closed-form formula for sum_y(q_xy)
+    if (model->jc_rates) {
+      const RealNumType* const seq2_lh = &(*seq2_region.likelihood)[0];
+      const RealNumType sum_seq2_lh = sumVec<num_states>(seq2_lh);
+      for (StateType i = 0; i < num_states; ++i) {
+        RealNumType seq1_lh_i = seq1_region.getLH(i);
+        coeff0 += seq1_lh_i * seq2_lh[i];
+        coeff1 +=
+            seq1_lh_i * dotProductJC<num_states>(seq2_lh, sum_seq2_lh, i);
+      }
+    } else {
+      for (StateType i = 0; i < num_states; ++i, mutation_mat_row += num_states) {
+        RealNumType seq1_lh_i = seq1_region.getLH(i);
+        coeff0 += seq1_lh_i * seq2_region.getLH(i);
 
-      for (StateType j = 0; j < num_states; ++j) {
-        coeff1 += seq1_lh_i * seq2_region.getLH(j) * mutation_mat_row[j];
+        for (StateType j = 0; j < num_states; ++j) {
+          coeff1 += seq1_lh_i * seq2_region.getLH(j) * mutation_mat_row[j];
+        }
       }
     }
   }
@@ -5220,33 +7080,40 @@ void calculateSubtreeCost_R_O(const SeqRegion& seq1_region,
     RealNumType* transposed_mut_mat_row =
         model->transposed_mut_mat + model->row_index[seq1_state];
     RealNumType* mutation_mat_row = model->mutation_mat;
-
-    for (StateType i = 0; i < num_states; ++i, mutation_mat_row += num_states) {
-      // NHANLT NOTE: UNSURE
-      // tot2: likelihood that we can observe seq1_state elvoving from i at root
-      // (account for the fact that the observation might have occurred on the
-      // other side of the phylogeny with respect to the root) tot2 =
-      // root_freqs[seq1_state] * (1 + mut[seq1_state,seq1_state] *
-      // plength_observation2node) + root_freqs[i] * mut[i,seq1_state] *
-      // plength_observation2node
-      RealNumType tot2 = model->root_freqs[i] * transposed_mut_mat_row[i] *
-                             seq1_region.plength_observation2node +
-                         (seq1_state == i ? model->root_freqs[i] : 0);
-
-      // NHANLT NOTE:
-      // tot3: likelihood of i evolves to j
-      // tot3 = (1 + mut[i,i] * total_blength) * lh(seq2,i) + mut[i,j] *
-      // total_blength * lh(seq2,j)
-      RealNumType tot3 =
-          total_blength > 0
-              ? (total_blength *
-                 dotProduct<num_states>(mutation_mat_row,
-                                        &((*seq2_region.likelihood)[0])))
-              : 0;
-
-      // NHANLT NOTE:
-      // tot = tot2 * tot3
-      tot += tot2 * (seq2_region.getLH(i) + tot3);
+    // JC model: closed-form formula
+    if (model->jc_rates) {
+      tot = matrixEvolveRootJC<num_states>(
+          &((*seq2_region.likelihood)[0]), seq1_state, model->root_freqs,
+          transposed_mut_mat_row, total_blength > 0 ? total_blength : 0,
+          seq1_region.plength_observation2node);
+    } else {
+      for (StateType i = 0; i < num_states; ++i, mutation_mat_row += num_states) {
+        // NHANLT NOTE: UNSURE
+        // tot2: likelihood that we can observe seq1_state elvoving from i at root
+        // (account for the fact that the observation might have occurred on the
+        // other side of the phylogeny with respect to the root) tot2 =
+        // root_freqs[seq1_state] * (1 + mut[seq1_state,seq1_state] *
+        // plength_observation2node) + root_freqs[i] * mut[i,seq1_state] *
+        // plength_observation2node
+        RealNumType tot2 = model->root_freqs[i] * transposed_mut_mat_row[i] *
+                               seq1_region.plength_observation2node +
+                           (seq1_state == i ? model->root_freqs[i] : 0);
+
+        // NHANLT NOTE:
+        // tot3: likelihood of i evolves to j
+        // tot3 = (1 + mut[i,i] * total_blength) * lh(seq2,i) + mut[i,j] *
+        // total_blength * lh(seq2,j)
+        RealNumType tot3 =
+            total_blength > 0
+                ? (total_blength *
+                   dotProduct<num_states>(mutation_mat_row,
+                                          &((*seq2_region.likelihood)[0])))
+                : 0;
+
+        // NHANLT NOTE:
+        // tot = tot2 * tot3
+        tot += tot2 * (seq2_region.getLH(i) + tot3);
+      }
     }
 
     // NHANLT NOTE: UNCLEAR
@@ -5337,9 +7204,14 @@ void calculateSubtreeCost_O_O(const SeqRegion& seq1_region,
                               RealNumType& total_factor,
                               const ModelBase* model) {
   if (total_blength > 0) {
-    total_factor *= matrixEvolve<num_states>(
-        &((*seq1_region.likelihood)[0]), &((*seq2_region.likelihood)[0]),
-        model->mutation_mat, total_blength);
+    total_factor *=
+        model->jc_rates
+            ? matrixEvolveJC<num_states>(&((*seq1_region.likelihood)[0]),
+                                         &((*seq2_region.likelihood)[0]),
+                                         total_blength)
+            : matrixEvolve<num_states>(&((*seq1_region.likelihood)[0]),
+                                       &((*seq2_region.likelihood)[0]),
+                                       model->mutation_mat, total_blength);
   }
   // NHANLT NOTE:
   // the same as above but total_blength = 0 then we simplify the formula to
@@ -5409,10 +7281,16 @@ void calculateSubtreeCost_ACGT_O(const SeqRegion& seq1_region,
     RealNumType* transposed_mut_mat_row =
         model->transposed_mut_mat + model->row_index[seq1_state];
     RealNumType* mutation_mat_row = model->mutation_mat;
-    RealNumType tot = matrixEvolveRoot<num_states>(
-        &((*seq2_region.likelihood)[0]), seq1_state, model->root_freqs,
-        transposed_mut_mat_row, mutation_mat_row, total_blength,
-        seq1_region.plength_observation2node);
+    RealNumType tot =
+        model->jc_rates
+            ? matrixEvolveRootJC<num_states>(
+                  &((*seq2_region.likelihood)[0]), seq1_state,
+                  model->root_freqs, transposed_mut_mat_row, total_blength,
+                  seq1_region.plength_observation2node)
+            : matrixEvolveRoot<num_states>(
+                  &((*seq2_region.likelihood)[0]), seq1_state,
+                  model->root_freqs, transposed_mut_mat_row, mutation_mat_row,
+                  total_blength, seq1_region.plength_observation2node);
     // NHANLT NOTE: UNCLEAR
     // why we need to divide tot by root_freqs[seq1_state]
     // total_factor *= (tot / model->root_freqs[seq1_state]);
@@ -5982,6 +7860,10 @@ RealNumType cmaple::Tree::calculateSamplePlacementCost(
     // 2. e1.type = R
     // 2.1. e1.type = R and e2.type = R
     if (s1s2 == RR) [[likely]] {
+      // the cost only depends on the parent region -> go through all
+      // consecutive R regions of the sample at once
+      SeqRegions::extendSharedRSegment(seq1_regions, seq2_regions, iseq1,
+                                       iseq2, end_pos, false, true);
       calculateSampleCost_R_R(*seq1_region, cumulative_rate, blength, pos,
                               end_pos, lh_cost);
     }
@@ -8259,266 +10141,305 @@ RealNumType cmaple::Tree::calculateSiteLhs(
   return total_lh;
 }
 
-NumSeqsType cmaple::Tree::parseFile(
-    std::istream& infile,
-    char& ch,
-    RealNumType& branch_len,
-    PositionType& in_line,
-    PositionType& in_column,
-    const std::map<std::string, NumSeqsType>& map_seqname_index,
-    bool& missing_blengths) {
-  int maxlen = 1000;
-  string seqname;
-  int seqlen;
-  RealNumType brlen = -1;
-
-  // create new node
-  NumSeqsType tmp_root_vec;
-  // start with "(" -> an internal node
-  if (ch == '(') {
-    createAnInternalNode();
-    tmp_root_vec = static_cast<NumSeqsType>(nodes.size()) - 1;
-  }
-  // otherwise, it's a leaf
-  else {
-    createALeafNode(0);
-    tmp_root_vec = static_cast<NumSeqsType>(nodes.size()) - 1;
+namespace {
+/**
+ Get the (1-based) line and column of a position in a tree buffer
+ */
+auto getNewickPosition(const char* const buffer, const char* const pos)
+    -> std::string {
+  const PositionType line =
+      static_cast<PositionType>(std::count(buffer, pos, '\n')) + 1;
+  const char* line_start = pos;
+  while (line_start > buffer && line_start[-1] != '\n') {
+    --line_start;
+  }
+  return " (line " + convertIntToString(line) + " column " +
+         convertIntToString(static_cast<int>(pos - line_start) + 1) + ")";
+}
+
+/**
+ Skip control characters (e.g., spaces, line breaks) and comments [...]
+ @throw const char* if a comment is not ended with ']'
+ */
+void skipNewickSpaces(const char*& pos, const char* const buffer_end) {
+  while (pos < buffer_end) {
+    if (static_cast<unsigned char>(*pos) <= 32) {
+      ++pos;
+    } else if (*pos == '[') {
+      const char* const comment_end =
+          static_cast<const char*>(memchr(pos, ']', buffer_end - pos));
+      if (!comment_end) {
+        throw "Comments not ended with ]";
+      }
+      if (comment_end > pos + 1 && cmaple::verbose_mode > cmaple::VB_QUIET) {
+        std::cout << "Ignore " + std::string(pos, comment_end + 1)
+                  << std::endl;
+      }
+      pos = comment_end + 1;
+    } else {
+      return;
+    }
+  }
+}
+
+/**
+ Read a token (a node name or a branch length), which ends at a NEWICK token
+ or a control character. A name in quotes ends at the closing quote.
+ @throw const char* if the token is too long
+ */
+auto readNewickToken(const char*& pos, const char* const buffer_end)
+    -> std::string_view {
+  const std::string_view::size_type max_length = 1000;
+  const char* const start = pos;
+  if (pos < buffer_end && (*pos == '\'' || *pos == '"')) {
+    const char* const closing_quote =
+        static_cast<const char*>(memchr(pos + 1, *pos, buffer_end - pos - 1));
+    pos = closing_quote ? closing_quote + 1 : buffer_end;
+  } else {
+    while (pos < buffer_end && static_cast<unsigned char>(*pos) > 32 &&
+           *pos != ':' && *pos != ';' && *pos != ',' && *pos != ')' &&
+           *pos != '(' && *pos != '[' && *pos != ']') {
+      ++pos;
+    }
+  }
+  if (static_cast<std::string_view::size_type>(pos - start) >= max_length) {
+    throw "Too long name ( > 1000)";
+  }
+  return std::string_view(start, static_cast<std::size_t>(pos - start));
+}
+
+/**
+ Read a NEWICK tree (by blocks) from a stream until its terminating ';', which
+ is not inside a comment or a quoted name. The content after the tree is left
+ in the stream.
+ */
+auto readNewickString(std::istream& tree_stream) -> std::string {
+  // don't throw if the stream ends before the terminating ';'
+  const std::ios::iostate exceptions = tree_stream.exceptions();
+  tree_stream.exceptions(ios::badbit);
+
+  std::string tree_str;
+  std::vector<char> block(1 << 16);
+  // the character closing the current comment or quoted name (if any)
+  char closing_char = 0;
+  // TRUE if a quoted name may start at the current position
+  bool token_start = true;
+  std::string::size_type scanned = 0;
+  for (;;) {
+    // read a block, stopping before the next ';'
+    tree_stream.get(block.data(), static_cast<std::streamsize>(block.size()),
+                    ';');
+    tree_str.append(block.data(),
+                    static_cast<std::string::size_type>(tree_stream.gcount()));
+    if (tree_stream.eof() || tree_stream.bad()) {
+      break;
+    }
+    // get() fails if the block is empty (i.e., the next char is ';')
+    tree_stream.clear();
+    if (tree_stream.peek() != ';') {
+      continue;
+    }
+    tree_stream.get();
+
+    // skip the new content in comments and quoted names
+    for (; scanned < tree_str.size(); ++scanned) {
+      const char ch = tree_str[scanned];
+      if (closing_char) {
+        if (ch == closing_char) {
+          token_start = closing_char == ']' && token_start;
+          closing_char = 0;
+        }
+      } else if (ch == '[') {
+        closing_char = ']';
+      } else if (token_start && (ch == '\'' || ch == '"')) {
+        closing_char = ch;
+      } else {
+        token_start = static_cast<unsigned char>(ch) <= 32 || ch == '(' ||
+                      ch == ')' || ch == ',' || ch == ':';
+      }
+    }
+    tree_str.push_back(';');
+    ++scanned;
+    if (!closing_char) {
+      break;
+    }
   }
 
-  // start with "(" -> an internal node
-  if (ch == '(') {
-    MiniIndex child_mini = RIGHT;
+  tree_stream.clear(tree_stream.rdstate() & ~ios::failbit);
+  tree_stream.exceptions(exceptions);
+  return tree_str;
+}
+}  // namespace
+
+NumSeqsType cmaple::Tree::parseNewick(
+    const char* const buffer,
+    const char* const buffer_end,
+    const std::unordered_map<std::string_view, NumSeqsType>& map_seqname_index,
+    bool& missing_blengths) {
+  // an (internal) node whose children are being read
+  struct Clade {
+    NumSeqsType vec_index;
+    MiniIndex child_mini;
+  };
+  // clades which are not closed yet -> the stack replaces recursive calls so
+  // that very deep trees don't overflow the call stack
+  std::vector<Clade> clades;
+  const PositionType seq_length =
+      static_cast<PositionType>(aln->ref_seq.size());
+  const char* pos = buffer;
+
+  try {
+    skipNewickSpaces(pos, buffer_end);
+    if (pos == buffer_end || *pos != '(') {
+      throw "Tree file does not start with an opening-bracket '('";
+    }
+
+    // TRUE to read a new node, FALSE to close the innermost clade
+    bool new_node = true;
+    while (true) {
+      // open a new clade
+      if (new_node && *pos == '(') {
+        clades.push_back({createAnInternalNode(), RIGHT});
+        ++pos;
+        skipNewickSpaces(pos, buffer_end);
+        if (pos == buffer_end) {
+          throw "Expecting ')', but end of file instead";
+        }
+        new_node = *pos != ')';
+        continue;
+      }
+
+      // create a new leaf or close the innermost clade
+      NumSeqsType node_vec;
+      if (new_node) {
+        node_vec = createALeafNode(0);
+      } else {
+        node_vec = clades.back().vec_index;
+        clades.pop_back();
+        ++pos;
+        skipNewickSpaces(pos, buffer_end);
+      }
+
+      // read the node name
+      const std::string_view name = readNewickToken(pos, buffer_end);
+      skipNewickSpaces(pos, buffer_end);
+      PhyloNode& node = nodes[node_vec];
+      if (!node.isInternal()) {
+        if (name.empty()) {
+          throw "Redundant double-bracket ‘((…))’ with closing bracket ending "
+                "at";
+        }
+        std::string seqname(name);
+        renameString(seqname);
+        const auto it = map_seqname_index.find(seqname);
+        if (it == map_seqname_index.end()) {
+          throw "Leaf " + seqname +
+              " is not found in the alignment. Please check and try again!";
+        }
+        const NumSeqsType sequence_index = it->second;
+        node.setSeqNameIndex(sequence_index);
+        node.setPartialLh(TOP, aln->data[sequence_index].getLowerLhVector(
+                                   seq_length, aln->num_states,
+                                   aln->getSeqType()));
+
+        // mark the sequece as added (to the tree)
+        sequence_added[sequence_index] = true;
+      }
+
+      // read the branch length (if any)
+      RealNumType blength = -1;
+      if (pos < buffer_end && *pos == ':') {
+        ++pos;
+        skipNewickSpaces(pos, buffer_end);
+        const std::string_view blength_str = readNewickToken(pos, buffer_end);
+        skipNewickSpaces(pos, buffer_end);
+        if (pos == buffer_end) {
+          throw "branch length format error.";
+        }
+        blength = convert_real_number(std::string(blength_str).c_str());
+      }
 
-    ch = readNextChar(infile, in_line, in_column);
-    while (ch != ')' && !infile.eof()) {
-      const NumSeqsType tmp_node_vec =
-          parseFile(infile, ch, brlen, in_line, in_column, map_seqname_index,
-                    missing_blengths);
+      // the top node
+      if (clades.empty()) {
+        if (pos == buffer_end || *pos != ';') {
+          throw "Tree file must be ended with a semi-colon ';'";
+        }
+        return node_vec;
+      }
 
-      if (child_mini == UNDEFINED) {
+      // connect the node to the innermost clade
+      Clade& clade = clades.back();
+      if (clade.child_mini == UNDEFINED) {
         if (cmaple::verbose_mode > cmaple::VB_QUIET) {
           std::cout << "Converting a mutifurcating to a bifurcating tree"
                     << std::endl;
         }
 
         // create a new parent node
-        createAnInternalNode();
-        const NumSeqsType new_tmp_root_vec = static_cast<NumSeqsType>(nodes.size()) - 1;
-        // connect the current root node to the new parent node
-        nodes[new_tmp_root_vec].setNeighborIndex(RIGHT,
-                                                 Index(tmp_root_vec, TOP));
-        PhyloNode& current_root = nodes[tmp_root_vec];
-        current_root.setNeighborIndex(TOP, Index(new_tmp_root_vec, RIGHT));
-        current_root.setUpperLength(0);
-
-        // the new parent becomes the current root node -> new child will be
-        // added as the left child of the (new) root node
-        tmp_root_vec = new_tmp_root_vec;
-        child_mini = LEFT;
+        const NumSeqsType new_clade_vec = createAnInternalNode();
+        // connect the current root node of the clade to the new parent node
+        nodes[new_clade_vec].setNeighborIndex(RIGHT,
+                                              Index(clade.vec_index, TOP));
+        PhyloNode& clade_root = nodes[clade.vec_index];
+        clade_root.setNeighborIndex(TOP, Index(new_clade_vec, RIGHT));
+        clade_root.setUpperLength(0);
+
+        // the new parent becomes the root node of the clade -> new child will
+        // be added as its left child
+        clade.vec_index = new_clade_vec;
+        clade.child_mini = LEFT;
       }
-
-      PhyloNode& node = nodes[tmp_node_vec];
-      nodes[tmp_root_vec].setNeighborIndex(child_mini,
-                                           Index(tmp_node_vec, TOP));
-      node.setNeighborIndex(TOP, Index(tmp_root_vec, child_mini));
+      nodes[clade.vec_index].setNeighborIndex(clade.child_mini,
+                                              Index(node_vec, TOP));
+      PhyloNode& child = nodes[node_vec];
+      child.setNeighborIndex(TOP, Index(clade.vec_index, clade.child_mini));
       // If the branch length is not specify -> set it to default_blength and
       // mark the tree with missing blengths so that we can re-estimate the
       // blengths later
-      if (brlen == -1) {
-        brlen = default_blength;
+      if (blength == -1) {
+        blength = default_blength;
         missing_blengths = true;
       }
-      node.setUpperLength(brlen);
+      child.setUpperLength(blength);
 
-      // change to the second child
-      child_mini = (child_mini == RIGHT) ? LEFT : UNDEFINED;
+      // change to the next child
+      clade.child_mini = (clade.child_mini == RIGHT) ? LEFT : UNDEFINED;
 
-      if (infile.eof()) {
+      // move to the next child or close the clade
+      if (pos == buffer_end) {
         throw "Expecting ')', but end of file instead";
       }
-      if (ch == ',') {
-        ch = readNextChar(infile, in_line, in_column);
-      } else if (ch != ')') {
+      if (*pos == ',') {
+        ++pos;
+        skipNewickSpaces(pos, buffer_end);
+        if (pos == buffer_end) {
+          throw "Expecting ')', but end of file instead";
+        }
+        new_node = *pos != ')';
+      } else if (*pos == ')') {
+        new_node = false;
+      } else {
         string err = "Expecting ')', but found '";
-        err += ch;
+        err += *pos;
         err += "' instead";
         throw err;
       }
     }
-    if (!infile.eof()) {
-      ch = readNextChar(infile, in_line, in_column);
-    }
-  }
-
-  // now read the node name
-  seqlen = 0;
-  char end_ch = 0;
-  if (ch == '\'' || ch == '"') {
-    end_ch = ch;
-  }
-  seqname = "";
-
-  while (!infile.eof() && seqlen < maxlen) {
-    if (end_ch == 0) {
-      if (is_newick_token(ch) || controlchar(ch)) {
-        break;
-      }
-    }
-    seqname += ch;
-    seqlen++;
-    ch = infile.get();
-    in_column++;
-    if (end_ch != 0 && ch == end_ch) {
-      seqname += ch;
-      seqlen++;
-      break;
-    }
-  }
-  if ((controlchar(ch) || ch == '[' || ch == end_ch) && !infile.eof()) {
-    ch = readNextChar(infile, in_line, in_column, ch);
-  }
-  if (seqlen == maxlen) {
-    throw "Too long name ( > 1000)";
-  }
-  PhyloNode& tmp_root = nodes[tmp_root_vec];
-  if (!tmp_root.isInternal()) {
-    renameString(seqname);
-  }
-  //    seqname[seqlen] = 0;
-  if (seqlen == 0 && !tmp_root.isInternal()) {
-    throw "Redundant double-bracket ‘((…))’ with closing bracket ending at";
-  }
-  if (seqlen > 0 && !tmp_root.isInternal()) {
-    auto it = map_seqname_index.find(seqname);
-    if (it == map_seqname_index.end()) {
-      throw "Leaf " + seqname +
-          " is not found in the alignment. Please check and try again!";
-    } else {
-      const NumSeqsType sequence_index = it->second;
-      tmp_root.setSeqNameIndex(sequence_index);
-      tmp_root.setPartialLh(TOP, aln->data[sequence_index]
-                .getLowerLhVector(static_cast<PositionType>(aln->ref_seq.size()),
-                                  aln->num_states, aln->getSeqType()));
-
-      // mark the sequece as added (to the tree)
-      sequence_added[sequence_index] = true;
-    }
-  }
-  /*if (!tmp_root.isInternal()) {
-      // is a leaf, assign its ID
-      if (leafNum == 0)
-          cmaple::Tree::root_vector_index = root;
-  }*/
-
-  if (ch == ';' || infile.eof()) {
-    return tmp_root_vec;
-  }
-  // parse branch length
-  if (ch == ':') {
-    // string saved_comment = in_comment;
-    ch = readNextChar(infile, in_line, in_column);
-    /*if (in_comment.empty())
-        in_comment = saved_comment;*/
-    seqlen = 0;
-    seqname = "";
-    while (!is_newick_token(ch) && !controlchar(ch) && !infile.eof() &&
-           seqlen < maxlen) {
-      //            seqname[seqlen] = ch;
-      seqname += ch;
-      seqlen++;
-      ch = infile.get();
-      in_column++;
-    }
-    if ((controlchar(ch) || ch == '[') && !infile.eof()) {
-      ch = readNextChar(infile, in_line, in_column, ch);
-    }
-    if (seqlen == maxlen || infile.eof()) {
-      throw "branch length format error.";
-    }
-    branch_len = convert_real_number(seqname.c_str());
-  }
-  // handle the case of multiple-length branches but lack of the average branch
-  // length e.g A[0.1/0.2/0.3/0.4] instead of A[0.1/0.2/0.3/0.4]:0.25
-  /*else if (in_comment.length())
-  {
-      // set default average branch length at 0
-      string default_avg_length = "0";
-      parseBranchLength(default_avg_length, branch_len);
-  }*/
-
-  return tmp_root_vec;
-}
-
-const char cmaple::Tree::readNextChar(std::istream& in,
-                                      PositionType& in_line,
-                                      PositionType& in_column,
-                                      const char& current_ch) const {
-  char ch;
-  if (current_ch == '[') {
-    ch = current_ch;
-  } else {
-    in.get(ch);
-    in_column++;
-
-    if (ch == 10) {
-      in_line++;
-      in_column = 1;
-    }
-  }
-  // check if ch is a control character (ascii <= 32)
-  while (controlchar(ch) && !in.eof()) {
-    in.get(ch);
-    in_column++;
-
-    if (ch == 10) {
-      in_line++;
-      in_column = 1;
-    }
-  }
-  string in_comment = "";
-  // ignore comment
-  while (ch == '[' && !in.eof()) {
-    while (ch != ']' && !in.eof()) {
-      in.get(ch);
-      if (ch != ']') {
-        in_comment += ch;
-      }
-      in_column++;
-      if (ch == 10) {
-        in_line++;
-        in_column = 1;
-      }
-    }
-    if (ch != ']') {
-      throw "Comments not ended with ]";
-    }
-    in_column++;
-    in.get(ch);
-    if (ch == 10) {
-      in_line++;
-      in_column = 1;
-    }
-    while (controlchar(ch) && !in.eof()) {
-      in_column++;
-      in.get(ch);
-      if (ch == 10) {
-        in_line++;
-        in_column = 1;
-      }
-    }
-    if (in_comment.length() && cmaple::verbose_mode > cmaple::VB_QUIET) {
-      std::cout << "Ignore [" + in_comment + "]" << std::endl;
-    }
+  } catch (const char* str) {
+    throw std::invalid_argument(str + getNewickPosition(buffer, pos));
+  } catch (const string& str) {
+    throw std::invalid_argument(str + getNewickPosition(buffer, pos));
   }
-  return ch;
 }
 
-std::map<std::string, NumSeqsType> cmaple::Tree::initMapSeqNameIndex() {
+auto cmaple::Tree::initMapSeqNameIndex()
+    -> std::unordered_map<std::string_view, NumSeqsType> {
   assert(aln);
 
-  // create the map
-  std::map<std::string, NumSeqsType> map_seqname_index;
+  // create the map (the keys refer to the sequence names in the alignment)
+  std::unordered_map<std::string_view, NumSeqsType> map_seqname_index;
   const std::vector<Sequence>& sequences = aln->data;
+  map_seqname_index.reserve(sequences.size());
   for (NumSeqsType i = 0; i < sequences.size(); ++i) {
     map_seqname_index.emplace(sequences[i].seq_name, i);
   }
@@ -8528,7 +10449,7 @@ std::map<std::string, NumSeqsType> cmaple::Tree::initMapSeqNameIndex() {
 
 NumSeqsType cmaple::Tree::markAnExistingSeq(
     const std::string& seq_name,
-    const std::map<std::string, NumSeqsType>& map_name_index) {
+    const std::unordered_map<std::string_view, NumSeqsType>& map_name_index) {
   NumSeqsType new_seq_index = 0;
 
   // Find the sequence name
@@ -8548,32 +10469,58 @@ NumSeqsType cmaple::Tree::markAnExistingSeq(
   return new_seq_index;
 }
 
-void cmaple::Tree::remarkExistingSeqs() {
+auto cmaple::Tree::remarkExistingSeqs() -> bool {
   assert(aln);
 
   // init a mapping between sequence names and its index in the alignment
-  std::map<std::string, NumSeqsType> map_name_index = initMapSeqNameIndex();
+  const std::unordered_map<std::string_view, NumSeqsType> map_name_index =
+      initMapSeqNameIndex();
+
+  // keep the names of the removed sequences to mark them again
+  std::vector<std::string_view> removed_names;
+  for (std::vector<bool>::size_type i = 0; i < sequence_removed.size(); ++i) {
+    if (sequence_removed[i]) {
+      removed_names.push_back(seq_names[i]);
+    }
+  }
 
   // reset all marked sequences
   resetSeqAdded();
+  for (const std::string_view removed_name : removed_names) {
+    const auto iter = map_name_index.find(removed_name);
+    if (iter != map_name_index.end()) {
+      sequence_removed[iter->second] = true;
+    }
+  }
+
+  // re-index a sequence in the tree, checking if its mutations are unchanged
+  bool same_mutations = true;
+  const auto remark_seq = [&](const NumSeqsType seq_index) {
+    const NumSeqsType new_seq_index =
+        markAnExistingSeq(seq_names[seq_index], map_name_index);
+    same_mutations = same_mutations && seq_index < seq_hashes.size() &&
+                     hashMutations(aln->data[new_seq_index]) ==
+                         seq_hashes[seq_index];
+    return new_seq_index;
+  };
 
   // browse all nodes to mark existing leave as added
   for (std::vector<cmaple::PhyloNode>::size_type i = 0; i < nodes.size(); ++i) {
-    // only consider leave
-    if (!nodes[i].isInternal()) {
+    // only consider leave (in the tree)
+    if (!nodes[i].isInternal() && !isFreeNode(i)) {
       PhyloNode& node = nodes[i];
 
       // mark the leaf itself
-      node.setSeqNameIndex(
-          markAnExistingSeq(seq_names[node.getSeqNameIndex()], map_name_index));
+      node.setSeqNameIndex(remark_seq(node.getSeqNameIndex()));
 
       // mark its less-info sequences
       std::vector<NumSeqsType>& less_info_seqs = node.getLessInfoSeqs();
       for (std::vector<NumSeqsType>::size_type j = 0; j < less_info_seqs.size(); ++j)
-        less_info_seqs[j] =
-            markAnExistingSeq(seq_names[less_info_seqs[j]], map_name_index);
+        less_info_seqs[j] = remark_seq(less_info_seqs[j]);
     }
   }
+
+  return same_mutations;
 }
 
 bool cmaple::Tree::readTree(std::istream& tree_stream) {
@@ -8581,90 +10528,30 @@ bool cmaple::Tree::readTree(std::istream& tree_stream) {
   bool missing_blengths = false;
 
   // create a map between leave and sequences in the alignment
-  std::map<std::string, NumSeqsType> map_seqname_index = initMapSeqNameIndex();
+  const std::unordered_map<std::string_view, NumSeqsType> map_seqname_index =
+      initMapSeqNameIndex();
 
   if (cmaple::verbose_mode >= cmaple::VB_MED) {
     std::cout << "Reading a tree" << std::endl;
   }
 
-  // Read tree from the stream
-  PositionType in_line = 1;
-  PositionType in_column = 1;
-  // std::string in_comment{};
-
-  try {
-    char ch;
-    ch = readNextChar(tree_stream, in_line, in_column);
-    if (ch != '(') {
-      cout << tree_stream.rdbuf() << endl;
-      throw "Tree file does not start with an opening-bracket '('";
-    }
-
-    RealNumType branch_len;
-    const NumSeqsType tmp_node_vec =
-        parseFile(tree_stream, ch, branch_len, in_line, in_column, map_seqname_index,
-                  missing_blengths);
+  // Read the tree (by blocks) into a buffer
+  const std::string tree_str = readNewickString(tree_stream);
 
-    // set root
-    if (nodes[tmp_node_vec].isInternal()) {
-      root_vector_index = tmp_node_vec;
-    } else {
-      for (NumSeqsType i = 0; i < nodes.size(); ++i)
-        if (nodes[i].isInternal()) {
-          root_vector_index = i;
-          break;
-        }
-    }
-    // 2018-01-05: assuming rooted tree if root node has two children
-    /*if (is_rooted || (branch_len != 0.0) || node->degree() == 2) {
-        if (branch_len == -1.0) branch_len = 0.0;
-        if (branch_len < 0.0)
-            throw ERR_NEG_BRANCH;
-        root = newNode(leafNum, ROOT_NAME);
-        root->addNeighbor(node, branch_len);
-        node->addNeighbor(root, branch_len);
-        leafNum++;
-        rooted = true;
-
-        // parse key/value from comment
-        string KEYWORD="&";
-        bool in_comment_contains_key_value = in_comment.length() >
-    KEYWORD.length()
-                                              && !in_comment.substr(0,
-    KEYWORD.length()).compare(KEYWORD); if (in_comment_contains_key_value)
-            parseKeyValueFromComment(in_comment, root, node);
-
-
-    } else { // assign root to one of the neighbor of node, if any
-        FOR_NEIGHBOR_IT(node, NULL, it)
-        if ((*it)->node->isLeaf()) {
-            root = (*it)->node;
-            break;
-        }
-    }
-    // make sure that root is a leaf
-    assert(root->isLeaf());*/
+  // Parse the tree
+  const NumSeqsType tmp_node_vec =
+      parseNewick(tree_str.data(), tree_str.data() + tree_str.size(),
+                  map_seqname_index, missing_blengths);
 
-    if (tree_stream.eof() || ch != ';') {
-      throw "Tree file must be ended with a semi-colon ';'";
-    }
-  } catch (bad_alloc) {
-    throw std::bad_alloc();
-  } catch (const char* str) {
-    std::string err_msg(str);
-    throw std::invalid_argument(err_msg + " (line " +
-                                convertIntToString(in_line) + " column " +
-                                convertIntToString(in_column - 1) + ")");
-  } catch (string str) {
-    throw std::invalid_argument(str + " (line " + convertIntToString(in_line) +
-                                " column " + convertIntToString(in_column - 1) +
-                                ")");
-  } catch (...) {
-    // anything else
-    std::string err_msg(ERR_READ_ANY);
-    throw std::invalid_argument(err_msg + " (line " +
-                                convertIntToString(in_line) + " column " +
-                                convertIntToString(in_column - 1) + ")");
+  // set root
+  if (nodes[tmp_node_vec].isInternal()) {
+    root_vector_index = tmp_node_vec;
+  } else {
+    for (NumSeqsType i = 0; i < nodes.size(); ++i)
+      if (nodes[i].isInternal()) {
+        root_vector_index = i;
+        break;
+      }
   }
 
   if (cmaple::verbose_mode >= cmaple::VB_DEBUG) {
@@ -8731,7 +10618,8 @@ void cmaple::Tree::collapseAllZeroLeave() {
             if (root_vector_index == node_index.getVectorIndex() ||
                 node.getUpperLength() <= 0) {
               collapseOneZeroLeaf(node, node_index, neighbor_1,
-                                  neighbor_1_index, neighbor_2);
+                                  neighbor_1_index, neighbor_2,
+                                  neighbor_2_index);
               ++num_collapsed_nodes;
             }
           }
@@ -8762,7 +10650,8 @@ void cmaple::Tree::collapseOneZeroLeaf(PhyloNode& node,
                                        Index& node_index,
                                        PhyloNode& neighbor_1,
                                        const Index neighbor_1_index,
-                                       PhyloNode& neighbor_2) {
+                                       PhyloNode& neighbor_2,
+                                       const Index neighbor_2_index) {
   if (cmaple::verbose_mode >= cmaple::VB_DEBUG)
     std::cout << "Collapse " << seq_names[neighbor_2.getSeqNameIndex()]
               << " into the vector of less-info_seqs of "
@@ -8775,6 +10664,10 @@ void cmaple::Tree::collapseOneZeroLeaf(PhyloNode& node,
   neighbor_1_vector.insert(neighbor_1_vector.end(), neighbor_2_vector.begin(),
                            neighbor_2_vector.end());
 
+  // neighbor_2 is detached from the tree -> remove it from the index of
+  // mutations
+  indexLeafMutations(neighbor_2_index.getVectorIndex(), false);
+
   // if node is root -> neighbor_1 becomes the new root
   if (root_vector_index == node_index.getVectorIndex()) {
     root_vector_index = neighbor_1_index.getVectorIndex();
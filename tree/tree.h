@@ -1,6 +1,8 @@
 #include "../alignment/alignment.h"
 #include "../model/model.h"
 #include "updatingnode.h"
+#include <array>
+#include <cstdint>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -138,6 +140,12 @@ class Tree {
             const bool fixed_blengths = false);
 
   /*! \brief Change the alignment
+   *
+   * If the new alignment has the same reference sequence as the current one
+   * and the mutations of every sequence already in the tree are unchanged, the
+   * partial likelihoods and model parameters of the current tree are kept and
+   * only the new sequences are queued for the next doPlacement(). Otherwise,
+   * they are re-computed from the new alignment.
    * @param[in] aln An alignment
    * @throw std::invalid\_argument If the alignment is empty
    * @throw std::logic\_error if any of the following situations occur.
@@ -263,6 +271,64 @@ class Tree {
                                    const bool allow_replacing_ML_tree = true,
                                    std::ostream& out_stream = std::cout);
 
+  /*! \brief Place the sequences of the alignment which are not yet in the
+   * tree (i.e., the queries) onto the tree, without changing the tree. Each
+   * query is placed independently of the others (in parallel), and the best
+   * placement of each query is written in
+   * [jplace](https://doi.org/10.1371/journal.pone.0031009) format: the edge
+   * above which the query is attached, the likelihood of the tree with the
+   * query, the distal (from the lower end of the edge) and pendant branch
+   * lengths, and the log-likelihood difference of placing the query
+   * @param[out] jplace_stream The output stream of the placements
+   * @param[in] num_threads The number of threads (optional)
+   * @param[out] out_stream The output message stream (optional)
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - num_threads < 0 or num_threads > the number of CPU cores
+   *
+   * @throw std::logic\_error if any of the following situations occur.
+   * - the tree is empty
+   * - the attached substitution model is unknown/unsupported
+   * - unexpected values/behaviors found during the operations
+   */
+  void placeQueries(std::ostream& jplace_stream,
+                    const int num_threads = 1,
+                    std::ostream& out_stream = std::cout);
+
+  /*! \brief Remove samples from the tree without re-inferring it. A leaf is
+   * detached (its parent node is suppressed, merging the two branches around
+   * it), or, if it represents less-informative sequences, the most
+   * informative of them takes its place (the others that are not less
+   * informative than it are placed again by the next doPlacement()); a
+   * less-informative sequence is simply dropped. Only the
+   * likelihoods affected by the removals are updated. The removed sequences
+   * remain in the alignment but are no longer in the tree. They are not placed
+   * again by later calls of doPlacement() or placeQueries() (even after
+   * changeAln()), until a new tree is loaded.
+   * @param[in] names The names of the sequences to remove
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - a sequence is not found in the tree
+   * - fewer than two samples would remain in the tree
+   *
+   * @throw std::logic\_error if any of the following situations occur.
+   * - the tree is empty
+   * - unexpected values/behaviors found during the operations
+   */
+  void removeSamples(const std::vector<std::string>& names);
+
+  /*! \brief Report where the given sequences are in the tree (e.g., after
+   * placing them by doPlacement()), one line per sequence with four
+   * tab-separated columns: the sequence name, the length of the branch
+   * connecting it to the tree, the name of a close sample (reached by
+   * descending the sibling clade along the shortest branches), and the
+   * distance to that sample. A less-informative sequence, which is
+   * represented by a more informative sample, gets that sample with zero
+   * distances. A sequence not found in the tree gets `NA`.
+   * @param[in] names The names of the sequences
+   * @param[out] out_stream The output stream
+   */
+  void exportPlacements(const std::vector<std::string>& names,
+                        std::ostream& out_stream);
+
   /*! \brief Export the phylogenetic tree  to a string in NEWICK format.
    * @param[in] tree_type The type of the output tree (optional): BIN_TREE
    * (bifurcating tree), MUL_TREE (multifurcating tree)
@@ -275,6 +341,58 @@ class Tree {
   std::string exportNewick(const TreeType tree_type = BIN_TREE,
                            const bool show_branch_supports = true);
 
+  /*! \brief Write the phylogenetic tree in NEWICK format to a stream. Unlike
+   * exportNewick(tree_type, show_branch_supports), the tree string is
+   * streamed out in blocks without building the whole string in memory.
+   * @param[out] out_stream The output stream
+   * @param[in] tree_type The type of the output tree (optional): BIN_TREE
+   * (bifurcating tree), MUL_TREE (multifurcating tree)
+   * @param[in] show_branch_supports TRUE to output the branch supports (aLRT-SH
+   * values)
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - tree\_type is unknown
+   */
+  void exportNewick(std::ostream& out_stream,
+                    const TreeType tree_type = BIN_TREE,
+                    const bool show_branch_supports = true);
+
+  /*! \brief Save a binary checkpoint of the tree, including all partial
+   * likelihoods, the model parameters, and the SPR flags, which allows the
+   * inference to be resumed later by loadCheckpoint() without recomputation.
+   * @param[out] out_stream A (binary) stream to write the checkpoint
+   * @throw ios::failure if failing to write the checkpoint
+   */
+  void saveCheckpoint(std::ostream& out_stream);
+
+  /*! \brief Save a binary checkpoint of the tree to a file
+   * @param[in] checkpoint_filename Name of the checkpoint file
+   * @throw std::invalid\_argument if the file name is empty
+   * @throw ios::failure if failing to write the checkpoint file
+   */
+  void saveCheckpoint(const std::string& checkpoint_filename);
+
+  /*! \brief Restore the tree from a binary checkpoint written by
+   * saveCheckpoint(). The tree must be attached to the same alignment and
+   * (type of) model as the tree that wrote the checkpoint. Afterwards,
+   * doPlacement(), applySPR(), optimizeBranch(), etc. continue from the
+   * restored state without recomputing the likelihoods.
+   * @param[in] in_stream A (binary) stream of the checkpoint
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - the checkpoint is corrupted or in an unsupported version
+   * - the checkpoint does not match the attached alignment or model
+   */
+  void loadCheckpoint(std::istream& in_stream);
+
+  /*! \brief Restore the tree from a binary checkpoint file
+   * @param[in] checkpoint_filename Name of the checkpoint file
+   * @throw std::invalid\_argument if any of the following situations occur.
+   * - the file name is empty
+   * - the checkpoint is corrupted or in an unsupported version
+   * - the checkpoint does not match the attached alignment or model
+   * @throw ios::failure if the checkpoint file is not found
+   */
+  void loadCheckpoint(const std::string& checkpoint_filename);
+
   // ----------------- END OF PUBLIC APIs ------------------------------------
   // //
 
@@ -322,6 +440,43 @@ class Tree {
    */
   std::vector<PhyloNode> nodes;
 
+  /**
+   (vector) Indexes of the internal nodes freed by removeSamples(), which are
+   reused by later placements
+   */
+  std::vector<cmaple::NumSeqsType> free_internal_vec_indexes;
+
+  /**
+   (vector) Indexes of the leaves freed by removeSamples(), which are reused by
+   later placements
+   */
+  std::vector<cmaple::NumSeqsType> free_leaf_vec_indexes;
+
+  /**
+   An inverted index from mutations (i.e., position * num_states + state) to
+   the (vector) indexes of the leaves carrying them, used to seed the search
+   for sample placements (if params->seed_placement). Mutations carried by more
+   than params->seed_rare_mutation_limit leaves are common: only their counts
+   are kept. Empty if not built yet
+   */
+  std::vector<std::vector<cmaple::NumSeqsType>> mutation_leaves;
+
+  /**
+   The number of leaves carrying each mutation in mutation_leaves
+   */
+  std::vector<cmaple::NumSeqsType> mutation_counts;
+
+  /**
+   Masks of the leaves below each node, by (vector) index, used to bound the
+   placement costs of samples within subtrees (if params->bound_placement): the
+   first 256 bits are a Bloom filter of the mutations carried by those leaves;
+   the last 256 bits mark the blocks of positions where any of them has missing
+   or ambiguous data. A mask may have extra bits set but never misses a
+   mutation or missing data of the leaves below. Rebuilt whenever placing
+   samples, as the tree may have changed since
+   */
+  std::vector<std::array<std::uint64_t, 8>> mutation_masks;
+
   /**
    Vector of likelihood contributions of internal nodes
    */
@@ -339,12 +494,31 @@ class Tree {
    */
   std::vector<std::string> seq_names;
 
+  /**
+   The hashes of the mutations of the sequences (in the same order as
+   seq_names), to find identical sequences and to detect the sequences changed
+   in a new alignment
+   */
+  std::vector<std::size_t> seq_hashes;
+
+  /**
+   A backup of the reference sequence that the partial likelihoods and the
+   model are derived from
+   */
+  std::vector<cmaple::StateType> attached_ref_seq;
+
   /**
    a vector denote whether a sequence in the alignment is added to the tree or
    not
    */
   std::vector<bool> sequence_added;
 
+  /**
+   a vector denote whether a sequence in the alignment was removed from the
+   tree (by removeSamples()), which is then excluded from later placements
+   */
+  std::vector<bool> sequence_removed;
+
   /*!
    * Apply some minor changes (collapsing zero-branch leaves into less-info
    * sequences, re-estimating model parameters) to make the processes of
@@ -375,10 +549,87 @@ class Tree {
    * @return a TreeType
    */
   static TreeType parseTreeType(const std::string& tree_type_str);
+
+  // declare TreeTester (of the unit tests) as a friend class
+  friend class TreeTester;
     
   /*! \endcond */
 
  private:
+  /**
+   Stages of the inference at which checkpoints are written
+   */
+  enum InferenceStage : uint8_t {
+    PLACEMENT_STAGE,
+    SHALLOW_SEARCH_STAGE,
+    TREE_SEARCH_STAGE,
+  };
+
+  /**
+   Progress of the inference, which is stored in checkpoints to resume an
+   interrupted tree search from the same round
+   */
+  struct InferenceProgress {
+    InferenceStage stage = PLACEMENT_STAGE;
+    /// the round of tree search (in optimizeTreeTopology())
+    int32_t round = 0;
+    /// the subround of tree search, -1 denotes the first traversal of a round
+    int32_t subround = -1;
+  };
+
+  /**
+   A position for placing a new sample, which is computed (without changing
+   the tree) by computePlacementMidBranch() or computePlacementAtNode()
+   */
+  struct SamplePlacement {
+    /// the node whose upper branch the new sample is attached to
+    cmaple::Index sibling_index;
+    /// TRUE if the new sample and the (old) root become children of a new root
+    bool at_root = false;
+    /// the length of the branch from the new internal node to its parent
+    cmaple::RealNumType top_distance = 0;
+    /// the length of the branch from the new internal node to the sibling
+    /// node, -1 if the new sample is attached exactly at the sibling node
+    cmaple::RealNumType down_distance = 0;
+    /// the length of the new branch leading to the new sample
+    cmaple::RealNumType blength = 0;
+    /// the log-likelihood difference of the placement (if computed)
+    cmaple::RealNumType lh_diff = 0;
+    /// the likelihood regions at the new internal node
+    std::unique_ptr<SeqRegions> regions = nullptr;
+  };
+
+  /**
+   A mutation (to a specific state) of a sample, with its bits in the masks of
+   mutations, to bound the placement costs of the sample
+   */
+  struct SampleMutationBits {
+    /// the position of the mutation
+    cmaple::PositionType position;
+    /// the state of the mutation
+    cmaple::StateType state;
+    /// the bit of the mutation
+    std::uint16_t mutation_bit;
+    /// the bit of the block of positions holding the mutation
+    std::uint16_t missing_data_bit;
+  };
+
+  /**
+   Progress of the inference at the last checkpoint
+   */
+  InferenceProgress progress;
+
+  /**
+   TRUE if the tree was restored from a checkpoint whose progress has not yet
+   been resumed
+   */
+  bool resume_progress = false;
+
+  /**
+   The time when the last checkpoint was written
+   */
+  cmaple::RealNumType last_checkpoint_time = 0;
+
   /**
       Pointer  to LoadTree method
    */
@@ -438,6 +689,20 @@ class Tree {
                                                            const bool, std::ostream&);
   computeBranchSupportPtrType computeBranchSupportPtr;
 
+  /**
+      Pointer  to placeQueries method
+   */
+  typedef void (Tree::*PlaceQueriesPtrType)(std::ostream&,
+                                            const int,
+                                            std::ostream&);
+  PlaceQueriesPtrType placeQueriesPtr;
+
+  /**
+      Pointer  to removeSamples method
+   */
+  typedef void (Tree::*RemoveSamplesPtrType)(const std::vector<std::string>&);
+  RemoveSamplesPtrType removeSamplesPtr;
+
   typedef void (Tree::*MakeTreeInOutConsistentPtrType)();
   MakeTreeInOutConsistentPtrType makeTreeInOutConsistentPtr;
 
@@ -495,6 +760,18 @@ class Tree {
                                            const bool allow_replacing_ML_tree,
                                            std::ostream& out_stream);
 
+  /*! Template of placeQueries()
+   */
+  template <const cmaple::StateType num_states>
+  void placeQueriesTemplate(std::ostream& jplace_stream,
+                            const int num_threads,
+                            std::ostream& out_stream);
+
+  /*! Template of removeSamples()
+   */
+  template <const cmaple::StateType num_states>
+  void removeSamplesTemplate(const std::vector<std::string>& names);
+
   /*! Template of makeTreeInOutConsistent()
    */
   template <const cmaple::StateType num_states>
@@ -511,6 +788,22 @@ class Tree {
    */
   void setupBlengthThresh();
 
+  /**
+   Write a checkpoint (if users specify a checkpoint file) once the
+   checkpoint interval has passed since the last one. The checkpoint is first
+   written to a temporary file, which then replaces the checkpoint file, thus
+   the checkpoint file is never left incomplete.
+   @param[in] stage The current stage of the inference
+   @param[in] round The current round of tree search
+   @param[in] subround The current subround of tree search
+   @param[in] force TRUE to write the checkpoint regardless of the interval
+   @throw ios::failure if failing to write the checkpoint file
+   */
+  void writeAutoCheckpoint(const InferenceStage stage,
+                           const int32_t round = 0,
+                           const int32_t subround = -1,
+                           const bool force = false);
+
   /*! \brief Initialize tree base instance
    * @param[in] aln An alignment
    * @param[in] model A substitution model
@@ -822,11 +1115,12 @@ class Tree {
 
   /**
    Connect a new sample to a branch
+   @return the (vector) index of the new leaf
    @throw std::logic\_error if unexpected values/behaviors found during the
    operations
    */
   template <const cmaple::StateType num_states>
-  void connectNewSample2Branch(
+  cmaple::NumSeqsType connectNewSample2Branch(
       std::unique_ptr<SeqRegions>& sample,
       const cmaple::NumSeqsType seq_name_index,
       const cmaple::Index sibling_node_index,
@@ -839,17 +1133,19 @@ class Tree {
 
   /**
    Connect a new sample to root
+   @return the (vector) index of the new leaf
    @throw std::logic\_error if unexpected values/behaviors found during the
    operations
    */
   template <const cmaple::StateType num_states>
-  void connectNewSample2Root(std::unique_ptr<SeqRegions>& sample,
-                             const cmaple::NumSeqsType seq_name_index,
-                             const cmaple::Index sibling_node_index,
-                             PhyloNode& sibling_node,
-                             const cmaple::RealNumType best_root_blength,
-                             const cmaple::RealNumType best_length2,
-                             std::unique_ptr<SeqRegions>& best_parent_regions);
+  cmaple::NumSeqsType connectNewSample2Root(
+      std::unique_ptr<SeqRegions>& sample,
+      const cmaple::NumSeqsType seq_name_index,
+      const cmaple::Index sibling_node_index,
+      PhyloNode& sibling_node,
+      const cmaple::RealNumType best_root_blength,
+      const cmaple::RealNumType best_length2,
+      std::unique_ptr<SeqRegions>& best_parent_regions);
 
   /**
    Place a subtree as a descendant of a node
@@ -1201,18 +1497,197 @@ class Tree {
                         bool& topology_updated);
 
   /**
-   Create a new internal phylonode
+   Create a new internal phylonode (reusing a freed one if any)
+   @return the (vector) index of the new node
    */
-  inline void createAnInternalNode() { nodes.emplace_back(InternalNode()); }
+  inline cmaple::NumSeqsType createAnInternalNode() {
+    if (!free_internal_vec_indexes.empty()) {
+      const cmaple::NumSeqsType vec_index = free_internal_vec_indexes.back();
+      free_internal_vec_indexes.pop_back();
+      return vec_index;
+    }
+    nodes.emplace_back(InternalNode());
+    return static_cast<cmaple::NumSeqsType>(nodes.size()) - 1;
+  }
 
   /**
-   Create a new leaf phylonode
+   Create a new leaf phylonode (reusing a freed one if any)
+   @return the (vector) index of the new node
    */
-  inline void createALeafNode(const cmaple::NumSeqsType new_seq_name_index) {
+  inline cmaple::NumSeqsType createALeafNode(
+      const cmaple::NumSeqsType new_seq_name_index) {
+    if (!free_leaf_vec_indexes.empty()) {
+      const cmaple::NumSeqsType vec_index = free_leaf_vec_indexes.back();
+      free_leaf_vec_indexes.pop_back();
+      nodes[vec_index].setSeqNameIndex(new_seq_name_index);
+      indexLeafMutations(vec_index, true);
+      return vec_index;
+    }
     nodes.emplace_back(LeafNode(
         new_seq_name_index));  //(PhyloNode(std::move(LeafNode(new_seq_name_index))));
+    const cmaple::NumSeqsType vec_index =
+        static_cast<cmaple::NumSeqsType>(nodes.size()) - 1;
+    indexLeafMutations(vec_index, true);
+    return vec_index;
+  }
+
+  /**
+   Build the inverted index of the mutations carried by the leaves in the tree
+   */
+  void buildMutationIndex();
+
+  /**
+   Add (or remove) the mutations of the sequence at a leaf to (from) the
+   inverted index of mutations (if built)
+   @param[in] vec_index (vector) index of the leaf
+   @param[in] add TRUE to add the mutations, FALSE to remove them
+   */
+  void indexLeafMutations(const cmaple::NumSeqsType vec_index, const bool add);
+
+  /**
+   Build the masks of the mutations carried by the leaves below each node
+   */
+  void buildMutationMasks();
+
+  /**
+   Add the mutations of a leaf to the masks of the nodes on the path from it to
+   the root (also filling the masks of the internal nodes just created on that
+   path from their children)
+   @param[in] vec_index (vector) index of the leaf
+   */
+  void updateMutationMasks(const cmaple::NumSeqsType vec_index);
+
+  /**
+   Get the bits of the mutations (to a specific state) of a sample in the
+   masks of mutations
+   @param[in] seq_name_index index of the sample in the alignment
+   @return the mutations with their bits
+   */
+  std::vector<SampleMutationBits> getMutationMaskBits(
+      const cmaple::NumSeqsType seq_name_index) const;
+
+  /**
+   Compute an upper bound on the log likelihood contribution (when placing a
+   sample with a branch length up to max_blength) of an absent mutation of the
+   sample (see boundSamplePlacementCost())
+   @return the bound
+   */
+  cmaple::RealNumType computeAbsentMutationBound() const;
+
+  /**
+   Compute an upper bound on the placement cost of a sample anywhere in the
+   subtree below a node (or on the branch above it). Each mutation of the
+   sample contributes at most absent_mutation_bound if it is absent: (1) the
+   mask of the node has neither the mutation nor missing data at its position;
+   and (2) the upper likelihood of the node at its position is another specific
+   state (or the reference)
+   @param[in] vec_index (vector) index of the node
+   @param[in] sample_mask_bits the bits of the mutations of the sample
+   @param[in] absent_mutation_bound the bound computed by
+   computeAbsentMutationBound()
+   @return the bound
+   */
+  cmaple::RealNumType boundSamplePlacementCost(
+      const cmaple::NumSeqsType vec_index,
+      const std::vector<SampleMutationBits>& sample_mask_bits,
+      const cmaple::RealNumType absent_mutation_bound);
+
+  /**
+   Find the leaves sharing the most rare mutations with a sample
+   @param[in] seq_name_index index of the sample in the alignment
+   @return the (vector) indexes of the leaves (empty if no leaf shares any rare
+   mutations with the sample)
+   */
+  std::vector<cmaple::NumSeqsType> findRelatedLeaves(
+      const cmaple::NumSeqsType seq_name_index);
+
+  /**
+   Move the start node of a placement search a number of levels toward the root
+   (and further out of a polytomy)
+   @param[in] vec_index (vector) index of the node
+   @param[in] num_levels the number of levels
+   @return the (vector) index of the start node
+   */
+  cmaple::NumSeqsType liftPlacementStart(cmaple::NumSeqsType vec_index,
+                                         const int num_levels);
+
+  /**
+   Find a node to start seeking the placement of a sample: the most recent
+   common ancestor of the leaves sharing the most rare mutations with the
+   sample (lifted by params->failure_limit_sample levels toward the root), or
+   the root if no leaf shares any rare mutations
+   @param[in] seq_name_index index of the sample in the alignment
+   @return the index of the start node
+   */
+  cmaple::Index seekPlacementStart(const cmaple::NumSeqsType seq_name_index);
+
+  /**
+   Find a node to start seeking the placement of a sample in its parsimony
+   neighbourhood: among the leaves sharing the most rare mutations with the
+   sample, the one with the smallest parsimony distance to it (lifted by
+   params->parsimony_placement_radius levels toward the root)
+   @param[in] seq_name_index index of the sample in the alignment
+   @return the index of the start node, or an undefined index if no leaf
+   shares any rare mutations with the sample
+   */
+  cmaple::Index seekParsimonyPlacementStart(
+      const cmaple::NumSeqsType seq_name_index);
+
+  /**
+   Select the node to start seeking the placement of a sample according to
+   params->parsimony_placement_radius and params->seed_placement (the root by
+   default)
+   @param[in] seq_name_index index of the sample in the alignment
+   @param[out] max_depth the maximum depth below the start node to seek the
+   placement (-1: unlimited)
+   @return the index of the start node
+   */
+  cmaple::Index selectPlacementStart(const cmaple::NumSeqsType seq_name_index,
+                                     int& max_depth);
+
+  /**
+   Compute the order to place the samples in: the order of the alignment, or
+   (if params->cluster_placement_order) groups of similar samples one after
+   another
+   @return the indexes of the samples in the alignment
+   */
+  std::vector<cmaple::NumSeqsType> computePlacementOrder();
+
+  /**
+   Compute the MinHash of the mutations (to a specific state) of a sample:
+   two samples have the same MinHash with a probability equal to the Jaccard
+   similarity of their sets of mutations
+   @param[in] seq_name_index index of the sample in the alignment
+   @return the MinHash
+   */
+  std::uint64_t computeMutationMinHash(
+      const cmaple::NumSeqsType seq_name_index) const;
+
+  /**
+   Collect the (vector) indexes of the leaves in the tree by traversing it from
+   the root (the vector of nodes may also contain nodes detached from the tree)
+   */
+  std::vector<cmaple::NumSeqsType> collectLeafVecIndexes();
+
+  /**
+   Reset a node detached from the tree and add it to the free nodes
+   */
+  void freeNode(const cmaple::NumSeqsType vec_index);
+
+  /**
+   TRUE if a node was freed (and not yet reused), i.e., it is not in the tree
+   */
+  inline bool isFreeNode(const cmaple::NumSeqsType vec_index) const {
+    return vec_index != root_vector_index &&
+           nodes[vec_index].getNeighborIndex(TOP).getMiniIndex() == UNDEFINED;
   }
 
+  /**
+   Rebuild the lists of free nodes from the nodes (e.g., after loading a
+   checkpoint)
+   */
+  void initFreeNodes();
+
   /**
    Get partial_lh at a node by its index
    */
@@ -1432,26 +1907,20 @@ class Tree {
                      const cmaple::Index parent_index);
 
   /**
-   Read the next character from the treefile
-   */
-  const char readNextChar(std::istream& in,
-                          cmaple::PositionType& in_line,
-                          cmaple::PositionType& in_column,
-                          const char& current_ch = 0) const;
-
-  /**
-   Read string from tree file to create new nodes
+   Parse a tree in NEWICK format from a buffer and create its nodes. Clades
+   are parsed iteratively, thus very deep (e.g., caterpillar-like) trees don't
+   overflow the call stack.
+   @return The vector index of the top node
+   @throw std::invalid\_argument if the tree is in an incorrect format
    @throw std::logic\_error if any of the following situations occur.
    - any taxa in the tree is not found in the  alignment
    - unexpected values/behaviors found during the operations
    */
-  cmaple::NumSeqsType parseFile(
-      std::istream& infile,
-      char& ch,
-      cmaple::RealNumType& branch_len,
-      cmaple::PositionType& in_line,
-      cmaple::PositionType& in_column,
-      const std::map<std::string, cmaple::NumSeqsType>& map_seqname_index,
+  cmaple::NumSeqsType parseNewick(
+      const char* const buffer,
+      const char* const buffer_end,
+      const std::unordered_map<std::string_view, cmaple::NumSeqsType>&
+          map_seqname_index,
       bool& missing_blengths);
 
   /**
@@ -1461,14 +1930,15 @@ class Tree {
   void collapseAllZeroLeave();
 
   /**
-   Collapse one zero-branch-length leaf into its sibling's vector of
-   less-info-seqs
+   Collapse one zero-branch-length leaf (neighbor_2) into its sibling's
+   (neighbor_1) vector of less-info-seqs
    */
   void collapseOneZeroLeaf(PhyloNode& node,
                            cmaple::Index& node_index,
                            PhyloNode& neighbor_1,
                            const cmaple::Index neighbor_1_index,
-                           PhyloNode& neighbor_2);
+                           PhyloNode& neighbor_2,
+                           const cmaple::Index neighbor_2_index);
 
   /**
    Update the pesudocount of the model based on the sequence of a leaf
@@ -1517,15 +1987,6 @@ class Tree {
                                      const cmaple::Index node_index,
                                      const cmaple::Index parent_index);
 
-  /**
-   Export Node in Newick format
-   @throw std::invalid\_argument if show\_branch\_supports = true but branch
-   support values have yet been computed
-   */
-  std::string exportNodeString(const bool binary,
-                               const cmaple::NumSeqsType node_vec_index,
-                               const bool show_branch_supports);
-
   /**
    Read an input tree from a stream
    @return TRUE if the tree contains any branch without a length
@@ -1562,15 +2023,16 @@ class Tree {
   /**
    Initialize a mapping between sequence names and their index in the alignment
    */
-  std::map<std::string, NumSeqsType> initMapSeqNameIndex();
+  std::unordered_map<std::string_view, NumSeqsType> initMapSeqNameIndex();
 
   /**
    * Re-mark the sequences in the alignment, which already existed in the
    * current tree
    * @throw std::logic\_error if any taxa in the current tree is not found in
    * the new alignment
+   * @return TRUE if the mutations of all those sequences are unchanged
    */
-  void remarkExistingSeqs();
+  bool remarkExistingSeqs();
 
   /**
    * Find and mark a sequence existed in the tree
@@ -1583,13 +2045,21 @@ class Tree {
    */
   NumSeqsType markAnExistingSeq(
       const std::string& seq_name,
-      const std::map<std::string, NumSeqsType>& map_name_index);
+      const std::unordered_map<std::string_view, NumSeqsType>& map_name_index);
 
   /**
-   * Mark all sequences (in the alignment) as not yet added to the current tree
+   * Mark all sequences (in the alignment) as not yet added to (nor removed
+   * from) the current tree
    */
   void resetSeqAdded();
 
+  /**
+   * Register the sequences appended to the alignment (by
+   * Alignment::addSequences()) since the tree was attached to it, marking them
+   * as not yet added to the current tree
+   */
+  void registerNewSeqs();
+
   /**
    Attach alignment and model
    @throw std::invalid\_argument If the sequence type is unsupported (neither
@@ -1599,9 +2069,20 @@ class Tree {
   void attachAlnModel(Alignment* aln, ModelBase* model);
 
   /**
-   Export tree std::string in Newick format
+   Write the tree in Newick format to a stream. Nodes are traversed
+   iteratively (via their neighbor indexes) and the string is written to the
+   stream in blocks
+   @param[out] edge_nums if not null, every branch is labelled by its edge
+   number {n} (as in jplace format), the less-info-seqs of a leaf are written
+   as a multifurcation, and edge_nums[i] records the number of the branch
+   above the node nodes[i]
+   @throw std::logic\_error if show\_branch\_supports = true but branch
+   support values have yet been computed
    */
-  std::string exportNewick(const bool binary, const bool show_branch_supports);
+  void writeNewick(std::ostream& out_stream,
+                   const bool binary,
+                   const bool show_branch_supports,
+                   std::vector<cmaple::NumSeqsType>* edge_nums = nullptr);
 
   /**
    Increase the length of a 0-length branch (connecting this node to its parent)
@@ -1623,7 +2104,11 @@ class Tree {
   void updatePartialLh(std::stack<cmaple::Index>& node_stack);
 
   /**
-   Seek a position for a sample placement starting at the start_node
+   Seek a position for a sample placement starting at the start_node. The tree
+   is not changed: if the sample is less informative than an existing leaf,
+   selected_node_index is set to that leaf with the mini-index UNDEFINED
+   @param[in] max_depth the maximum depth below the start node to examine
+   (-1: unlimited)
 
    @throw std::logic\_error if unexpected values/behaviors found during the
    operations
@@ -1637,7 +2122,8 @@ class Tree {
                            bool& is_mid_branch,
                            cmaple::RealNumType& best_up_lh_diff,
                            cmaple::RealNumType& best_down_lh_diff,
-                           cmaple::Index& best_child_index);
+                           cmaple::Index& best_child_index,
+                           const int max_depth = -1);
 
   /**
    Seek a position for placing a subtree/sample starting at the start_node
@@ -1661,28 +2147,86 @@ class Tree {
 
   /**
    Place a new sample at a mid-branch point
+   @return the (vector) index of the new leaf
    @throw std::logic\_error if unexpected values/behaviors found during the
    operations
    */
   template <const cmaple::StateType num_states>
-  void placeNewSampleMidBranch(const cmaple::Index& selected_node_index,
-                               std::unique_ptr<SeqRegions>& sample,
-                               const cmaple::NumSeqsType seq_name_index,
-                               const cmaple::RealNumType best_lh_diff);
+  cmaple::NumSeqsType placeNewSampleMidBranch(
+      const cmaple::Index& selected_node_index,
+      std::unique_ptr<SeqRegions>& sample,
+      const cmaple::NumSeqsType seq_name_index,
+      const cmaple::RealNumType best_lh_diff);
 
   /**
    Place a new sample as a descendant of a node
+   @return the (vector) index of the new leaf
+   @throw std::logic\_error if unexpected values/behaviors found during the
+   operations
+   */
+  template <const cmaple::StateType num_states>
+  cmaple::NumSeqsType placeNewSampleAtNode(
+      const cmaple::Index selected_node_index,
+      std::unique_ptr<SeqRegions>& sample,
+      const cmaple::NumSeqsType seq_name_index,
+      const cmaple::RealNumType best_lh_diff,
+      const cmaple::RealNumType best_up_lh_diff,
+      const cmaple::RealNumType best_down_lh_diff,
+      const cmaple::Index best_child_index);
+
+  /**
+   Compute the position (split and branch lengths) for placing a new sample at
+   a mid-branch point without changing the tree
+   @param[out] placement the computed placement
+   @param[in] compute_lh_diff TRUE to also compute placement.lh_diff
+   @throw std::logic\_error if unexpected values/behaviors found during the
+   operations
+   */
+  template <const cmaple::StateType num_states>
+  void computePlacementMidBranch(SamplePlacement& placement,
+                                 const cmaple::Index& selected_node_index,
+                                 const std::unique_ptr<SeqRegions>& sample,
+                                 const cmaple::RealNumType best_lh_diff,
+                                 const bool compute_lh_diff = false);
+
+  /**
+   Compute the position (split and branch lengths) for placing a new sample as
+   a descendant of a node without changing the tree
+   @param[out] placement the computed placement
+   @param[in] compute_lh_diff TRUE to also compute placement.lh_diff
+   @throw std::logic\_error if unexpected values/behaviors found during the
+   operations
+   */
+  template <const cmaple::StateType num_states>
+  void computePlacementAtNode(SamplePlacement& placement,
+                              const cmaple::Index selected_node_index,
+                              const std::unique_ptr<SeqRegions>& sample,
+                              const cmaple::RealNumType best_lh_diff,
+                              const cmaple::RealNumType best_up_lh_diff,
+                              const cmaple::RealNumType best_down_lh_diff,
+                              const cmaple::Index best_child_index,
+                              const bool compute_lh_diff = false);
+
+  /**
+   Connect a new sample to the tree at a placement computed by
+   computePlacementMidBranch() or computePlacementAtNode()
+   @return the (vector) index of the new leaf
+   */
+  template <const cmaple::StateType num_states>
+  cmaple::NumSeqsType connectNewSample(
+      SamplePlacement& placement,
+      std::unique_ptr<SeqRegions>& sample,
+      const cmaple::NumSeqsType seq_name_index);
+
+  /**
+   Prune a subtree: connect its sibling to its grandparent (suppressing its
+   parent node) then update the likelihoods affected by the removal. The
+   subtree remains attached to its (detached) parent node.
    @throw std::logic\_error if unexpected values/behaviors found during the
    operations
    */
   template <const cmaple::StateType num_states>
-  void placeNewSampleAtNode(const cmaple::Index selected_node_index,
-                            std::unique_ptr<SeqRegions>& sample,
-                            const cmaple::NumSeqsType seq_name_index,
-                            const cmaple::RealNumType best_lh_diff,
-                            const cmaple::RealNumType best_up_lh_diff,
-                            const cmaple::RealNumType best_down_lh_diff,
-                            const cmaple::Index best_child_index);
+  void pruneSubTree(PhyloNode& subtree);
 
   /**
    Apply a single SPR move
@@ -2020,7 +2564,8 @@ void cmaple::Tree::seekSamplePlacement(
     bool& is_mid_branch,
     RealNumType& best_up_lh_diff,
     RealNumType& best_down_lh_diff,
-    Index& best_child_index) {
+    Index& best_child_index,
+    const int max_depth) {
   assert(sample_regions && sample_regions->size() > 0);
   assert(seq_name_index >= 0);
   assert(aln);
@@ -2034,16 +2579,39 @@ void cmaple::Tree::seekSamplePlacement(
   RealNumType lh_diff_mid_branch = 0;
   RealNumType lh_diff_at_node = 0;
   PositionType seq_length = static_cast<PositionType>(aln->ref_seq.size());
-  // stack of nodes to examine positions
+  // stack of nodes to examine positions (and their depths below the start
+  // node)
   std::stack<TraversingNode> extended_node_stack;
   extended_node_stack.push(TraversingNode(start_node_index, 0, MIN_NEGATIVE));
+  std::stack<int> depth_stack;
+  depth_stack.push(0);
+
+  // the bits of the mutations of the sample, to bound its placement costs
+  // within subtrees
+  const bool bound_placement = params->bound_placement;
+  std::vector<SampleMutationBits> sample_mask_bits;
+  RealNumType absent_mutation_bound = 0;
+  if (bound_placement) {
+    sample_mask_bits = getMutationMaskBits(seq_name_index);
+    absent_mutation_bound = computeAbsentMutationBound();
+  }
 
   // recursively examine positions for placing the new sample
   while (!extended_node_stack.empty()) {
     TraversingNode current_extended_node = std::move(extended_node_stack.top());
     extended_node_stack.pop();
+    const int depth = depth_stack.top();
+    depth_stack.pop();
     const NumSeqsType current_node_vec =
         current_extended_node.getIndex().getVectorIndex();
+
+    // skip the subtree if no placement within it can beat the best one so far
+    if (bound_placement &&
+        boundSamplePlacementCost(current_node_vec, sample_mask_bits,
+                                 absent_mutation_bound) <= best_lh_diff) {
+      continue;
+    }
+
     PhyloNode& current_node = nodes[current_node_vec];
     const bool& is_internal = current_node.isInternal();
 
@@ -2062,8 +2630,7 @@ void cmaple::Tree::seekSamplePlacement(
     if ((!is_internal) &&
         (current_node.getPartialLh(TOP)->compareWithSample(
              *sample_regions, seq_length, aln) == 1)) {
-      current_node.addLessInfoSeqs(seq_name_index);
-      selected_node_index = Index();
+      selected_node_index = Index(current_node_vec, UNDEFINED);
       return;
     }
 
@@ -2106,13 +2673,24 @@ void cmaple::Tree::seekSamplePlacement(
       /*for (Index neighbor_index:current_node.getNeighborIndexes(TOP))
           extended_node_stack.push(TraversingNode(neighbor_index,
          current_extended_node.getFailureCount(), lh_diff_at_node));*/
-      if (is_internal) {
+      if (is_internal && depth != max_depth) {
         extended_node_stack.push(
             TraversingNode(current_node.getNeighborIndex(RIGHT), failure_count,
                            lh_diff_at_node));
         extended_node_stack.push(
             TraversingNode(current_node.getNeighborIndex(LEFT), failure_count,
                            lh_diff_at_node));
+        // the children in a polytomy are as deep as their parent
+        depth_stack.push(nodes[current_node.getNeighborIndex(RIGHT)
+                                   .getVectorIndex()]
+                                     .getUpperLength() > 0
+                             ? depth + 1
+                             : depth);
+        depth_stack.push(nodes[current_node.getNeighborIndex(LEFT)
+                                   .getVectorIndex()]
+                                     .getUpperLength() > 0
+                             ? depth + 1
+                             : depth);
       }
     }
   }
@@ -2134,13 +2712,32 @@ void cmaple::Tree::seekSamplePlacement(
 }
 
 template <const StateType num_states>
-void cmaple::Tree::placeNewSampleAtNode(const Index selected_node_index,
+auto cmaple::Tree::placeNewSampleAtNode(const Index selected_node_index,
                                         std::unique_ptr<SeqRegions>& sample,
                                         const NumSeqsType seq_name_index,
                                         const RealNumType best_lh_diff,
                                         const RealNumType best_up_lh_diff,
                                         const RealNumType best_down_lh_diff,
-                                        const Index best_child_index) {
+                                        const Index best_child_index)
+    -> NumSeqsType {
+  assert(seq_name_index >= 0);
+
+  SamplePlacement placement;
+  computePlacementAtNode<num_states>(placement, selected_node_index, sample,
+                                     best_lh_diff, best_up_lh_diff,
+                                     best_down_lh_diff, best_child_index);
+  return connectNewSample<num_states>(placement, sample, seq_name_index);
+}
+
+template <const StateType num_states>
+void cmaple::Tree::computePlacementAtNode(SamplePlacement& placement,
+                                          const Index selected_node_index,
+                                          const std::unique_ptr<SeqRegions>& sample,
+                                          const RealNumType best_lh_diff,
+                                          const RealNumType best_up_lh_diff,
+                                          const RealNumType best_down_lh_diff,
+                                          const Index best_child_index,
+                                          const bool compute_lh_diff) {
   // dummy variables
   RealNumType best_child_lh = MIN_NEGATIVE;
   RealNumType best_child_blength_split = 0;
@@ -2153,7 +2750,6 @@ void cmaple::Tree::placeNewSampleAtNode(const Index selected_node_index,
 
   assert(selected_node_index.getMiniIndex() == TOP);
   assert(sample && sample->size() > 0);
-  assert(seq_name_index >= 0);
   assert(aln);
   assert(model);
   assert(cumulative_rate);
@@ -2269,10 +2865,6 @@ void cmaple::Tree::placeNewSampleAtNode(const Index selected_node_index,
   if (best_child_lh >= best_parent_lh && best_child_lh >= best_lh_diff) {
     assert(best_child_index.getMiniIndex() == TOP);
     PhyloNode& best_child = nodes[best_child_index.getVectorIndex()];
-    const std::unique_ptr<SeqRegions>& upper_left_right_regions =
-        getPartialLhAtNode(best_child.getNeighborIndex(
-            TOP));  // best_child->neighbor->getPartialLhAtNode(aln,
-                    // model, threshold_prob);
 
     // Estimate the length for the new branch
     RealNumType best_length = default_blength;
@@ -2282,14 +2874,13 @@ void cmaple::Tree::placeNewSampleAtNode(const Index selected_node_index,
         min_blength, false);
 
     // create new internal node and append child to it
-    // connectNewSample2Branch(sample, seq_name_index, best_child,
-    // best_child_blength_split, best_child->length - best_child_blength_split,
-    // best_length, best_child_regions, upper_left_right_regions);
-    connectNewSample2Branch<num_states>(
-        sample, seq_name_index, best_child_index, best_child,
-        best_child_blength_split,
-        best_child.getUpperLength() - best_child_blength_split, best_length,
-        best_child_regions, upper_left_right_regions);
+    placement.sibling_index = best_child_index;
+    placement.at_root = false;
+    placement.top_distance = best_child_blength_split;
+    placement.down_distance =
+        best_child.getUpperLength() - best_child_blength_split;
+    placement.blength = best_length;
+    placement.regions = std::move(best_child_regions);
   }
   // otherwise, add new parent to the selected_node
   else {
@@ -2335,17 +2926,16 @@ void cmaple::Tree::placeNewSampleAtNode(const Index selected_node_index,
       best_parent_lh -= old_root_lh;
 
       // add new sample to a new root
-      connectNewSample2Root<num_states>(
-          sample, seq_name_index, selected_node_index, selected_node,
-          best_root_blength, best_length2, best_parent_regions);
+      placement.sibling_index = selected_node_index;
+      placement.at_root = true;
+      placement.top_distance = 0;
+      placement.down_distance = best_root_blength;
+      placement.blength = best_length2;
+      placement.regions = std::move(best_parent_regions);
+      placement.lh_diff = best_parent_lh;
     }
     // add parent to non-root node
     else {
-      const std::unique_ptr<SeqRegions>& upper_left_right_regions =
-          getPartialLhAtNode(selected_node.getNeighborIndex(
-              TOP));  // selected_node->neighbor->getPartialLhAtNode(aln,
-                      // model, threshold_prob);
-
       // now try different lengths for the new branch
       RealNumType best_length = default_blength;
       estimateLengthNewBranch<
@@ -2362,36 +2952,45 @@ void cmaple::Tree::placeNewSampleAtNode(const Index selected_node_index,
         down_distance = -1;
         top_distance =
             selected_node.getUpperLength();  // selected_node->length;
-
-        /*if (selected_node->total_lh) delete selected_node->total_lh;
-        selected_node->total_lh = NULL;
-
-        if (selected_node->mid_branch_lh) delete selected_node->mid_branch_lh;
-        selected_node->mid_branch_lh = NULL;*/
-        selected_node.setTotalLh(nullptr);
-        selected_node.setMidBranchLh(nullptr);
-
-        // node.furtherMidNodes=None
       }
-      connectNewSample2Branch<num_states>(
-          sample, seq_name_index, selected_node_index, selected_node,
-          top_distance, down_distance, best_length, best_parent_regions,
-          upper_left_right_regions);
+      placement.sibling_index = selected_node_index;
+      placement.at_root = false;
+      placement.top_distance = top_distance;
+      placement.down_distance = down_distance;
+      placement.blength = best_length;
+      placement.regions = std::move(best_parent_regions);
     }
   }
 
-  // delete best_parent_regions and best_child_regions
-  /*if (best_parent_regions)
-      delete best_parent_regions;
-  if (best_child_regions)
-      delete best_child_regions;*/
+  // compute the placement cost with the estimated length of the new branch
+  // (it was already computed if the new sample becomes a sibling of the root)
+  if (compute_lh_diff && !placement.at_root) {
+    placement.lh_diff = calculateSamplePlacementCost<num_states>(
+        placement.regions, sample, placement.blength);
+  }
 }
 
 template <const StateType num_states>
-void cmaple::Tree::placeNewSampleMidBranch(const Index& selected_node_index,
+auto cmaple::Tree::placeNewSampleMidBranch(const Index& selected_node_index,
                                            std::unique_ptr<SeqRegions>& sample,
                                            const NumSeqsType seq_name_index,
-                                           const RealNumType best_lh_diff) {
+                                           const RealNumType best_lh_diff)
+    -> NumSeqsType {
+  assert(seq_name_index >= 0);
+
+  SamplePlacement placement;
+  computePlacementMidBranch<num_states>(placement, selected_node_index, sample,
+                                        best_lh_diff);
+  return connectNewSample<num_states>(placement, sample, seq_name_index);
+}
+
+template <const StateType num_states>
+void cmaple::Tree::computePlacementMidBranch(
+    SamplePlacement& placement,
+    const Index& selected_node_index,
+    const std::unique_ptr<SeqRegions>& sample,
+    const RealNumType best_lh_diff,
+    const bool compute_lh_diff) {
   // dummy variables
   // const RealNumType threshold_prob = params->threshold_prob;
   std::unique_ptr<SeqRegions> best_child_regions = nullptr;
@@ -2401,7 +3000,6 @@ void cmaple::Tree::placeNewSampleMidBranch(const Index& selected_node_index,
   // selected_node_index.getMiniIndex();
   assert(selected_node_index.getMiniIndex() == TOP);
   assert(sample && sample->size() > 0);
-  assert(seq_name_index >= 0);
   assert(aln);
   assert(model);
   assert(cumulative_rate);
@@ -2454,11 +3052,54 @@ void cmaple::Tree::placeNewSampleMidBranch(const Index& selected_node_index,
       min_blength, false);
 
   // create new internal node and append child to it
-  connectNewSample2Branch<num_states>(
-      sample, seq_name_index, selected_node_index, selected_node,
-      best_branch_length_split,
-      selected_node_blength - best_branch_length_split, best_blength,
-      best_child_regions, upper_left_right_regions);
+  placement.sibling_index = selected_node_index;
+  placement.at_root = false;
+  placement.top_distance = best_branch_length_split;
+  placement.down_distance = selected_node_blength - best_branch_length_split;
+  placement.blength = best_blength;
+  placement.regions = std::move(best_child_regions);
+
+  // compute the placement cost with the estimated length of the new branch
+  if (compute_lh_diff) {
+    placement.lh_diff = calculateSamplePlacementCost<num_states>(
+        placement.regions, sample, placement.blength);
+  }
+}
+
+template <const StateType num_states>
+auto cmaple::Tree::connectNewSample(SamplePlacement& placement,
+                                    std::unique_ptr<SeqRegions>& sample,
+                                    const NumSeqsType seq_name_index)
+    -> NumSeqsType {
+  PhyloNode& sibling_node = nodes[placement.sibling_index.getVectorIndex()];
+
+  // add new sample to a new root
+  if (placement.at_root) {
+    return connectNewSample2Root<num_states>(
+        sample, seq_name_index, placement.sibling_index, sibling_node,
+        placement.down_distance, placement.blength, placement.regions);
+  }
+
+  // the new sample is attached exactly at the sibling node
+  if (placement.down_distance < 0) {
+    /*if (selected_node->total_lh) delete selected_node->total_lh;
+    selected_node->total_lh = NULL;
+
+    if (selected_node->mid_branch_lh) delete selected_node->mid_branch_lh;
+    selected_node->mid_branch_lh = NULL;*/
+    sibling_node.setTotalLh(nullptr);
+    sibling_node.setMidBranchLh(nullptr);
+
+    // node.furtherMidNodes=None
+  }
+
+  // create new internal node and append child to it
+  const std::unique_ptr<SeqRegions>& upper_left_right_regions =
+      getPartialLhAtNode(sibling_node.getNeighborIndex(TOP));
+  return connectNewSample2Branch<num_states>(
+      sample, seq_name_index, placement.sibling_index, sibling_node,
+      placement.top_distance, placement.down_distance, placement.blength,
+      placement.regions, upper_left_right_regions);
 }
 /*! \endcond */
 }  // namespace cmaple
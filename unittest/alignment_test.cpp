@@ -1,7 +1,47 @@
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <zlib.h>
 #include "gtest/gtest.h"
 #include "../alignment/alignment.h"
 using namespace cmaple;
 
+/*
+ Compress a file into BGZF blocks (each holding block_size bytes at most)
+ */
+void writeBgzfFile(const std::string& in_path, const std::string& out_path, const size_t block_size)
+{
+    std::ifstream in(in_path, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream out(out_path, std::ios::binary);
+    const auto write_uint = [&out](const uint32_t value, const int num_bytes)
+    {
+        for (int i = 0; i < num_bytes; ++i)
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    };
+    for (size_t start = 0; start < content.size(); start += block_size)
+    {
+        const size_t length = std::min(block_size, content.size() - start);
+        std::string cdata(compressBound(static_cast<uLong>(length)) + 16, '\0');
+        z_stream zs{};
+        ASSERT_EQ(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY), Z_OK);
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data() + start));
+        zs.avail_in = static_cast<uInt>(length);
+        zs.next_out = reinterpret_cast<Bytef*>(cdata.data());
+        zs.avail_out = static_cast<uInt>(cdata.size());
+        ASSERT_EQ(deflate(&zs, Z_FINISH), Z_STREAM_END);
+        cdata.resize(zs.total_out);
+        deflateEnd(&zs);
+        
+        // header with the 'BC' subfield, compressed data, then crc and size
+        out.write("\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0", 16);
+        write_uint(static_cast<uint32_t>(cdata.size() + 25), 2);
+        out.write(cdata.data(), static_cast<std::streamsize>(cdata.size()));
+        write_uint(static_cast<uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(content.data() + start), static_cast<uInt>(length))), 4);
+        write_uint(static_cast<uint32_t>(length), 4);
+    }
+}
+
 /*
  Test read() and generateRef()
  */
@@ -257,6 +297,357 @@ TEST(Alignment, readMapleFile)
     EXPECT_THROW(aln.read(example_dir + "input.fa", "", cmaple::Alignment::IN_MAPLE), std::invalid_argument);
 }
 
+/*
+ Test write() and read() in the binary format
+ */
+TEST(Alignment, binaryFormat)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+    
+    Alignment aln(example_dir + "test_100.maple");
+    const std::string bin_file_path = example_dir + "test_100.out.bin";
+    aln.write(bin_file_path, cmaple::Alignment::IN_BINARY, true);
+    
+    // read the whole alignment (from a file and from a stream)
+    Alignment bin_aln(bin_file_path);
+    std::ifstream bin_stream(bin_file_path, std::ios::binary);
+    Alignment stream_aln(bin_stream);
+    EXPECT_EQ(bin_aln.aln_format, cmaple::Alignment::IN_BINARY);
+    EXPECT_EQ(stream_aln.aln_format, cmaple::Alignment::IN_BINARY);
+    EXPECT_EQ(bin_aln.getSeqType(), aln.getSeqType());
+    EXPECT_EQ(bin_aln.ref_seq, aln.ref_seq);
+    EXPECT_EQ(stream_aln.ref_seq, aln.ref_seq);
+    ASSERT_EQ(bin_aln.data.size(), aln.data.size());
+    ASSERT_EQ(stream_aln.data.size(), aln.data.size());
+    for (size_t i = 0; i < aln.data.size(); ++i)
+    {
+        // keep the sorted order
+        EXPECT_EQ(bin_aln.data[i].seq_name, aln.data[i].seq_name);
+        EXPECT_EQ(stream_aln.data[i].seq_name, aln.data[i].seq_name);
+        ASSERT_EQ(bin_aln.data[i].size(), aln.data[i].size());
+        for (size_t j = 0; j < aln.data[i].size(); ++j)
+        {
+            EXPECT_EQ(bin_aln.data[i][j].type, aln.data[i][j].type);
+            EXPECT_EQ(bin_aln.data[i][j].position, aln.data[i][j].position);
+            EXPECT_EQ(bin_aln.data[i][j].getLength(), aln.data[i][j].getLength());
+        }
+    }
+    
+    // random access to a single sequence
+    Sequence sequence = Alignment::readBinarySequence(bin_file_path, 66);
+    EXPECT_EQ(sequence.seq_name, aln.data[66].seq_name);
+    ASSERT_EQ(sequence.size(), aln.data[66].size());
+    EXPECT_EQ(sequence[4].position, aln.data[66][4].position);
+    EXPECT_THROW(Alignment::readBinarySequence(bin_file_path, 100), std::invalid_argument);
+    EXPECT_THROW(Alignment::readBinarySequence(example_dir + "test_100.maple", 0), std::invalid_argument);
+    
+    // corrupted files are rejected
+    std::ifstream in(bin_file_path, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    const auto corrupt = [&](const size_t offset, const uint64_t value, const size_t num_bytes)
+    {
+        std::string corrupted(content);
+        memcpy(&corrupted[offset], &value, num_bytes);
+        std::stringstream corrupted_stream(corrupted);
+        Alignment corrupted_aln;
+        EXPECT_THROW(corrupted_aln.read(corrupted_stream), std::invalid_argument);
+    };
+    // an unknown sequence type
+    corrupt(20, 7, 4);
+    // a number of mutations causing an overflow when computing the size
+    corrupt(40, (std::numeric_limits<uint64_t>::max)() / 8 + 2, 8);
+    // a mutation out of the reference sequence
+    uint64_t mutations_offset = 0;
+    memcpy(&mutations_offset, &content[72], sizeof(mutations_offset));
+    corrupt(mutations_offset, aln.ref_seq.size(), 4);
+    
+    std::remove(bin_file_path.c_str());
+}
+
+/*
+ Test reading a FASTA file in two passes (streaming) against the PHYLIP reader
+ */
+TEST(Alignment, readFastaStreaming)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+    
+    // input.fa and input.phy contain the same alignment
+    Alignment fasta_aln(example_dir + "input.fa");
+    Alignment phylip_aln(example_dir + "input.phy");
+    
+    EXPECT_EQ(fasta_aln.getSeqType(), phylip_aln.getSeqType());
+    EXPECT_EQ(fasta_aln.ref_seq, phylip_aln.ref_seq);
+    ASSERT_EQ(fasta_aln.data.size(), phylip_aln.data.size());
+    for (size_t i = 0; i < fasta_aln.data.size(); ++i)
+    {
+        EXPECT_EQ(fasta_aln.data[i].seq_name, phylip_aln.data[i].seq_name);
+        ASSERT_EQ(fasta_aln.data[i].size(), phylip_aln.data[i].size());
+        for (size_t j = 0; j < fasta_aln.data[i].size(); ++j)
+        {
+            EXPECT_EQ(fasta_aln.data[i][j].type, phylip_aln.data[i][j].type);
+            EXPECT_EQ(fasta_aln.data[i][j].position, phylip_aln.data[i][j].position);
+            EXPECT_EQ(fasta_aln.data[i][j].getLength(), phylip_aln.data[i][j].getLength());
+        }
+    }
+    
+    // with a given reference sequence
+    std::string ref_seq = fasta_aln.readRefSeq(example_dir + "ref.fa", "REF");
+    fasta_aln.read(example_dir + "input.fa", ref_seq);
+    phylip_aln.read(example_dir + "input.phy", ref_seq);
+    EXPECT_EQ(fasta_aln.ref_seq, phylip_aln.ref_seq);
+    ASSERT_EQ(fasta_aln.data.size(), phylip_aln.data.size());
+    for (size_t i = 0; i < fasta_aln.data.size(); ++i)
+    {
+        EXPECT_EQ(fasta_aln.data[i].seq_name, phylip_aln.data[i].seq_name);
+        EXPECT_EQ(fasta_aln.data[i].size(), phylip_aln.data[i].size());
+    }
+    
+    // the reference takes the first character reaching half of the number of sequences at each site, which may
+    // not be the most frequent one
+    std::istringstream tie_fasta_stream(">s1\nAAGT\n>s2\nACGT\n>s3\nCCTG\n>s4\nCATG\n>s5\nCATT\n");
+    std::istringstream tie_phylip_stream("5 4\ns1 AAGT\ns2 ACGT\ns3 CCTG\ns4 CATG\ns5 CATT\n");
+    Alignment tie_fasta_aln(tie_fasta_stream);
+    Alignment tie_phylip_aln(tie_phylip_stream);
+    EXPECT_EQ(tie_fasta_aln.ref_seq, std::vector<StateType>({0, 1, 2, 3}));
+    EXPECT_EQ(tie_fasta_aln.ref_seq, tie_phylip_aln.ref_seq);
+}
+
+/*
+ Test reading a MAPLE file via the memory-mapped reader against the stream reader
+ */
+TEST(Alignment, readMappedMaple)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+    
+    // test_5K.maple is larger than MAPLE_CHUNK_SIZE -> parsed in several chunks
+    for (const std::string filename : {"test_100.maple", "test_5K.maple"})
+    {
+        Alignment mapped_aln(example_dir + filename);
+        
+        std::ifstream aln_stream(example_dir + filename);
+        Alignment stream_aln(aln_stream);
+        
+        EXPECT_EQ(mapped_aln.ref_seq, stream_aln.ref_seq);
+        ASSERT_EQ(mapped_aln.data.size(), stream_aln.data.size());
+        for (size_t i = 0; i < mapped_aln.data.size(); ++i)
+        {
+            EXPECT_EQ(mapped_aln.data[i].seq_name, stream_aln.data[i].seq_name);
+            ASSERT_EQ(mapped_aln.data[i].size(), stream_aln.data[i].size());
+            for (size_t j = 0; j < mapped_aln.data[i].size(); ++j)
+            {
+                EXPECT_EQ(mapped_aln.data[i][j].type, stream_aln.data[i][j].type);
+                EXPECT_EQ(mapped_aln.data[i][j].position, stream_aln.data[i][j].position);
+                EXPECT_EQ(mapped_aln.data[i][j].getLength(), stream_aln.data[i][j].getLength());
+            }
+        }
+    }
+}
+
+/*
+ Test reading an alignment in VCF format
+ */
+TEST(Alignment, readVcf)
+{
+    const std::string ref_seq = "ACGTACGTAC";
+    const std::string vcf_str = "##fileformat=VCFv4.2\n"
+        "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\ts1\ts2\ts3\ts4\n"
+        "chr\t2\t.\tC\tT\t.\tPASS\t.\tGT\t1\t0\t.\t0/1\n"
+        "chr\t3\t.\tG\tA\t.\tPASS\t.\tGT\t0\t0\t.\t0\n"
+        "chr\t4\t.\tTAC\tT\t.\tPASS\t.\tGT:DP\t1:10\t0:5\t0:3\t1|1\n"
+        "chr\t5\t.\tA\tG,*\t.\tPASS\t.\tGT\t0\t1\t2\t0\n"
+        "chr\t8\t.\tT\tTAA,G\t.\tPASS\t.\tGT\t./.\t1\t2\t0\n";
+    std::istringstream vcf_stream(vcf_str);
+    Alignment aln(vcf_stream, ref_seq);
+    EXPECT_EQ(aln.aln_format, cmaple::Alignment::IN_VCF);
+    EXPECT_EQ(aln.getSeqType(), cmaple::SeqRegion::SEQ_DNA);
+    EXPECT_EQ(aln.ref_seq.size(), ref_seq.size());
+    ASSERT_EQ(aln.data.size(), 4);
+    
+    // sequences are sorted after reading -> find them by names
+    std::map<std::string, Sequence*> sequences;
+    for (Sequence& sequence : aln.data)
+        sequences[sequence.seq_name] = &sequence;
+    
+    // a substitution, a deletion, and missing data
+    const Sequence& s1 = *sequences["s1"];
+    ASSERT_EQ(s1.size(), 3);
+    EXPECT_EQ(s1[0].type, 3);
+    EXPECT_EQ(s1[0].position, 1);
+    EXPECT_EQ(s1[1].type, TYPE_DEL);
+    EXPECT_EQ(s1[1].position, 4);
+    EXPECT_EQ(s1[1].getLength(), 2);
+    EXPECT_EQ(s1[2].type, TYPE_N);
+    EXPECT_EQ(s1[2].position, 7);
+    
+    // the second ALT allele; insertions are ignored
+    const Sequence& s2 = *sequences["s2"];
+    ASSERT_EQ(s2.size(), 1);
+    EXPECT_EQ(s2[0].type, 2);
+    EXPECT_EQ(s2[0].position, 4);
+    
+    // consecutive missing sites are merged; a spanning deletion is ignored
+    const Sequence& s3 = *sequences["s3"];
+    ASSERT_EQ(s3.size(), 2);
+    EXPECT_EQ(s3[0].type, TYPE_N);
+    EXPECT_EQ(s3[0].position, 1);
+    EXPECT_EQ(s3[0].getLength(), 2);
+    EXPECT_EQ(s3[1].type, 2);
+    EXPECT_EQ(s3[1].position, 7);
+    
+    // a heterozygous call -> an ambiguous state (Y)
+    const Sequence& s4 = *sequences["s4"];
+    ASSERT_EQ(s4.size(), 2);
+    EXPECT_EQ(s4[0].type, 2+8+3);
+    EXPECT_EQ(s4[0].position, 1);
+    EXPECT_EQ(s4[1].type, TYPE_DEL);
+    EXPECT_EQ(s4[1].position, 4);
+    
+    // incorrect inputs
+    std::istringstream no_ref_stream(vcf_str);
+    EXPECT_THROW(aln.read(no_ref_stream), std::invalid_argument);
+    std::istringstream wrong_ref_stream(vcf_str);
+    EXPECT_THROW(aln.read(wrong_ref_stream, "AAAAAAAAAA"), std::invalid_argument);
+    std::istringstream unsorted_stream(vcf_str + "chr\t3\t.\tG\tA\t.\tPASS\t.\tGT\t0\t0\t0\t0\n");
+    EXPECT_THROW(aln.read(unsorted_stream, ref_seq), std::invalid_argument);
+    std::istringstream missing_sample_stream(vcf_str + "chr\t9\t.\tA\tC\t.\tPASS\t.\tGT\t0\t0\t0\n");
+    EXPECT_THROW(aln.read(missing_sample_stream, ref_seq), std::invalid_argument);
+    std::istringstream extra_sample_stream(vcf_str + "chr\t9\t.\tA\tC\t.\tPASS\t.\tGT\t0\t0\t0\t0\t1\n");
+    EXPECT_THROW(aln.read(extra_sample_stream, ref_seq), std::invalid_argument);
+    std::istringstream invalid_gt_stream(vcf_str + "chr\t9\t.\tA\tC\t.\tPASS\t.\tGT\t0\t0\t0\t2\n");
+    EXPECT_THROW(aln.read(invalid_gt_stream, ref_seq), std::invalid_argument);
+    std::istringstream multi_chrom_stream(vcf_str + "chr2\t9\t.\tA\tC\t.\tPASS\t.\tGT\t0\t0\t0\t1\n");
+    EXPECT_THROW(aln.read(multi_chrom_stream, ref_seq), std::invalid_argument);
+}
+
+/*
+ Test constructing an alignment from sequences in memory
+ */
+TEST(Alignment, readSequencesInMemory)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+    
+    // the reference sequence is in the second line of the MAPLE file
+    std::ifstream maple_stream(example_dir + "test_100.maple");
+    std::string ref_seq;
+    std::getline(maple_stream, ref_seq);
+    std::getline(maple_stream, ref_seq);
+    
+    // copy the sequences of an alignment read from the MAPLE file
+    Alignment aln(example_dir + "test_100.maple");
+    const auto copySequences = [&aln]() {
+        std::vector<Sequence> sequences;
+        for (const Sequence& sequence : aln.data)
+            sequences.emplace_back(std::string(sequence.seq_name), std::vector<Mutation>(sequence.begin(), sequence.end()));
+        return sequences;
+    };
+    
+    Alignment mem_aln(copySequences(), ref_seq);
+    EXPECT_EQ(mem_aln.getSeqType(), aln.getSeqType());
+    EXPECT_EQ(mem_aln.ref_seq, aln.ref_seq);
+    ASSERT_EQ(mem_aln.data.size(), aln.data.size());
+    std::map<std::string, Sequence*> sequences_by_name;
+    for (Sequence& sequence : aln.data)
+        sequences_by_name[sequence.seq_name] = &sequence;
+    for (const Sequence& sequence : mem_aln.data)
+    {
+        ASSERT_TRUE(sequences_by_name.count(sequence.seq_name));
+        const Sequence& expected_sequence = *sequences_by_name[sequence.seq_name];
+        ASSERT_EQ(sequence.size(), expected_sequence.size());
+        for (size_t j = 0; j < sequence.size(); ++j)
+        {
+            EXPECT_EQ(sequence[j].type, expected_sequence[j].type);
+            EXPECT_EQ(sequence[j].position, expected_sequence[j].position);
+            EXPECT_EQ(sequence[j].getLength(), expected_sequence[j].getLength());
+        }
+    }
+    
+    // invalid inputs
+    EXPECT_THROW(mem_aln.read(copySequences(), ""), std::invalid_argument);
+    std::vector<Sequence> sequences = copySequences();
+    sequences.resize(2);
+    EXPECT_THROW(mem_aln.read(std::move(sequences), ref_seq), std::invalid_argument);
+    sequences = copySequences();
+    sequences[1].seq_name = sequences[0].seq_name;
+    EXPECT_THROW(mem_aln.read(std::move(sequences), ref_seq), std::invalid_argument);
+    sequences = copySequences();
+    sequences[0].emplace_back(0, static_cast<PositionType>(ref_seq.length()));
+    EXPECT_THROW(mem_aln.read(std::move(sequences), ref_seq), std::invalid_argument);
+    sequences = copySequences();
+    sequences[0].emplace(sequences[0].begin(), 0, 100000);
+    EXPECT_THROW(mem_aln.read(std::move(sequences), ref_seq), std::invalid_argument);
+    sequences = copySequences();
+    sequences[0].emplace(sequences[0].begin(), 1 + 3, 0);
+    EXPECT_THROW(mem_aln.read(std::move(sequences), ref_seq), std::invalid_argument);
+}
+
+/*
+ Test addSequences()
+ */
+TEST(Alignment, addSequences)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+    
+    Alignment aln(example_dir + "test_100.maple");
+    const std::vector<Sequence>::size_type num_seqs = aln.data.size();
+    
+    // adding no sequences changes nothing
+    std::vector<Sequence> sequences;
+    aln.addSequences(std::move(sequences));
+    EXPECT_EQ(aln.data.size(), num_seqs);
+    
+    // invalid inputs, which leave the alignment unchanged
+    sequences.clear();
+    sequences.emplace_back(std::string(aln.data[0].seq_name), std::vector<Mutation>());
+    EXPECT_THROW(aln.addSequences(std::move(sequences)), std::invalid_argument);
+    sequences.clear();
+    sequences.emplace_back(std::string("new_1"), std::vector<Mutation>());
+    sequences.emplace_back(std::string("new_1"), std::vector<Mutation>());
+    EXPECT_THROW(aln.addSequences(std::move(sequences)), std::invalid_argument);
+    sequences.clear();
+    sequences.emplace_back(std::string("new_1"), std::vector<Mutation>{Mutation(0, static_cast<PositionType>(aln.ref_seq.size()))});
+    EXPECT_THROW(aln.addSequences(std::move(sequences)), std::invalid_argument);
+    std::istringstream no_record_stream("a\t100\n");
+    EXPECT_THROW(aln.addSequences(no_record_stream), std::invalid_argument);
+    std::istringstream invalid_record_stream(">new_1\na\t0\n");
+    EXPECT_THROW(aln.addSequences(invalid_record_stream), std::invalid_argument);
+    EXPECT_EQ(aln.data.size(), num_seqs);
+    
+    // valid inputs
+    sequences.clear();
+    sequences.emplace_back(std::string("new_1"), std::vector<Mutation>{Mutation(0, 100)});
+    aln.addSequences(std::move(sequences));
+    std::istringstream records_stream(">new_2\nc\t200\nn\t300\t5\n>new_3\n");
+    aln.addSequences(records_stream);
+    ASSERT_EQ(aln.data.size(), num_seqs + 3);
+    EXPECT_EQ(aln.data[num_seqs].seq_name, "new_1");
+    EXPECT_EQ(aln.data[num_seqs + 1].seq_name, "new_2");
+    ASSERT_EQ(aln.data[num_seqs + 1].size(), 2);
+    EXPECT_EQ(aln.data[num_seqs + 1][0].position, 199);
+    EXPECT_EQ(aln.data[num_seqs + 1][1].getLength(), 5);
+    EXPECT_EQ(aln.data[num_seqs + 2].seq_name, "new_3");
+    EXPECT_EQ(aln.data[num_seqs + 2].size(), 0);
+    
+    // the new names must not collide with the existing ones
+    std::istringstream duplicate_stream(">new_3\n");
+    EXPECT_THROW(aln.addSequences(duplicate_stream), std::invalid_argument);
+}
+
 /*
  Test write()
  */
@@ -306,6 +697,57 @@ TEST(Alignment, write)
     // ----- Test write() with an empty input
     EXPECT_THROW(aln.write(""), std::invalid_argument);
     
+    // ----- Test write() and read() with gzip-compressed files
+    for (const cmaple::Alignment::InputType format : {cmaple::Alignment::IN_MAPLE, cmaple::Alignment::IN_FASTA, cmaple::Alignment::IN_PHYLIP})
+    {
+        const std::string file_path = example_dir + "input.phy.out";
+        const std::string gz_file_path = file_path + ".gz";
+        aln.read(example_dir + "input.phy");
+        aln.write(file_path, format, true);
+        aln.write(gz_file_path, format, true);
+        EXPECT_FALSE(isGzipFile(file_path));
+        EXPECT_TRUE(isGzipFile(gz_file_path));
+        
+        Alignment plain_aln(file_path);
+        Alignment gz_aln(gz_file_path);
+        EXPECT_EQ(gz_aln.aln_format, format);
+        EXPECT_EQ(gz_aln.ref_seq, plain_aln.ref_seq);
+        ASSERT_EQ(gz_aln.data.size(), plain_aln.data.size());
+        for (size_t i = 0; i < gz_aln.data.size(); ++i)
+        {
+            EXPECT_EQ(gz_aln.data[i].seq_name, plain_aln.data[i].seq_name);
+            EXPECT_EQ(gz_aln.data[i].size(), plain_aln.data[i].size());
+        }
+        std::remove(file_path.c_str());
+        std::remove(gz_file_path.c_str());
+    }
+    
+    // ----- Test read() with BGZF files (parsed in memory)
+    for (const cmaple::Alignment::InputType format : {cmaple::Alignment::IN_MAPLE, cmaple::Alignment::IN_FASTA, cmaple::Alignment::IN_BINARY})
+    {
+        const std::string file_path = example_dir + "input.phy.out";
+        const std::string gz_file_path = file_path + ".gz";
+        aln.read(example_dir + "input.phy");
+        aln.write(file_path, format, true);
+        writeBgzfFile(file_path, gz_file_path, 50);
+        EXPECT_TRUE(isGzipFile(gz_file_path));
+        EXPECT_TRUE(isBgzfFile(gz_file_path));
+        EXPECT_FALSE(isBgzfFile(file_path));
+        
+        Alignment plain_aln(file_path);
+        Alignment gz_aln(gz_file_path);
+        EXPECT_EQ(gz_aln.aln_format, format);
+        EXPECT_EQ(gz_aln.ref_seq, plain_aln.ref_seq);
+        ASSERT_EQ(gz_aln.data.size(), plain_aln.data.size());
+        for (size_t i = 0; i < gz_aln.data.size(); ++i)
+        {
+            EXPECT_EQ(gz_aln.data[i].seq_name, plain_aln.data[i].seq_name);
+            EXPECT_EQ(gz_aln.data[i].size(), plain_aln.data[i].size());
+        }
+        std::remove(file_path.c_str());
+        std::remove(gz_file_path.c_str());
+    }
+    
     /*// ----- test on input.fa without ref file, specifying MAPLE file path -----
     aln.data.clear();
     aln.ref_seq.clear();
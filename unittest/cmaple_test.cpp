@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include "gtest/gtest.h"
 #include "../maple/cmaple.h"
 
@@ -43,3 +46,92 @@ TEST(CMapleTest, isEffective) {
     // Check the result
     EXPECT_FALSE(cmaple::isEffective(aln));
 }
+
+TEST(CMapleTest, servePlacements) {
+    
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+    
+    // keep the last 10 sequences of the MAPLE file to be placed later (the
+    // last one after removing a sample)
+    std::ifstream maple_stream(example_dir + "test_100.maple");
+    std::string base_records, new_records, last_record, line;
+    std::vector<std::string> new_names;
+    int num_seqs = -1; // the reference sequence is the first record
+    while (std::getline(maple_stream, line))
+    {
+        if (line.length() && line[0] == '>')
+            ++num_seqs;
+        if (num_seqs <= 90)
+            base_records += line + "\n";
+        else if (num_seqs == 100)
+            last_record += line + "\n";
+        else
+        {
+            if (line[0] == '>')
+                new_names.push_back(line.substr(1));
+            new_records += line + "\n";
+        }
+    }
+    
+    std::istringstream base_stream(base_records);
+    Alignment aln(base_stream);
+    Model model(cmaple::ModelBase::GTR);
+    Tree tree(&aln, &model);
+    std::ostream null_stream(nullptr);
+    tree.infer(cmaple::Tree::NORMAL_TREE_SEARCH, false, null_stream);
+    
+    // invalid requests
+    std::istringstream invalid_requests("PLACE\nbogus\n>x\na\t0\nPLACE\n");
+    std::ostringstream responses;
+    EXPECT_FALSE(servePlacements(aln, tree, invalid_requests, responses));
+    const std::string error_responses = responses.str();
+    EXPECT_EQ(std::count(error_responses.begin(), error_responses.end(), '\n'), 3);
+    EXPECT_EQ(error_responses.find("ERROR"), 0);
+    EXPECT_EQ(aln.data.size(), 90);
+    
+    // place the new sequences, then export the tree
+    std::istringstream requests(new_records + "PLACE\nNEWICK\nQUIT\nNEWICK\n");
+    responses.str("");
+    EXPECT_FALSE(servePlacements(aln, tree, requests, responses));
+    std::istringstream response_stream(responses.str());
+    for (const std::string& name : new_names)
+    {
+        ASSERT_TRUE(std::getline(response_stream, line));
+        EXPECT_EQ(line.substr(0, line.find('\t')), name);
+        EXPECT_EQ(std::count(line.begin(), line.end(), '\t'), 3);
+        EXPECT_EQ(line.find("NA"), std::string::npos);
+    }
+    ASSERT_TRUE(std::getline(response_stream, line));
+    EXPECT_EQ(line, "OK");
+    ASSERT_TRUE(std::getline(response_stream, line));
+    EXPECT_EQ(line, tree.exportNewick(cmaple::Tree::BIN_TREE, false));
+    for (const std::string& name : new_names)
+        EXPECT_NE(line.find(name + ":"), std::string::npos);
+    ASSERT_TRUE(std::getline(response_stream, line));
+    EXPECT_EQ(line, "OK");
+    // the requests after QUIT are ignored
+    EXPECT_FALSE(std::getline(response_stream, line));
+    
+    // remove a placed sample
+    std::istringstream remove_requests("REMOVE unknown\nREMOVE " + new_names[0] + "\nNEWICK\n");
+    responses.str("");
+    EXPECT_FALSE(servePlacements(aln, tree, remove_requests, responses));
+    EXPECT_EQ(responses.str().find("ERROR"), 0);
+    EXPECT_EQ(responses.str().find(new_names[0] + ":"), std::string::npos);
+    EXPECT_NE(responses.str().find(new_names[1] + ":"), std::string::npos);
+
+    // the removed sample is not placed again by the next placement
+    std::istringstream place_requests(last_record + "PLACE\nNEWICK\n");
+    responses.str("");
+    EXPECT_FALSE(servePlacements(aln, tree, place_requests, responses));
+    EXPECT_EQ(responses.str().find("ERROR"), std::string::npos);
+    EXPECT_EQ(responses.str().find(new_names[0] + ":"), std::string::npos);
+    EXPECT_NE(responses.str().find(last_record.substr(1, last_record.find('\n') - 1) + ":"), std::string::npos);
+    
+    // stop serving
+    std::istringstream shutdown_request("SHUTDOWN\n");
+    EXPECT_TRUE(servePlacements(aln, tree, shutdown_request, responses));
+}
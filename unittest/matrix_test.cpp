@@ -33,3 +33,34 @@ TEST(Model, dotProduct)
   testDotProduct<float>();
   testDotProduct<double>();
 }
+
+/*
+ Test the closed-form kernels for JC-like rate matrices against the generic ones
+ */
+TEST(Model, matrixEvolveJC)
+{
+  // init a JC rate matrix
+  const cmaple::RealNumType jc_rate = 1.0 / 3;
+  std::array<cmaple::RealNumType, 16> mutation_mat;
+  for (cmaple::StateType i = 0; i < 4; ++i)
+    for (cmaple::StateType j = 0; j < 4; ++j)
+      mutation_mat[i * 4 + j] = (i == j) ? -1 : jc_rate;
+  const std::array<cmaple::RealNumType, 4> root_freqs{0.25, 0.25, 0.25, 0.25};
+  const std::array<cmaple::RealNumType, 4> vec1{0.1, 0.2, 0.3, 0.4};
+  const std::array<cmaple::RealNumType, 4> vec2{0.7, 0.05, 0.2, 0.05};
+
+  const cmaple::RealNumType sum_vec2 = sumVec<4>(&vec2[0]);
+  ASSERT_DOUBLE_EQ(sum_vec2, 1);
+  for (cmaple::StateType i = 0; i < 4; ++i)
+    ASSERT_DOUBLE_EQ(dotProductJC<4>(&vec2[0], sum_vec2, i),
+                     dotProduct<4>(&mutation_mat[i * 4], &vec2[0]));
+
+  ASSERT_DOUBLE_EQ(matrixEvolveJC<4>(&vec1[0], &vec2[0], 1e-3),
+                   matrixEvolve<4>(&vec1[0], &vec2[0], &mutation_mat[0], 1e-3));
+  for (cmaple::StateType seq1_state = 0; seq1_state < 4; ++seq1_state)
+    ASSERT_DOUBLE_EQ(matrixEvolveRootJC<4>(&vec2[0], seq1_state, &root_freqs[0],
+                                           &mutation_mat[seq1_state * 4], 1e-3, 2e-4),
+                     matrixEvolveRoot<4>(&vec2[0], seq1_state, &root_freqs[0],
+                                         &mutation_mat[seq1_state * 4], &mutation_mat[0],
+                                         1e-3, 2e-4));
+}
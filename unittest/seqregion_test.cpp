@@ -213,6 +213,44 @@ TEST(SeqRegion, constructor_3)
     EXPECT_EQ(seqregion8.getLH(3), 0);
 }
 
+/*
+ Test shared likelihood vectors of ambiguity codes
+ */
+TEST(SeqRegion, shared_ambiguity_lh)
+{
+    SeqRegion seqregion1(1+4+3, 12, cmaple::SeqRegion::SEQ_DNA, 4);
+    SeqRegion seqregion2(1+4+3, 873, cmaple::SeqRegion::SEQ_DNA, 4);
+    SeqRegion seqregion3(1+2+8+3, 3243, cmaple::SeqRegion::SEQ_DNA, 4);
+    
+    // regions of the same ambiguity code share the same vector
+    EXPECT_TRUE(seqregion1.likelihood.isShared());
+    EXPECT_EQ(seqregion1.likelihood.get(), seqregion2.likelihood.get());
+    EXPECT_TRUE(seqregion3.likelihood.isShared());
+    EXPECT_NE(seqregion1.likelihood.get(), seqregion3.likelihood.get());
+    
+    // a clone gets its own (modifiable) copy
+    SeqRegion seqregion4 = SeqRegion::clone(seqregion1);
+    EXPECT_FALSE(seqregion4.likelihood.isShared());
+    EXPECT_TRUE(seqregion1 == seqregion4);
+    seqregion4.likelihood.getWritable()[0] = 1;
+    EXPECT_EQ(seqregion2.getLH(0), 0.5);
+    
+    // releasing a region doesn't free the shared vector
+    seqregion1.likelihood = nullptr;
+    EXPECT_EQ(seqregion2.getLH(2), 0.5);
+
+    // writing a region of an ambiguity code first copies the shared vector
+    seqregion2.likelihood.getWritable()[2] = 1;
+    EXPECT_FALSE(seqregion2.likelihood.isShared());
+    SeqRegion seqregion6(1+4+3, 4096, cmaple::SeqRegion::SEQ_DNA, 4);
+    EXPECT_TRUE(seqregion6.likelihood.isShared());
+    EXPECT_EQ(seqregion6.getLH(2), 0.5);
+    
+    // regions of nucleotides don't have a likelihood vector
+    SeqRegion seqregion5(TYPE_R, 21, cmaple::SeqRegion::SEQ_DNA, 4);
+    EXPECT_FALSE(seqregion5.likelihood.isShared());
+}
+
 /*
  Test SeqRegion(Mutation* n_mutation, SeqType seq_type, int max_num_states)
  */
@@ -324,10 +362,10 @@ TEST(SeqRegion, operators)
     EXPECT_FALSE(seqregion1 == seqregion9);
     
     SeqRegion seqregion10 = SeqRegion::clone(seqregion4);
-    (*seqregion10.likelihood)[1] += 1e-51;
+    seqregion10.likelihood.getWritable()[1] += 1e-51;
     EXPECT_TRUE(seqregion1 == seqregion10);
     
     SeqRegion seqregion11 = SeqRegion::clone(seqregion4);
-    (*seqregion11.likelihood)[1] += 2e-50;
+    seqregion11.likelihood.getWritable()[1] += 2e-50;
     EXPECT_FALSE(seqregion1 == seqregion11);
 }
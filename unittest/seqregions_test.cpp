@@ -281,6 +281,59 @@ TEST(SeqRegions, countSharedSegments)
     EXPECT_EQ(seqregions1->countSharedSegments(*seqregions2, 3500), 10);
 }
 
+/*
+ Test extendSharedRSegment()
+ */
+TEST(SeqRegions, extendSharedRSegment)
+{
+    SeqRegions seqregions1;
+    seqregions1.emplace_back(TYPE_R, 99, -1, -1);
+    seqregions1.emplace_back(TYPE_R, 199, 1e-3, -1);
+    seqregions1.emplace_back(0, 200);
+    seqregions1.emplace_back(TYPE_R, 499, -1, -1);
+    
+    SeqRegions seqregions2;
+    seqregions2.emplace_back(TYPE_R, 49, -1, -1);
+    seqregions2.emplace_back(TYPE_R, 149, 1e-4, -1);
+    seqregions2.emplace_back(TYPE_R, 299, -1, -1);
+    seqregions2.emplace_back(TYPE_N, 349);
+    seqregions2.emplace_back(TYPE_R, 499, -1, -1);
+    
+    // extend over the regions of both sequences -> stop at the region 0 of seqregions1
+    size_t i1 = 0, i2 = 0;
+    PositionType end_pos = 49;
+    SeqRegions::extendSharedRSegment(seqregions1, seqregions2, i1, i2, end_pos, true, true);
+    EXPECT_EQ(end_pos, 199);
+    EXPECT_EQ(i1, 1);
+    EXPECT_EQ(i2, 2);
+    
+    // only extend over the regions of seqregions2
+    i1 = 0; i2 = 0; end_pos = 49;
+    SeqRegions::extendSharedRSegment(seqregions1, seqregions2, i1, i2, end_pos, false, true);
+    EXPECT_EQ(end_pos, 99);
+    EXPECT_EQ(i1, 0);
+    EXPECT_EQ(i2, 1);
+    
+    // only extend over the regions of seqregions1 -> cannot go through the end of the first region of seqregions2
+    i1 = 0; i2 = 0; end_pos = 49;
+    SeqRegions::extendSharedRSegment(seqregions1, seqregions2, i1, i2, end_pos, true, false);
+    EXPECT_EQ(end_pos, 49);
+    EXPECT_EQ(i1, 0);
+    EXPECT_EQ(i2, 0);
+    
+    // stop at the region N of seqregions2
+    i1 = 3; i2 = 2; end_pos = 299;
+    SeqRegions::extendSharedRSegment(seqregions1, seqregions2, i1, i2, end_pos, true, true);
+    EXPECT_EQ(end_pos, 299);
+    
+    // stop at the end of the sequences
+    i1 = 3; i2 = 4; end_pos = 499;
+    SeqRegions::extendSharedRSegment(seqregions1, seqregions2, i1, i2, end_pos, true, true);
+    EXPECT_EQ(end_pos, 499);
+    EXPECT_EQ(i1, 3);
+    EXPECT_EQ(i2, 4);
+}
+
 /*
  Test compareWithSample(const SeqRegions& sequence2, PositionType seq_length, StateType num_states) const
  */
@@ -366,27 +419,85 @@ TEST(SeqRegions, areDiffFrom)
     // test on type O
     // difference is too small less then thresh_diff_update
     RealNumType thresh_diff_update = params->thresh_diff_update / 2;
-    seqregions5->data()[3].likelihood->data()[0] += thresh_diff_update;
-    seqregions5->data()[3].likelihood->data()[2] -= thresh_diff_update;
+    seqregions5->data()[3].likelihood.getWritable().data()[0] += thresh_diff_update;
+    seqregions5->data()[3].likelihood.getWritable().data()[2] -= thresh_diff_update;
     EXPECT_EQ(seqregions1->areDiffFrom(seqregions5, seq_length, aln.num_states, *params), false);
     
     // reset lh so that all pairs of lh between seqregions1 and seqregions2 equal to each other
-    seqregions5->data()[3].likelihood->data()[0] = thresh_diff_update;
-    seqregions5->data()[3].likelihood->data()[2] += seqregions5->data()[3].likelihood->data()[0];
-    seqregions1->data()[3].likelihood->data()[0] = seqregions5->data()[3].likelihood->data()[0];
-    seqregions1->data()[3].likelihood->data()[2] = seqregions5->data()[3].likelihood->data()[2];
+    seqregions5->data()[3].likelihood.getWritable().data()[0] = thresh_diff_update;
+    seqregions5->data()[3].likelihood.getWritable().data()[2] += seqregions5->data()[3].likelihood->data()[0];
+    seqregions1->data()[3].likelihood.getWritable().data()[0] = seqregions5->data()[3].likelihood->data()[0];
+    seqregions1->data()[3].likelihood.getWritable().data()[2] = seqregions5->data()[3].likelihood->data()[2];
     EXPECT_EQ(seqregions1->areDiffFrom(seqregions5, seq_length, aln.num_states, *params), false);
     
-    seqregions5->data()[3].likelihood->data()[2] += seqregions5->data()[3].likelihood->data()[0];
-    seqregions5->data()[3].likelihood->data()[0] = 0; // one lh = 0 but diff != 0
+    seqregions5->data()[3].likelihood.getWritable().data()[2] += seqregions5->data()[3].likelihood->data()[0];
+    seqregions5->data()[3].likelihood.getWritable().data()[0] = 0; // one lh = 0 but diff != 0
     EXPECT_EQ(seqregions1->areDiffFrom(seqregions5, seq_length, aln.num_states, *params), true);
     
-    seqregions5->data()[3].likelihood->data()[2] -= thresh_diff_update / 10;
-    seqregions5->data()[3].likelihood->data()[0] = thresh_diff_update / 10;
+    seqregions5->data()[3].likelihood.getWritable().data()[2] -= thresh_diff_update / 10;
+    seqregions5->data()[3].likelihood.getWritable().data()[0] = thresh_diff_update / 10;
     EXPECT_EQ(seqregions1->areDiffFrom(seqregions5, seq_length, aln.num_states, *params), true);
     // ---- other tests -----
 }
 
+/*
+ Test updateFingerprint() and its use in areDiffFrom()
+ */
+TEST(SeqRegions, fingerprint)
+{
+    Alignment aln = loadAln5K();
+    Model model(cmaple::ModelBase::GTR);
+    Tree tree(&aln, &model);
+    std::unique_ptr<Params>& params = tree.params;
+    const PositionType seq_length = aln.ref_seq.size();
+    
+    std::unique_ptr<SeqRegions> seqregions1 = nullptr;
+    std::unique_ptr<SeqRegions> seqregions2 = nullptr;
+    std::unique_ptr<SeqRegions> seqregions_1 = aln.data[0]
+        .getLowerLhVector(seq_length, aln.num_states, aln.getSeqType());
+    std::unique_ptr<SeqRegions> seqregions_2 = aln.data[10]
+        .getLowerLhVector(seq_length, aln.num_states, aln.getSeqType());
+    
+    // regions not produced by a merge have no fingerprint
+    EXPECT_EQ(seqregions_1->getFingerprint(), 0);
+    
+    // merging computes the fingerprint
+    seqregions_1->mergeTwoLowers<4>(seqregions1, 1e-5, *seqregions_2, 123e-3, tree.aln,
+                        tree.model, tree.cumulative_rate, params->threshold_prob);
+    EXPECT_NE(seqregions1->getFingerprint(), 0);
+    seqregions_1->mergeUpperLower<4>(seqregions2, 1e-5, *seqregions_2, 123e-3, tree.aln,
+                        tree.model, params->threshold_prob);
+    EXPECT_NE(seqregions2->getFingerprint(), 0);
+    
+    // the fingerprint only depends on the types and the positions of regions
+    std::unique_ptr<SeqRegions> seqregions3 = cmaple::make_unique<SeqRegions>(seqregions1);
+    EXPECT_EQ(seqregions1->getFingerprint(), seqregions3->getFingerprint());
+    seqregions3->data()[0].plength_observation2node += 0.1;
+    seqregions3->updateFingerprint();
+    EXPECT_EQ(seqregions1->getFingerprint(), seqregions3->getFingerprint());
+    EXPECT_EQ(seqregions1->areDiffFrom(seqregions3, seq_length, aln.num_states, *params), true);
+    seqregions3->data()[0].plength_observation2node -= 0.1;
+    EXPECT_EQ(seqregions1->areDiffFrom(seqregions3, seq_length, aln.num_states, *params), false);
+    
+    // the total lh keeps the fingerprint
+    std::unique_ptr<SeqRegions> total_lh = nullptr;
+    seqregions1->computeTotalLhAtRoot<4>(total_lh, tree.model);
+    EXPECT_EQ(seqregions1->getFingerprint(), total_lh->getFingerprint());
+    
+    // change the structure -> different fingerprints -> different regions
+    const PositionType pos_3 = seqregions3->data()[3].position;
+    seqregions3->data()[3].position = pos_3 - 1;
+    seqregions3->updateFingerprint();
+    EXPECT_NE(seqregions1->getFingerprint(), seqregions3->getFingerprint());
+    EXPECT_EQ(seqregions1->areDiffFrom(seqregions3, seq_length, aln.num_states, *params), true);
+    
+    // restore the structure
+    seqregions3->data()[3].position = pos_3;
+    seqregions3->updateFingerprint();
+    EXPECT_EQ(seqregions1->getFingerprint(), seqregions3->getFingerprint());
+    EXPECT_EQ(seqregions1->areDiffFrom(seqregions3, seq_length, aln.num_states, *params), false);
+}
+
 /*
  Test simplifyO(RealNumType* const partial_lh, StateType ref_state,
  StateType num_states, RealNumType threshold) const
@@ -3859,7 +3970,7 @@ TEST(SeqRegions, merge_O_ORACGT_TwoLowers)
         0.49999721206173608489820026079542003571987152099609,
         2.7879382638950842936132173272012479969816922675818e-06,
         0.49999721206173608489820026079542003571987152099609};
-    (*seqregion1.likelihood) = new_lh_value2;
+    seqregion1.likelihood.getWritable() = new_lh_value2;
     seqregion2.type = 0;
     EXPECT_TRUE(merge_O_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
                 total_blength_1, total_blength_2, end_pos, tree.aln, tree.model,
@@ -3891,7 +4002,7 @@ TEST(SeqRegions, merge_O_ORACGT_TwoLowers)
         0.24998327199732350845096107150311581790447235107422,
         8.3640013382402129011325767060647251582850003615022e-06,
         0.74999999999999988897769753748434595763683319091797};
-    (*seqregion1.likelihood) = new_lh_value3;
+    seqregion1.likelihood.getWritable() = new_lh_value3;
     seqregion2.type = TYPE_R;
     EXPECT_TRUE(merge_O_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
                 total_blength_1, total_blength_2, end_pos, tree.aln,
@@ -3916,7 +4027,7 @@ TEST(SeqRegions, merge_O_ORACGT_TwoLowers)
      1.3382670779607485874503763900733588343427982181311e-05,
      0.59999197039753215943136410714942030608654022216797,
      1.3382670779607485874503763900733588343427982181311e-05};
-    (*seqregion2.likelihood) = new_lh_value6;
+    seqregion2.likelihood.getWritable() = new_lh_value6;
     EXPECT_TRUE(merge_O_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
      total_blength_1, total_blength_2, end_pos, tree.aln, tree.model,
      threshold_prob, log_lh, merged_regions, true));
@@ -3938,7 +4049,7 @@ TEST(SeqRegions, merge_O_ORACGT_TwoLowers)
      0.33332094226630137878686355179524980485439300537109,
      7.4346402191731947664294494204639818235591519623995e-06,
      0.66666418845326025355291221785591915249824523925781};
-    (*seqregion1.likelihood) = new_lh_value4;
+    seqregion1.likelihood.getWritable() = new_lh_value4;
     seqregion2.type = 1;
     EXPECT_TRUE(merge_O_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
      total_blength_1, total_blength_2, end_pos, tree.aln, tree.model,
@@ -3959,7 +4070,7 @@ TEST(SeqRegions, merge_O_ORACGT_TwoLowers)
      7.4343638397288813108904244331132105116921593435109e-06,
      2.4874076016223502201974116939081453636628538106379e-10,
      0.99999256513867862405930964087019674479961395263672};
-    (*seqregion2.likelihood) = new_lh_value7;
+    seqregion2.likelihood.getWritable() = new_lh_value7;
     EXPECT_TRUE(merge_O_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
      total_blength_1, total_blength_2, end_pos, tree.aln, tree.model,
      threshold_prob, log_lh, merged_regions, true));
@@ -3982,7 +4093,7 @@ TEST(SeqRegions, merge_O_ORACGT_TwoLowers)
      5.5759387092817078802929955938516570768115343526006e-06,
      0.49999442406129068761089229155913926661014556884766,
      5.5759387092817078802929955938516570768115343526006e-06};
-    (*seqregion1.likelihood) = new_lh_value5;
+    seqregion1.likelihood.getWritable() = new_lh_value5;
     seqregion2.type = TYPE_R;
     EXPECT_TRUE(merge_O_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
      total_blength_1, total_blength_2, end_pos, tree.aln, tree.model,
@@ -4063,7 +4174,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
     // ----- Test 2 -----
     log_lh = 0;
     total_blength_2 = 1e-3;
-    (*seqregion2.likelihood) = new_lh_value1;
+    seqregion2.likelihood.getWritable() = new_lh_value1;
     SeqRegion::LHType new_lh_value2{6.9955421312460765020272434505291649434188805400936e-11,
         6.9955421312460765020272434505291649434188805400936e-11,
         0.99999686351370775660996059741592034697532653808594,
@@ -4091,7 +4202,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
         4.9563776809356656518181297177427779843128519132733e-06,
         0.11109844481259316395505010177657823078334331512451,
         0.88889164243204510373885796070680953562259674072266};
-    (*seqregion2.likelihood) = new_lh_value3;
+    seqregion2.likelihood.getWritable() = new_lh_value3;
     (*new_lh) = new_lh_value;
     EXPECT_TRUE(merge_RACGT_O_TwoLowers<4>(seqregion2, total_blength_2,
                 end_pos, tree.aln, tree.model, threshold_prob, *new_lh,
@@ -4110,7 +4221,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
     // ----- Test 4 -----
     log_lh = 0;
     total_blength_2 = 213e-7;
-    (*seqregion2.likelihood) = new_lh_value1;
+    seqregion2.likelihood.getWritable() = new_lh_value1;
     SeqRegion::LHType new_lh_value4{2.6136903006998423677005767562508964374501374550164e-06,
         0.062492812351673081294745060176865081302821636199951,
         2.6136903006998423677005767562508964374501374550164e-06,
@@ -4138,7 +4249,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
      8.9219993723549547142565030455330088443588465452194e-05,
      9.9498152920206932387357935649403392619483099679201e-10,
      0.99991077801631333965559633725206367671489715576172};
-    (*seqregion2.likelihood) = new_lh_value5;
+    seqregion2.likelihood.getWritable() = new_lh_value5;
     (*new_lh) = new_lh_value;
     EXPECT_TRUE(merge_RACGT_O_TwoLowers<4>(seqregion2, total_blength_2,
      end_pos, tree.aln, tree.model, threshold_prob, *new_lh, log_lh,
@@ -4157,7 +4268,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
     // ----- Test 6 -----
     log_lh = 0;
     total_blength_2 = 0;
-    (*seqregion2.likelihood) = new_lh_value1;
+    seqregion2.likelihood.getWritable() = new_lh_value1;
     SeqRegion::LHType new_lh_value6{5.5759387092817078802929955938516570768115343526006e-06,
      0.49999442406129068761089229155913926661014556884766,
      5.5759387092817078802929955938516570768115343526006e-06,
@@ -4184,7 +4295,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
      1.1151877415789591228433182135137968771232408471406e-05,
      1.2436575683940661210420103588707597258578019250308e-10,
      0.99998884787385255989988763758447021245956420898438};
-    (*seqregion2.likelihood) = new_lh_value7;
+    seqregion2.likelihood.getWritable() = new_lh_value7;
     (*new_lh) = new_lh_value;
     EXPECT_TRUE(merge_RACGT_O_TwoLowers<4>(seqregion2, total_blength_2,
      end_pos, tree.aln, tree.model, threshold_prob, *new_lh, log_lh,
@@ -4203,7 +4314,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
     // ----- Test 8 -----
     log_lh = 0;
     total_blength_2 = 163e-10;
-    (*seqregion2.likelihood) = new_lh_value1;
+    seqregion2.likelihood.getWritable() = new_lh_value1;
     SeqRegion::LHType new_lh_value8{0.74997769674260927885711680573876947164535522460938,
      0.24998327274350143345493791002809302881360054016113,
      1.9515256944661845116837164959555650511902058497071e-05,
@@ -4230,7 +4341,7 @@ TEST(SeqRegions, merge_RACGT_O_TwoLowers)
      2.5092097243268992381179730011275808010395849123597e-05,
      6.5292438309787796439726148030194621818544931102224e-10,
      6.5292438309787796439726148030194621818544931102224e-10};
-    (*seqregion2.likelihood) = new_lh_value9;
+    seqregion2.likelihood.getWritable() = new_lh_value9;
     (*new_lh) = new_lh_value;
     EXPECT_TRUE(merge_RACGT_O_TwoLowers<4>(seqregion2, total_blength_2,
      end_pos, tree.aln, tree.model, threshold_prob, *new_lh,
@@ -4611,7 +4722,7 @@ TEST(SeqRegions, merge_RACGT_ORACGT_TwoLowers)
      1.3382670779607485874503763900733588343427982181311e-05,
      0.39998126426090857554740409796067979186773300170898,
      0.59999197039753215943136410714942030608654022216797};
-    (*seqregion2.likelihood) = new_lh_value6;
+    seqregion2.likelihood.getWritable() = new_lh_value6;
     EXPECT_TRUE(merge_RACGT_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
      total_blength_1, total_blength_2, end_pos, tree.aln, tree.model,
      threshold_prob, log_lh, merged_regions, true));
@@ -4649,7 +4760,7 @@ TEST(SeqRegions, merge_RACGT_ORACGT_TwoLowers)
      7.4343638397288813108904244331132105116921593435109e-06,
      2.4874076016223502201974116939081453636628538106379e-10,
      2.4874076016223502201974116939081453636628538106379e-10};
-    (*seqregion2.likelihood) = new_lh_value7;
+    seqregion2.likelihood.getWritable() = new_lh_value7;
     EXPECT_TRUE(merge_RACGT_ORACGT_TwoLowers<4>(seqregion1, seqregion2,
      total_blength_1, total_blength_2, end_pos, tree.aln, tree.model,
      threshold_prob, log_lh, merged_regions, true));
@@ -4806,7 +4917,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
         0.71422131017848822231997019116533920168876647949219,
         4.9383548301647924830444502664050787643645890057087e-05,
         0.28567992272490849714472460618708282709121704101562};
-    (*seqregion2.likelihood) = new_lh_value3;
+    seqregion2.likelihood.getWritable() = new_lh_value3;
     seqregion2.type = TYPE_O;
     EXPECT_TRUE(merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
                     plength1, plength2, end_pos, pos, tree.aln, tree.model,
@@ -4834,7 +4945,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
         0.39999063238118182095348629445652477443218231201172,
         6.6911562987199814600764238847752096717158565297723e-06,
         0.59999598530622066938633452082285657525062561035156};
-    (*seqregion2.likelihood) = new_lh_value6;
+    seqregion2.likelihood.getWritable() = new_lh_value6;
     EXPECT_EQ(merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
                     plength1, plength2, end_pos, pos, tree.aln,
                     tree.model, tree.cumulative_rate, threshold_prob,
@@ -4854,7 +4965,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
         0.99999581732016740165391865957644768059253692626953,
         4.430579981880772584663374230178360321796837695274e-10,
         4.181793716486326507387246559366289488934853579849e-06};
-    (*seqregion1.likelihood) = new_lh_value4;
+    seqregion1.likelihood.getWritable() = new_lh_value4;
     seqregion1.type = TYPE_O;
     seqregion2.type = 1;
     EXPECT_FALSE(!merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
@@ -4876,7 +4987,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
         0.9999702585027225865133004845120012760162353515625,
         1.1815113248226830777267349123884135342343881802663e-09,
         2.9739134254674524059092188821296076639555394649506e-05};
-    (*seqregion2.likelihood) = new_lh_value7;
+    seqregion2.likelihood.getWritable() = new_lh_value7;
     EXPECT_EQ(!merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
                 plength1, plength2, end_pos, pos, tree.aln, tree.model,
                 tree.cumulative_rate, threshold_prob, log_lh,
@@ -4896,7 +5007,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
      0.39999063238118182095348629445652477443218231201172,
      6.6911562987199814600764238847752096717158565297723e-06,
      0.59999598530622066938633452082285657525062561035156};
-    (*seqregion1.likelihood) = new_lh_value5;
+    seqregion1.likelihood.getWritable() = new_lh_value5;
     seqregion1.type = TYPE_O;
     seqregion2.type = TYPE_R;
     EXPECT_TRUE(merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
@@ -4933,7 +5044,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
      0.99999581732016751267622112209210172295570373535156,
      4.430579981880772584663374230178360321796837695274e-10,
      4.430579981880772584663374230178360321796837695274e-10};
-    (*seqregion1.likelihood) = new_lh_value11;
+    seqregion1.likelihood.getWritable() = new_lh_value11;
     seqregion1.type = TYPE_O;
     seqregion2.type = TYPE_R;
     EXPECT_TRUE(merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
@@ -4970,7 +5081,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
      7.4346402191731947664294494204639818235591519623995e-06,
      0.66666418845326025355291221785591915249824523925781,
      7.4346402191731947664294494204639818235591519623995e-06};
-    (*seqregion1.likelihood) = new_lh_value13;
+    seqregion1.likelihood.getWritable() = new_lh_value13;
     seqregion1.type = TYPE_O;
     seqregion2.type = 0;
     EXPECT_TRUE(merge_notN_notN_TwoLowers<4>(seqregion1,
@@ -5013,7 +5124,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
      0.99996654175612176285170562550774775445461273193359,
      9.9493714778138372440088605107603655919312757305306e-10,
      3.345625400403152548828300538730218249838799238205e-05};
-    (*seqregion2.likelihood) = new_lh_value15;
+    seqregion2.likelihood.getWritable() = new_lh_value15;
     seqregion2.type = TYPE_O;
     EXPECT_TRUE(merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
      plength1, plength2, end_pos, pos, tree.aln, tree.model,
@@ -5039,7 +5150,7 @@ TEST(SeqRegions, merge_notN_notN_TwoLowers)
      0.99996236262065618660699328756891191005706787109375,
      1.1152071733605872690944446623539931806590175256133e-05,
      1.1152071733605872690944446623539931806590175256133e-05};
-    (*seqregion2.likelihood) = new_lh_value16;
+    seqregion2.likelihood.getWritable() = new_lh_value16;
     EXPECT_TRUE(merge_notN_notN_TwoLowers<4>(seqregion1, seqregion2,
      plength1, plength2, end_pos, pos, tree.aln, tree.model,
      tree.cumulative_rate, threshold_prob, log_lh, merged_regions, true));
@@ -0,0 +1,1223 @@
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "gtest/gtest.h"
+#include "../tree/tree.h"
+
+using namespace cmaple;
+
+/*
+ * Append copies of the given sequences (renamed with a suffix) to an alignment
+ * @return the names of the copies
+ */
+std::vector<std::string> addSequenceCopies(Alignment& aln, const std::vector<std::string>& names,
+                                           const std::string& suffix = "_again")
+{
+    std::vector<Sequence> copies;
+    std::vector<std::string> copy_names;
+    for (const std::string& name : names)
+        for (const Sequence& sequence : aln.data)
+            if (sequence.seq_name == name)
+            {
+                copy_names.push_back(name + suffix);
+                copies.emplace_back(name + suffix, std::vector<Mutation>(sequence.begin(), sequence.end()));
+            }
+    aln.addSequences(std::move(copies));
+    return copy_names;
+}
+
+/*
+ * Count the samples reported as not in the tree by exportPlacements()
+ */
+std::size_t countMissingPlacements(Tree& tree, const std::vector<std::string>& names)
+{
+    std::ostringstream placements;
+    tree.exportPlacements(names, placements);
+    const std::string placement_str = placements.str();
+    std::size_t num_missing = 0;
+    for (std::string::size_type pos = placement_str.find("\tNA\n"); pos != std::string::npos;
+         pos = placement_str.find("\tNA\n", pos + 1))
+        ++num_missing;
+    return num_missing;
+}
+
+namespace cmaple
+{
+    /*
+     * Access the internal states of a tree
+     */
+    class TreeTester
+    {
+    public:
+        /*
+         * Check if the index of mutations matches one rebuilt from the leaves in the tree: the same
+         * counts, and only leaves (in the tree) carrying the mutations are listed
+         */
+        static bool isMutationIndexConsistent(Tree& tree)
+        {
+            const std::vector<NumSeqsType> mutation_counts = tree.mutation_counts;
+            const std::vector<std::vector<NumSeqsType>> mutation_leaves = tree.mutation_leaves;
+            tree.buildMutationIndex();
+            if (mutation_counts != tree.mutation_counts)
+                return false;
+            for (std::vector<std::vector<NumSeqsType>>::size_type i = 0; i < mutation_leaves.size(); ++i)
+                for (const NumSeqsType leaf : mutation_leaves[i])
+                    if (std::find(tree.mutation_leaves[i].begin(), tree.mutation_leaves[i].end(), leaf) ==
+                        tree.mutation_leaves[i].end())
+                        return false;
+            return true;
+        }
+
+        /*
+         * Select the node to start seeking the placement of a sample
+         * @return the (vector) index of the start node
+         */
+        static NumSeqsType selectPlacementStart(Tree& tree, const NumSeqsType seq_index, int& max_depth)
+        {
+            return tree.selectPlacementStart(seq_index, max_depth).getVectorIndex();
+        }
+
+        /*
+         * Get the (vector) index of the root
+         */
+        static NumSeqsType getRoot(Tree& tree)
+        {
+            return tree.root_vector_index;
+        }
+
+        /*
+         * Check if a node is an ancestor of (or is) a leaf sharing a rare mutation with a sample
+         */
+        static bool isAncestorOfRelatedLeaf(Tree& tree, const NumSeqsType ancestor, const NumSeqsType seq_index)
+        {
+            for (const Mutation& mutation : tree.aln->data[seq_index])
+            {
+                if (mutation.type >= tree.aln->num_states)
+                    continue;
+                const std::size_t key = static_cast<std::size_t>(mutation.position) * tree.aln->num_states +
+                                        mutation.type;
+                if (tree.mutation_leaves[key].size() != tree.mutation_counts[key])
+                    continue;
+                for (NumSeqsType vec_index : tree.mutation_leaves[key])
+                {
+                    while (vec_index != ancestor && vec_index != tree.root_vector_index)
+                        vec_index = tree.nodes[vec_index].getNeighborIndex(TOP).getVectorIndex();
+                    if (vec_index == ancestor)
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        /*
+         * Compute the bound on the placement cost of a sample anywhere in the subtree below a node
+         */
+        static RealNumType boundSamplePlacementCost(Tree& tree, const NumSeqsType vec_index,
+                                                    const NumSeqsType seq_index)
+        {
+            return tree.boundSamplePlacementCost(vec_index, tree.getMutationMaskBits(seq_index),
+                                                 tree.computeAbsentMutationBound());
+        }
+
+        /*
+         * Compute the highest costs of placing a (nucleotide) sample anywhere in the subtree below each node (or
+         * on the branch above it): at the nodes or at the mid-branch points, with the default and the maximum
+         * branch lengths
+         * @return the costs by (vector) index, with the (vector) indexes of the nodes in the tree
+         */
+        static std::map<NumSeqsType, RealNumType> calculateSubtreePlacementCosts(Tree& tree,
+                                                                               const NumSeqsType seq_index)
+        {
+            // list the nodes from the root, so that the children follow their parents
+            std::vector<NumSeqsType> vec_indexes(1, tree.root_vector_index);
+            for (std::vector<NumSeqsType>::size_type i = 0; i < vec_indexes.size(); ++i)
+                if (tree.nodes[vec_indexes[i]].isInternal())
+                {
+                    vec_indexes.push_back(tree.nodes[vec_indexes[i]].getNeighborIndex(LEFT).getVectorIndex());
+                    vec_indexes.push_back(tree.nodes[vec_indexes[i]].getNeighborIndex(RIGHT).getVectorIndex());
+                }
+
+            const std::unique_ptr<SeqRegions> sample_regions = tree.aln->data[seq_index].getLowerLhVector(
+                static_cast<PositionType>(tree.aln->ref_seq.size()), tree.aln->num_states, tree.aln->getSeqType());
+            std::map<NumSeqsType, RealNumType> costs;
+            for (auto it = vec_indexes.rbegin(); it != vec_indexes.rend(); ++it)
+            {
+                PhyloNode& node = tree.nodes[*it];
+                RealNumType& cost = costs.emplace(*it, MIN_NEGATIVE).first->second;
+                for (const RealNumType blength : {tree.default_blength, tree.max_blength})
+                    cost = std::max({cost,
+                                     tree.calculateSamplePlacementCost<4>(node.getTotalLh(), sample_regions, blength),
+                                     tree.calculateSamplePlacementCost<4>(node.getMidBranchLh(), sample_regions,
+                                                                          blength)});
+                if (node.isInternal())
+                    cost = std::max({cost, costs[node.getNeighborIndex(LEFT).getVectorIndex()],
+                                     costs[node.getNeighborIndex(RIGHT).getVectorIndex()]});
+            }
+            return costs;
+        }
+
+        /*
+         * Build the masks of mutations of a tree
+         */
+        static void buildMutationMasks(Tree& tree)
+        {
+            tree.buildMutationMasks();
+        }
+
+        /*
+         * Compute the order to place the samples in
+         */
+        static std::vector<NumSeqsType> computePlacementOrder(Tree& tree)
+        {
+            return tree.computePlacementOrder();
+        }
+
+        /*
+         * Compute the MinHash of the mutations of a sample
+         */
+        static std::uint64_t computeMutationMinHash(Tree& tree, const NumSeqsType seq_index)
+        {
+            return tree.computeMutationMinHash(seq_index);
+        }
+
+        /*
+         * Check if a mutation (to a specific state) is carried by at most params->seed_rare_mutation_limit
+         * leaves
+         */
+        static bool isRareMutation(Tree& tree, const Mutation& mutation)
+        {
+            const std::size_t key = static_cast<std::size_t>(mutation.position) * tree.aln->num_states + mutation.type;
+            return tree.mutation_counts[key] <= static_cast<NumSeqsType>(tree.params->seed_rare_mutation_limit);
+        }
+
+        /*
+         * Get the names of the less-informative sequences represented by the leaf of a sample
+         * @return TRUE if a leaf holds the sample
+         */
+        static bool getLessInfoSeqNames(Tree& tree, const std::string& name,
+                                        std::vector<std::string>& less_info_names)
+        {
+            less_info_names.clear();
+            for (const NumSeqsType vec_index : tree.collectLeafVecIndexes())
+            {
+                PhyloNode& leaf = tree.nodes[vec_index];
+                if (tree.seq_names[leaf.getSeqNameIndex()] != name)
+                    continue;
+                for (const NumSeqsType seq_index : leaf.getLessInfoSeqs())
+                    less_info_names.push_back(tree.seq_names[seq_index]);
+                return true;
+            }
+            return false;
+        }
+    };
+}
+
+/*
+ * Test saveCheckpoint() and loadCheckpoint()
+ */
+TEST(Tree, checkpoint)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.doPlacement(log_stream);
+
+    std::stringstream checkpoint_stream;
+    tree.saveCheckpoint(checkpoint_stream);
+
+    // restore the checkpoint into a fresh tree (and model)
+    Model model2(ModelBase::GTR);
+    Tree tree2(&aln, &model2);
+    tree2.loadCheckpoint(checkpoint_stream);
+    EXPECT_EQ(tree2.exportNewick(Tree::BIN_TREE, false), tree.exportNewick(Tree::BIN_TREE, false));
+    EXPECT_EQ(tree2.computeLh(), tree.computeLh());
+    EXPECT_EQ(model2.getParams().mut_rates, model.getParams().mut_rates);
+    EXPECT_EQ(model2.getParams().state_freqs, model.getParams().state_freqs);
+
+    // both trees continue the inference in the same way
+    tree.applySPR(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    tree2.applySPR(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    EXPECT_EQ(tree2.exportNewick(Tree::BIN_TREE, false), tree.exportNewick(Tree::BIN_TREE, false));
+    EXPECT_EQ(tree2.computeLh(), tree.computeLh());
+
+    // save & restore via a file
+    tree.saveCheckpoint("test_checkpoint.bin");
+    Model model3(ModelBase::GTR);
+    Tree tree3(&aln, &model3);
+    tree3.loadCheckpoint("test_checkpoint.bin");
+    EXPECT_EQ(tree3.exportNewick(Tree::BIN_TREE, false), tree.exportNewick(Tree::BIN_TREE, false));
+    EXPECT_THROW(tree3.loadCheckpoint("notfound"), std::ios::failure);
+    EXPECT_THROW(tree3.saveCheckpoint(""), std::invalid_argument);
+
+    // a checkpoint of another alignment/model is rejected
+    Alignment aln2(example_dir + "test_5K.maple");
+    Model model4(ModelBase::GTR);
+    Tree tree4(&aln2, &model4);
+    checkpoint_stream.clear();
+    checkpoint_stream.seekg(0);
+    EXPECT_THROW(tree4.loadCheckpoint(checkpoint_stream), std::invalid_argument);
+    Model model5(ModelBase::JC);
+    Tree tree5(&aln, &model5);
+    checkpoint_stream.clear();
+    checkpoint_stream.seekg(0);
+    EXPECT_THROW(tree5.loadCheckpoint(checkpoint_stream), std::invalid_argument);
+
+    // a truncated checkpoint is rejected and leaves the tree unchanged
+    std::istringstream truncated_stream(checkpoint_stream.str().substr(0, 1000));
+    EXPECT_THROW(tree5.loadCheckpoint(truncated_stream), std::invalid_argument);
+    EXPECT_EQ(tree5.exportNewick(Tree::BIN_TREE, false), "");
+}
+
+/*
+ * Test resuming the inference from checkpoints written automatically
+ */
+TEST(Tree, autoCheckpoint)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+
+    // a checkpoint is written before every 30th placement
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model, "", false, ParamsBuilder().withCheckpoint("test_auto.ckp", 1e9)
+              .withCheckpointPlacementPeriod(30).build());
+    tree.doPlacement(log_stream);
+    EXPECT_TRUE(fileExists("test_auto.ckp"));
+    EXPECT_FALSE(fileExists("test_auto.ckp.tmp"));
+
+    // resuming the placement from the last checkpoint gives the same tree
+    Model model2(ModelBase::GTR);
+    Tree tree2(&aln, &model2);
+    tree2.loadCheckpoint("test_auto.ckp");
+    EXPECT_NE(tree2.exportNewick(Tree::BIN_TREE, false), tree.exportNewick(Tree::BIN_TREE, false));
+    tree2.doPlacement(log_stream);
+    EXPECT_EQ(tree2.exportNewick(Tree::BIN_TREE, false), tree.exportNewick(Tree::BIN_TREE, false));
+    EXPECT_EQ(tree2.computeLh(), tree.computeLh());
+
+    // checkpoints are written at every round of tree search
+    Model model3(ModelBase::GTR);
+    Tree tree3(&aln, &model3, "", false, ParamsBuilder().withCheckpoint("test_auto.ckp", 0).build());
+    tree3.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+
+    // resuming the inference from the last checkpoint gives the same tree
+    Model model4(ModelBase::GTR);
+    Tree tree4(&aln, &model4);
+    tree4.loadCheckpoint("test_auto.ckp");
+    tree4.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    EXPECT_EQ(tree4.exportNewick(Tree::BIN_TREE, false), tree3.exportNewick(Tree::BIN_TREE, false));
+    EXPECT_EQ(tree4.computeLh(), tree3.computeLh());
+
+    EXPECT_THROW(ParamsBuilder().withCheckpoint(""), std::invalid_argument);
+    EXPECT_THROW(ParamsBuilder().withCheckpoint("test_auto.ckp", -1), std::invalid_argument);
+    EXPECT_THROW(ParamsBuilder().withCheckpointPlacementPeriod(-1), std::invalid_argument);
+}
+
+/*
+ * Test reading trees in NEWICK format
+ */
+TEST(Tree, readNewick)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+
+    // a caterpillar tree (with comments and spaces)
+    std::string tree_str = aln.data[0].seq_name;
+    for (std::vector<Sequence>::size_type i = 1; i < aln.data.size(); ++i)
+        tree_str = "(" + tree_str + ",\n " + aln.data[i].seq_name + " [comment]:0.001)";
+    tree_str += ";";
+    std::istringstream tree_stream(tree_str);
+    Tree tree(&aln, &model, tree_stream);
+    const std::string newick = tree.exportNewick(Tree::BIN_TREE, false);
+    for (const Sequence& sequence : aln.data)
+        EXPECT_NE(newick.find(sequence.seq_name), std::string::npos);
+
+    // a multifurcating tree with missing branch lengths
+    std::istringstream mul_stream("(" + aln.data[0].seq_name + "," + aln.data[1].seq_name
+                                  + ":0.01," + aln.data[2].seq_name + ")root;");
+    Tree tree2(&aln, &model, mul_stream);
+    const std::string newick2 = tree2.exportNewick(Tree::BIN_TREE, false);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_NE(newick2.find(aln.data[i].seq_name), std::string::npos);
+
+    // only the first tree (ended by a ';' outside comments) is read
+    std::istringstream multi_stream("(" + aln.data[0].seq_name + "[a;b]," + aln.data[1].seq_name
+                                    + "," + aln.data[2].seq_name + ");\n(" + aln.data[3].seq_name
+                                    + "," + aln.data[4].seq_name + ");");
+    Tree tree3(&aln, &model, multi_stream);
+    const std::string newick3 = tree3.exportNewick(Tree::BIN_TREE, false);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_NE(newick3.find(aln.data[i].seq_name), std::string::npos);
+    EXPECT_EQ(newick3.find(aln.data[3].seq_name), std::string::npos);
+    Tree tree4(&aln, &model, multi_stream);
+    const std::string newick4 = tree4.exportNewick(Tree::BIN_TREE, false);
+    EXPECT_NE(newick4.find(aln.data[3].seq_name), std::string::npos);
+    EXPECT_EQ(newick4.find(aln.data[0].seq_name), std::string::npos);
+
+    // incorrect trees
+    std::istringstream no_semicolon("(" + aln.data[0].seq_name + "," + aln.data[1].seq_name + ")");
+    EXPECT_THROW(tree2.load(no_semicolon), std::invalid_argument);
+    std::istringstream no_bracket(aln.data[0].seq_name + ";");
+    EXPECT_THROW(tree2.load(no_bracket), std::invalid_argument);
+    std::istringstream unknown_leaf("(" + aln.data[0].seq_name + ",unknown_taxon);");
+    EXPECT_THROW(tree2.load(unknown_leaf), std::invalid_argument);
+    std::istringstream unclosed("((" + aln.data[0].seq_name + "," + aln.data[1].seq_name + ");");
+    EXPECT_THROW(tree2.load(unclosed), std::invalid_argument);
+    std::istringstream bad_comment("(" + aln.data[0].seq_name + "[comment," + aln.data[1].seq_name + ");");
+    EXPECT_THROW(tree2.load(bad_comment), std::invalid_argument);
+}
+
+/*
+ * Test writing trees in NEWICK format to a stream
+ */
+TEST(Tree, writeNewick)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    // branch lengths and supports are formatted as before
+    for (const RealNumType number : {0.0, 1.0, -1.0, 1e-5, 0.000123456789012345, 1234567.891, 1e20, 0.1 + 0.2})
+    {
+        std::string output;
+        appendDoubleToString(output, number);
+        EXPECT_EQ(output, convertDoubleToString(number));
+        output.clear();
+        appendDoubleToString(output, number, 12);
+        EXPECT_EQ(output, convertDoubleToString(number, 12));
+    }
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+
+    // an empty tree
+    std::ostringstream empty_stream;
+    tree.exportNewick(empty_stream);
+    EXPECT_EQ(empty_stream.str(), "");
+
+    tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    for (const Tree::TreeType tree_type : {Tree::BIN_TREE, Tree::MUL_TREE})
+    {
+        std::ostringstream tree_stream;
+        tree.exportNewick(tree_stream, tree_type, false);
+        const std::string newick = tree.exportNewick(tree_type, false);
+        EXPECT_EQ(tree_stream.str(), newick);
+        EXPECT_EQ(newick.back(), ';');
+        EXPECT_EQ(std::count(newick.begin(), newick.end(), '('), std::count(newick.begin(), newick.end(), ')'));
+
+        // the written tree can be read back
+        std::istringstream in_stream(newick);
+        Model model2(ModelBase::GTR);
+        EXPECT_NO_THROW(Tree(&aln, &model2, in_stream, true));
+    }
+    std::ostringstream invalid_stream;
+    EXPECT_THROW(tree.exportNewick(invalid_stream, Tree::UNKNOWN_TREE), std::invalid_argument);
+}
+
+/*
+ * Test placing queries onto a fixed tree
+ */
+TEST(Tree, placeQueries)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    // the reference sequence is in the second line of the MAPLE file
+    std::ifstream maple_stream(example_dir + "test_100.maple");
+    std::string ref_seq;
+    std::getline(maple_stream, ref_seq);
+    std::getline(maple_stream, ref_seq);
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    const auto copySequences = [&aln](const std::vector<Sequence>::size_type num_seqs) {
+        std::vector<Sequence> sequences;
+        for (std::vector<Sequence>::size_type i = 0; i < num_seqs; ++i)
+            sequences.emplace_back(std::string(aln.data[i].seq_name),
+                                   std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end()));
+        return sequences;
+    };
+
+    // a reference tree of the first 80 sequences
+    Alignment ref_aln(copySequences(80), ref_seq);
+    Model ref_model(ModelBase::GTR);
+    Tree ref_tree(&ref_aln, &ref_model);
+    ref_tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    const std::string ref_newick = ref_tree.exportNewick(Tree::BIN_TREE, false);
+
+    // an empty tree
+    Model model(ModelBase::GTR);
+    Tree empty_tree(&aln, &model);
+    std::ostringstream empty_stream;
+    EXPECT_THROW(empty_tree.placeQueries(empty_stream, 1, log_stream), std::logic_error);
+
+    // place the remaining 20 sequences onto the reference tree
+    std::istringstream tree_stream(ref_newick);
+    Tree tree(&aln, &model, tree_stream);
+    EXPECT_THROW(tree.placeQueries(empty_stream, -1, log_stream), std::invalid_argument);
+    const RealNumType lh = tree.computeLh();
+    const std::string newick = tree.exportNewick(Tree::BIN_TREE, false);
+    std::ostringstream jplace_stream;
+    tree.placeQueries(jplace_stream, 1, log_stream);
+    const std::string jplace = jplace_stream.str();
+
+    // the tree is unchanged
+    EXPECT_EQ(tree.exportNewick(Tree::BIN_TREE, false), newick);
+    EXPECT_EQ(tree.computeLh(), lh);
+
+    // one placement per query
+    EXPECT_NE(jplace.find("\"version\": 3"), std::string::npos);
+    EXPECT_NE(jplace.find("\"fields\": [\"edge_num\", \"likelihood\""), std::string::npos);
+    std::string::size_type num_placements = 0;
+    for (std::string::size_type pos = jplace.find("\"p\": [["); pos != std::string::npos;
+         pos = jplace.find("\"p\": [[", pos + 1))
+        ++num_placements;
+    EXPECT_EQ(num_placements, 20);
+    for (std::vector<Sequence>::size_type i = 80; i < aln.data.size(); ++i)
+        EXPECT_NE(jplace.find("\"n\": [\"" + aln.data[i].seq_name + "\"]"), std::string::npos);
+    for (std::vector<Sequence>::size_type i = 0; i < 80; ++i)
+        EXPECT_EQ(jplace.find("\"n\": [\"" + aln.data[i].seq_name + "\"]"), std::string::npos);
+
+    // placing a single query approximates the likelihood of the tree after
+    // adding the query to the tree (the query with the most mutations, which is
+    // not less informative than the sequences in the tree)
+    std::vector<Sequence> single_sequences = copySequences(80);
+    const Sequence& query = *std::max_element(aln.data.begin() + 80, aln.data.end(),
+        [](const Sequence& seq_1, const Sequence& seq_2) { return seq_1.size() < seq_2.size(); });
+    single_sequences.emplace_back(std::string(query.seq_name), std::vector<Mutation>(query.begin(), query.end()));
+    Alignment single_aln(std::move(single_sequences), ref_seq);
+    Model single_model(ModelBase::GTR);
+    std::istringstream single_tree_stream(ref_newick);
+    Tree single_tree(&single_aln, &single_model, single_tree_stream);
+    const RealNumType single_lh = single_tree.computeLh();
+    std::ostringstream single_stream;
+    single_tree.placeQueries(single_stream, 1, log_stream);
+    const std::string single_jplace = single_stream.str();
+    std::istringstream fields_stream(single_jplace.substr(single_jplace.find("[[") + 2));
+    RealNumType edge_num, placement_lh;
+    char separator;
+    fields_stream >> edge_num >> separator >> placement_lh;
+    EXPECT_LT(placement_lh, single_lh);
+    single_tree.doPlacement(log_stream);
+    EXPECT_NEAR(placement_lh, single_tree.computeLh(), 1e-3 * fabs(single_lh));
+}
+
+/*
+ Test removeSamples()
+ */
+TEST(Tree, removeSamples)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    // the reference sequence is in the second line of the MAPLE file
+    std::ifstream maple_stream(example_dir + "test_100.maple");
+    std::string ref_seq;
+    std::getline(maple_stream, ref_seq);
+    std::getline(maple_stream, ref_seq);
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    const RealNumType lh = tree.computeLh();
+    const std::string newick = tree.exportNewick(Tree::BIN_TREE, false);
+
+    // invalid inputs, which leave the tree unchanged
+    std::vector<std::string> all_names;
+    for (const Sequence& sequence : aln.data)
+        all_names.push_back(sequence.seq_name);
+    EXPECT_THROW(tree.removeSamples({aln.data[0].seq_name, "unknown"}), std::invalid_argument);
+    EXPECT_THROW(tree.removeSamples(all_names), std::invalid_argument);
+    EXPECT_EQ(tree.exportNewick(Tree::BIN_TREE, false), newick);
+
+    // remove every third sample
+    std::vector<std::string> removed_names;
+    for (std::vector<Sequence>::size_type i = 0; i < aln.data.size(); i += 3)
+        removed_names.push_back(aln.data[i].seq_name);
+    tree.removeSamples(removed_names);
+    std::ostringstream placements;
+    tree.exportPlacements(all_names, placements);
+    std::istringstream placement_stream(placements.str());
+    std::string line;
+    for (std::vector<Sequence>::size_type i = 0; std::getline(placement_stream, line); ++i)
+        EXPECT_EQ(line == all_names[i] + "\tNA", i % 3 == 0);
+    const std::string pruned_newick = tree.exportNewick(Tree::BIN_TREE, false);
+    for (std::vector<Sequence>::size_type i = 0; i < aln.data.size(); ++i)
+        EXPECT_EQ(pruned_newick.find(aln.data[i].seq_name + ":") == std::string::npos, i % 3 == 0);
+    const RealNumType pruned_lh = tree.computeLh();
+    EXPECT_GT(pruned_lh, lh);
+
+    // the pruned tree is the same as the one read from its NEWICK string
+    std::vector<Sequence> remaining_sequences;
+    for (std::vector<Sequence>::size_type i = 0; i < aln.data.size(); ++i)
+        if (i % 3)
+            remaining_sequences.emplace_back(std::string(aln.data[i].seq_name),
+                                             std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end()));
+    Alignment remaining_aln(std::move(remaining_sequences), ref_seq);
+    model.fixParameters(true);
+    std::istringstream pruned_stream(pruned_newick);
+    Tree pruned_tree(&remaining_aln, &model, pruned_stream, true);
+    EXPECT_NEAR(pruned_tree.computeLh(), pruned_lh, 1e-3 * fabs(pruned_lh));
+
+    // the removed samples are not placed again, but their copies are (reusing
+    // the freed nodes)
+    tree.removeSamples({aln.data[1].seq_name});
+    removed_names.push_back(aln.data[1].seq_name);
+    const std::vector<std::string> copy_names = addSequenceCopies(aln, removed_names);
+    tree.doPlacement(log_stream);
+    EXPECT_EQ(countMissingPlacements(tree, removed_names), removed_names.size());
+    EXPECT_EQ(countMissingPlacements(tree, copy_names), 0);
+    EXPECT_NEAR(tree.computeLh(), lh, 1e-2 * fabs(lh));
+
+    // the removed samples are still excluded after changing the alignment
+    tree.changeAln(&aln);
+    tree.doPlacement(log_stream);
+    EXPECT_EQ(countMissingPlacements(tree, removed_names), removed_names.size());
+    std::ostringstream jplace_stream;
+    tree.placeQueries(jplace_stream, 1, log_stream);
+    EXPECT_EQ(jplace_stream.str().find("\"" + removed_names[0] + "\""), std::string::npos);
+
+    // and after restoring a checkpoint
+    std::stringstream checkpoint_stream;
+    tree.saveCheckpoint(checkpoint_stream);
+    Model restored_model(ModelBase::GTR);
+    Tree restored_tree(&aln, &restored_model);
+    restored_tree.loadCheckpoint(checkpoint_stream);
+    restored_tree.doPlacement(log_stream);
+    EXPECT_EQ(countMissingPlacements(restored_tree, removed_names), removed_names.size());
+}
+
+/*
+ * Test removeSamples() on a sample representing less-informative sequences
+ */
+TEST(Tree, removeSamplesLessInfo)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.doPlacement(log_stream);
+
+    // select a sample represented by a leaf without less-informative sequences
+    std::vector<std::string> less_info_names;
+    const Sequence* sample = nullptr;
+    for (const Sequence& sequence : aln.data)
+        if (TreeTester::getLessInfoSeqNames(tree, sequence.seq_name, less_info_names) && less_info_names.empty())
+        {
+            sample = &sequence;
+            break;
+        }
+    ASSERT_NE(sample, nullptr);
+
+    // find two regions of 10 sites without any mutation of the sample
+    std::vector<PositionType> region_starts;
+    PositionType free_start = 0;
+    for (const Mutation& mutation : *sample)
+    {
+        while (region_starts.size() < 2 && mutation.position >= free_start + 10)
+        {
+            region_starts.push_back(free_start);
+            free_start += 10;
+        }
+        free_start = std::max(free_start, mutation.position + mutation.getLength());
+    }
+    while (region_starts.size() < 2)
+    {
+        region_starts.push_back(free_start);
+        free_start += 10;
+    }
+
+    // copies of the sample with missing data in the first region (B), the second region (C), or both (A)
+    const std::vector<Mutation> sample_mutations(sample->begin(), sample->end());
+    auto add_copy = [&aln, &sample_mutations](const std::string& name,
+                                              const std::vector<PositionType>& missing_starts) {
+        std::vector<Mutation> mutations(sample_mutations);
+        for (const PositionType start : missing_starts)
+            mutations.emplace_back(TYPE_N, start, 10);
+        std::sort(mutations.begin(), mutations.end(),
+                  [](const Mutation& a, const Mutation& b) { return a.position < b.position; });
+        std::vector<Sequence> sequences;
+        sequences.emplace_back(std::string(name), std::move(mutations));
+        aln.addSequences(std::move(sequences));
+    };
+    const std::string sample_name = sample->seq_name;
+    const std::string name_a = sample_name + "_a";
+    const std::string name_b = sample_name + "_b";
+    const std::string name_c = sample_name + "_c";
+    add_copy(name_a, region_starts);
+    tree.doPlacement(log_stream);
+    add_copy(name_b, {region_starts[0]});
+    tree.doPlacement(log_stream);
+    add_copy(name_c, {region_starts[1]});
+    tree.doPlacement(log_stream);
+    ASSERT_TRUE(TreeTester::getLessInfoSeqNames(tree, sample_name, less_info_names));
+    ASSERT_EQ(less_info_names, std::vector<std::string>({name_a, name_b, name_c}));
+
+    // B (more informative than A, the first of them) takes the place of the sample and keeps A; C (not less
+    // informative than B) is placed again
+    tree.removeSamples({sample_name});
+    EXPECT_FALSE(TreeTester::getLessInfoSeqNames(tree, sample_name, less_info_names));
+    ASSERT_TRUE(TreeTester::getLessInfoSeqNames(tree, name_b, less_info_names));
+    EXPECT_EQ(less_info_names, std::vector<std::string>({name_a}));
+    EXPECT_EQ(countMissingPlacements(tree, {name_a, name_b, name_c}), 1);
+    tree.doPlacement(log_stream);
+    EXPECT_EQ(countMissingPlacements(tree, {name_a, name_b, name_c}), 0);
+    EXPECT_TRUE(TreeTester::getLessInfoSeqNames(tree, name_c, less_info_names));
+    EXPECT_EQ(countMissingPlacements(tree, {sample_name}), 1);
+}
+
+/*
+ * Test changeAln() with an alignment sharing the reference sequence
+ */
+TEST(Tree, changeAlnAppended)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    // the reference sequence is in the second line of the MAPLE file
+    std::ifstream maple_stream(example_dir + "test_100.maple");
+    std::string ref_seq;
+    std::getline(maple_stream, ref_seq);
+    std::getline(maple_stream, ref_seq);
+
+    // build a tree from the first 60 sequences
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    std::vector<Sequence> first_sequences;
+    for (std::vector<Sequence>::size_type i = 0; i < 60; ++i)
+        first_sequences.emplace_back(std::string(aln.data[i].seq_name),
+                                     std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end()));
+    Alignment first_aln(std::move(first_sequences), ref_seq);
+    Model model(ModelBase::GTR);
+    Tree tree(&first_aln, &model);
+    tree.doPlacement(log_stream);
+    const RealNumType lh = tree.computeLh();
+    const std::string newick = tree.exportNewick(Tree::BIN_TREE, false);
+
+    // the existing partial likelihoods and model params are kept
+    std::vector<std::string> all_names;
+    for (const Sequence& sequence : aln.data)
+        all_names.push_back(sequence.seq_name);
+    tree.changeAln(&aln);
+    EXPECT_EQ(tree.computeLh(), lh);
+    EXPECT_EQ(tree.exportNewick(Tree::BIN_TREE, false), newick);
+    std::ostringstream placements;
+    tree.exportPlacements(all_names, placements);
+    std::istringstream placement_stream(placements.str());
+    std::string line;
+    for (std::vector<Sequence>::size_type i = 0; std::getline(placement_stream, line); ++i)
+        EXPECT_EQ(line == all_names[i] + "\tNA", i >= 60);
+
+    // only the new sequences are placed
+    tree.doPlacement(log_stream);
+    placements.str("");
+    tree.exportPlacements(all_names, placements);
+    EXPECT_EQ(placements.str().find("\tNA"), std::string::npos);
+    const RealNumType placed_lh = tree.computeLh();
+
+    // a reordered alignment is re-mapped and leads to the same tree
+    std::vector<Sequence> reversed_sequences;
+    for (std::vector<Sequence>::size_type i = aln.data.size(); i > 0; --i)
+        reversed_sequences.emplace_back(std::string(aln.data[i - 1].seq_name),
+                                        std::vector<Mutation>(aln.data[i - 1].begin(), aln.data[i - 1].end()));
+    Alignment reversed_aln(std::move(reversed_sequences), ref_seq);
+    tree.changeAln(&reversed_aln);
+    EXPECT_NEAR(tree.computeLh(), placed_lh, 1e-3 * fabs(placed_lh));
+    placements.str("");
+    tree.exportPlacements(all_names, placements);
+    EXPECT_EQ(placements.str().find("\tNA"), std::string::npos);
+
+    // changing the mutations of the sequences in the tree (with the same
+    // reference) refreshes the partial likelihoods as loading the tree does
+    std::vector<Sequence> changed_sequences;
+    for (std::vector<Sequence>::size_type i = 0; i < aln.data.size(); ++i)
+    {
+        const Sequence& mutations = aln.data[(i + 1) % aln.data.size()];
+        changed_sequences.emplace_back(std::string(aln.data[i].seq_name),
+                                       std::vector<Mutation>(mutations.begin(), mutations.end()));
+    }
+    Alignment changed_aln(std::move(changed_sequences), ref_seq);
+    const std::string placed_newick = tree.exportNewick(Tree::BIN_TREE, true);
+    std::istringstream tree_stream(placed_newick);
+    Model loaded_model(ModelBase::JC);
+    Tree loaded_tree(&changed_aln, &loaded_model, tree_stream, true);
+    tree_stream.clear();
+    tree_stream.str(placed_newick);
+    Model changed_model(ModelBase::JC);
+    Tree changed_tree(&aln, &changed_model, tree_stream, true);
+    const RealNumType unchanged_lh = changed_tree.computeLh();
+    changed_tree.changeAln(&changed_aln);
+    EXPECT_NE(changed_tree.computeLh(), unchanged_lh);
+    EXPECT_NEAR(changed_tree.computeLh(), loaded_tree.computeLh(),
+                1e-6 * fabs(placed_lh));
+}
+
+/*
+ * Test seeding sample placements from the inverted index of mutations
+ */
+TEST(Tree, seedPlacement)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    const RealNumType lh = tree.computeLh();
+
+    Model seeded_model(ModelBase::GTR);
+    Tree seeded_tree(&aln, &seeded_model);
+    seeded_tree.params->seed_placement = true;
+    seeded_tree.params->seed_rare_mutation_limit = 5;
+    seeded_tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    const RealNumType seeded_lh = seeded_tree.computeLh();
+    EXPECT_NEAR(seeded_lh, lh, 1e-2 * fabs(lh));
+
+    // the index stays consistent after the SPR moves and the removals
+    std::vector<std::string> all_names;
+    for (const Sequence& sequence : aln.data)
+        all_names.push_back(sequence.seq_name);
+    std::vector<std::string> removed_names;
+    for (std::vector<Sequence>::size_type i = 1; i < aln.data.size(); i += 4)
+        removed_names.push_back(aln.data[i].seq_name);
+    seeded_tree.removeSamples(removed_names);
+    const std::vector<std::string> copy_names = addSequenceCopies(aln, removed_names);
+    seeded_tree.doPlacement(log_stream);
+    EXPECT_EQ(countMissingPlacements(seeded_tree, all_names), removed_names.size());
+    EXPECT_EQ(countMissingPlacements(seeded_tree, copy_names), 0);
+    EXPECT_NEAR(seeded_tree.computeLh(), seeded_lh, 1e-2 * fabs(seeded_lh));
+
+    EXPECT_TRUE(TreeTester::isMutationIndexConsistent(seeded_tree));
+
+    // and after collapsing the zero-length leaves: the new samples (which
+    // differ from their closest samples) are all placed into the tree
+    seeded_tree.makeTreeInOutConsistent();
+    EXPECT_TRUE(TreeTester::isMutationIndexConsistent(seeded_tree));
+    std::vector<Sequence> variants;
+    std::vector<std::string> variant_names;
+    for (std::vector<Sequence>::size_type i = 0; i < 100; ++i)
+        if (aln.data[i].size() > 1)
+        {
+            variant_names.push_back(aln.data[i].seq_name + "_variant");
+            variants.emplace_back(std::string(variant_names.back()),
+                                  std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end() - 1));
+        }
+    aln.addSequences(std::move(variants));
+    seeded_tree.doPlacement(log_stream);
+    const std::string seeded_newick = seeded_tree.exportNewick(Tree::BIN_TREE, false);
+    for (const std::string& name : variant_names)
+        EXPECT_NE(seeded_newick.find(name + ":"), std::string::npos) << name;
+    EXPECT_TRUE(TreeTester::isMutationIndexConsistent(seeded_tree));
+}
+
+/*
+ * Test attaching identical sequences directly to the leaves holding them
+ */
+TEST(Tree, placeIdenticalSequences)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    // the reference sequence is in the second line of the MAPLE file
+    std::ifstream maple_stream(example_dir + "test_100.maple");
+    std::string ref_seq;
+    std::getline(maple_stream, ref_seq);
+    std::getline(maple_stream, ref_seq);
+
+    // duplicate every fifth sequence
+    Alignment aln(example_dir + "test_100.maple");
+    std::vector<Sequence> sequences;
+    for (std::vector<Sequence>::size_type i = 0; i < aln.data.size(); ++i)
+    {
+        sequences.emplace_back(std::string(aln.data[i].seq_name),
+                               std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end()));
+        if (i % 5 == 0)
+            sequences.emplace_back(aln.data[i].seq_name + "_copy",
+                                   std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end()));
+    }
+    Alignment duplicated_aln(std::move(sequences), ref_seq);
+
+    std::ostringstream log_stream;
+    Model model(ModelBase::GTR);
+    Tree tree(&duplicated_aln, &model);
+    tree.doPlacement(log_stream);
+
+    // each copy is a minor sequence of the leaf holding its original (or vice
+    // versa)
+    std::vector<std::string> names;
+    for (const Sequence& sequence : duplicated_aln.data)
+        names.push_back(sequence.seq_name);
+    std::ostringstream placements;
+    tree.exportPlacements(names, placements);
+    std::map<std::string, std::string> holders;
+    std::istringstream placement_stream(placements.str());
+    std::string line;
+    while (std::getline(placement_stream, line))
+    {
+        std::istringstream fields(line);
+        std::string name, pendant, close_sample;
+        fields >> name >> pendant >> close_sample;
+        ASSERT_NE(pendant, "NA");
+        holders[name] = pendant == "0" ? close_sample : name;
+    }
+    for (std::vector<Sequence>::size_type i = 0; i < aln.data.size(); i += 5)
+    {
+        const std::string& name = aln.data[i].seq_name;
+        const std::string copy_name = name + "_copy";
+        EXPECT_TRUE(holders[copy_name] == holders[name] || holders[copy_name] == name ||
+                    holders[name] == copy_name);
+    }
+}
+
+/*
+ * Test pre-placing samples in the parsimony neighbourhood of their closest leaves
+ */
+TEST(Tree, parsimonyPlacement)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    const RealNumType lh = tree.computeLh();
+
+    std::vector<std::string> all_names;
+    for (const Sequence& sequence : aln.data)
+        all_names.push_back(sequence.seq_name);
+    for (const int radius : {0, 2})
+    {
+        Model pars_model(ModelBase::GTR);
+        Tree pars_tree(&aln, &pars_model);
+        pars_tree.params->parsimony_placement_radius = radius;
+        pars_tree.params->seed_rare_mutation_limit = 5;
+        pars_tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+        EXPECT_NEAR(pars_tree.computeLh(), lh, 1e-2 * fabs(lh));
+
+        std::ostringstream placements;
+        pars_tree.exportPlacements(all_names, placements);
+        EXPECT_EQ(placements.str().find("\tNA"), std::string::npos);
+    }
+
+    // a sample sharing rare mutations with the leaves starts above one of
+    // them, and only searches 2 * radius levels below
+    const int radius = 1;
+    Alignment start_aln(example_dir + "test_100.maple");
+    Model start_model(ModelBase::GTR);
+    Tree start_tree(&start_aln, &start_model);
+    start_tree.params->parsimony_placement_radius = radius;
+    start_tree.params->seed_rare_mutation_limit = 5;
+    start_tree.doPlacement(log_stream);
+    const NumSeqsType root = TreeTester::getRoot(start_tree);
+    std::size_t num_seeded_samples = 0;
+    std::vector<Mutation> common_mutations;
+    for (NumSeqsType i = 0; i < start_aln.data.size(); ++i)
+    {
+        const Sequence& sequence = start_aln.data[i];
+        bool has_rare_mutation = false;
+        for (const Mutation& mutation : sequence)
+            if (mutation.type < start_aln.num_states)
+            {
+                if (TreeTester::isRareMutation(start_tree, mutation))
+                    has_rare_mutation = true;
+                else if (common_mutations.empty() || common_mutations.back().position < mutation.position)
+                    common_mutations.push_back(mutation);
+            }
+        if (!has_rare_mutation)
+            continue;
+
+        int max_depth = 0;
+        const NumSeqsType start = TreeTester::selectPlacementStart(start_tree, i, max_depth);
+        EXPECT_EQ(max_depth, radius + radius);
+        EXPECT_TRUE(TreeTester::isAncestorOfRelatedLeaf(start_tree, start, i)) << sequence.seq_name;
+        ++num_seeded_samples;
+    }
+    EXPECT_GT(num_seeded_samples, 0);
+    ASSERT_FALSE(common_mutations.empty());
+
+    // samples sharing no rare mutations with the leaves start from the root
+    // (without a depth limit)
+    std::vector<Sequence> unrelated_samples;
+    unrelated_samples.emplace_back("no_mutations", std::vector<Mutation>());
+    unrelated_samples.emplace_back("common_mutations", std::vector<Mutation>(common_mutations));
+    start_aln.addSequences(std::move(unrelated_samples));
+    for (NumSeqsType i = start_aln.data.size() - 2; i < start_aln.data.size(); ++i)
+    {
+        int max_depth = 0;
+        EXPECT_EQ(TreeTester::selectPlacementStart(start_tree, i, max_depth), root);
+        EXPECT_EQ(max_depth, -1);
+    }
+}
+
+/*
+ * Test skipping the subtrees that cannot hold the best sample placements
+ */
+TEST(Tree, boundPlacement)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.doPlacement(log_stream);
+    const RealNumType lh = tree.computeLh();
+
+    Model bound_model(ModelBase::GTR);
+    Tree bound_tree(&aln, &bound_model);
+    bound_tree.params->bound_placement = true;
+    bound_tree.doPlacement(log_stream);
+    const RealNumType bound_lh = bound_tree.computeLh();
+    EXPECT_NEAR(bound_lh, lh, 1e-2 * fabs(lh));
+
+    // the masks are rebuilt after the tree changes
+    bound_tree.infer(Tree::NORMAL_TREE_SEARCH, false, log_stream);
+    std::vector<std::string> all_names;
+    for (const Sequence& sequence : aln.data)
+        all_names.push_back(sequence.seq_name);
+    std::vector<std::string> removed_names;
+    for (std::vector<Sequence>::size_type i = 2; i < aln.data.size(); i += 3)
+        removed_names.push_back(aln.data[i].seq_name);
+    bound_tree.removeSamples(removed_names);
+    const std::vector<std::string> copy_names = addSequenceCopies(aln, removed_names);
+    bound_tree.doPlacement(log_stream);
+    EXPECT_EQ(countMissingPlacements(bound_tree, all_names), removed_names.size());
+    EXPECT_EQ(countMissingPlacements(bound_tree, copy_names), 0);
+
+    // the bound is never below the costs of placing a new sample (with any
+    // branch length) in the subtree below a node, and some subtrees cannot
+    // hold the best placement
+    std::ifstream maple_stream(example_dir + "test_100.maple");
+    std::string ref_seq;
+    std::getline(maple_stream, ref_seq);
+    std::getline(maple_stream, ref_seq);
+    std::vector<Sequence> first_sequences;
+    for (std::vector<Sequence>::size_type i = 0; i < 60; ++i)
+        first_sequences.emplace_back(std::string(aln.data[i].seq_name),
+                                     std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end()));
+    Alignment first_aln(std::move(first_sequences), ref_seq);
+    Model first_model(ModelBase::GTR);
+    Tree first_tree(&first_aln, &first_model);
+    first_tree.params->bound_placement = true;
+    first_tree.doPlacement(log_stream);
+    std::vector<Sequence> new_sequences;
+    for (std::vector<Sequence>::size_type i = 60; i < 100; ++i)
+        new_sequences.emplace_back(std::string(aln.data[i].seq_name),
+                                   std::vector<Mutation>(aln.data[i].begin(), aln.data[i].end()));
+    first_aln.addSequences(std::move(new_sequences));
+    TreeTester::buildMutationMasks(first_tree);
+    std::size_t num_pruned_subtrees = 0;
+    for (NumSeqsType seq_index = 60; seq_index < first_aln.data.size(); ++seq_index)
+    {
+        const std::map<NumSeqsType, RealNumType> costs =
+            TreeTester::calculateSubtreePlacementCosts(first_tree, seq_index);
+        const RealNumType best_cost = costs.at(TreeTester::getRoot(first_tree));
+        for (const auto& [vec_index, cost] : costs)
+        {
+            const RealNumType bound = TreeTester::boundSamplePlacementCost(first_tree, vec_index, seq_index);
+            EXPECT_GE(bound, cost) << first_aln.data[seq_index].seq_name;
+            num_pruned_subtrees += bound <= best_cost;
+        }
+    }
+    EXPECT_GT(num_pruned_subtrees, 0);
+}
+
+/*
+ * Test placing groups of similar samples one after another
+ */
+TEST(Tree, clusterPlacementOrder)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.doPlacement(log_stream);
+    const RealNumType lh = tree.computeLh();
+
+    Model cluster_model(ModelBase::GTR);
+    Tree cluster_tree(&aln, &cluster_model);
+    cluster_tree.params->cluster_placement_order = true;
+    cluster_tree.doPlacement(log_stream);
+    EXPECT_NEAR(cluster_tree.computeLh(), lh, 1e-2 * fabs(lh));
+
+    std::vector<std::string> all_names;
+    for (const Sequence& sequence : aln.data)
+        all_names.push_back(sequence.seq_name);
+    std::ostringstream placements;
+    cluster_tree.exportPlacements(all_names, placements);
+    EXPECT_EQ(placements.str().find("\tNA"), std::string::npos);
+
+    // the order is a permutation of the samples (with the first sample first),
+    // where the samples with the same MinHash (e.g., copies of the same
+    // sample) are placed one after another
+    std::vector<std::string> copied_names;
+    for (std::vector<Sequence>::size_type i = 0; i < aln.data.size(); i += 10)
+        copied_names.push_back(aln.data[i].seq_name);
+    addSequenceCopies(aln, copied_names);
+    const std::vector<NumSeqsType> placement_order = TreeTester::computePlacementOrder(cluster_tree);
+    ASSERT_EQ(placement_order.size(), aln.data.size());
+    EXPECT_EQ(placement_order.front(), 0);
+    std::vector<NumSeqsType> sorted_order = placement_order;
+    std::sort(sorted_order.begin(), sorted_order.end());
+    for (std::vector<NumSeqsType>::size_type i = 0; i < sorted_order.size(); ++i)
+        EXPECT_EQ(sorted_order[i], i);
+    std::map<std::uint64_t, std::vector<std::size_t>> group_positions;
+    for (std::vector<NumSeqsType>::size_type i = 0; i < placement_order.size(); ++i)
+        group_positions[TreeTester::computeMutationMinHash(cluster_tree, placement_order[i])].push_back(i);
+    std::size_t num_shared_groups = 0;
+    for (const auto& [min_hash, positions] : group_positions)
+    {
+        EXPECT_EQ(positions.back() - positions.front() + 1, positions.size());
+        num_shared_groups += positions.size() > 1;
+    }
+    EXPECT_GT(num_shared_groups, 0);
+}
+
+/*
+ * Test starting sample placements next to those of recent similar samples
+ */
+TEST(Tree, placementHints)
+{
+    // detect the path to the example directory
+    std::string example_dir = "../../example/";
+    if (!fileExists(example_dir + "example.maple"))
+        example_dir = "../example/";
+
+    std::ostringstream log_stream;
+    Alignment aln(example_dir + "test_100.maple");
+    Model model(ModelBase::GTR);
+    Tree tree(&aln, &model);
+    tree.doPlacement(log_stream);
+    const RealNumType lh = tree.computeLh();
+
+    std::vector<std::string> all_names;
+    for (const Sequence& sequence : aln.data)
+        all_names.push_back(sequence.seq_name);
+    for (const bool cluster_placement_order : {false, true})
+    {
+        Model hint_model(ModelBase::GTR);
+        Tree hint_tree(&aln, &hint_model);
+        hint_tree.params->placement_hint_distance = 2;
+        hint_tree.params->cluster_placement_order = cluster_placement_order;
+        hint_tree.doPlacement(log_stream);
+        EXPECT_NEAR(hint_tree.computeLh(), lh, 1e-2 * fabs(lh));
+
+        std::ostringstream placements;
+        hint_tree.exportPlacements(all_names, placements);
+        EXPECT_EQ(placements.str().find("\tNA"), std::string::npos);
+    }
+
+    // new samples: a sample (with one more mutation than an existing one), a
+    // sample with one more mutation than that (placed next to it), and a
+    // sample with only two mutations (and missing data elsewhere) of a
+    // distant sample: the local search next to the previous samples fails
+    const Sequence& sample = aln.data[10];
+    const auto carries_position = [](const Sequence& sequence, const PositionType position) {
+        return std::any_of(sequence.begin(), sequence.end(), [position](const Mutation& mutation) {
+            return mutation.position <= position && position < mutation.position + mutation.getLength();
+        });
+    };
+    std::vector<Mutation> extra_mutations;
+    for (PositionType position = 1000; extra_mutations.size() < 2; position += 1000)
+        if (!carries_position(sample, position))
+            extra_mutations.emplace_back(static_cast<StateType>((aln.ref_seq[position] + 1) % 4), position);
+    std::vector<Mutation> one_more_mutations(sample.begin(), sample.end());
+    std::vector<Mutation> two_more_mutations = one_more_mutations;
+    one_more_mutations.push_back(extra_mutations[0]);
+    two_more_mutations.insert(two_more_mutations.end(), extra_mutations.begin(), extra_mutations.end());
+    for (std::vector<Mutation>* mutations : {&one_more_mutations, &two_more_mutations})
+        std::sort(mutations->begin(), mutations->end(),
+                  [](const Mutation& mutation_1, const Mutation& mutation_2) {
+                      return mutation_1.position < mutation_2.position;
+                  });
+    std::vector<Mutation> distant_mutations;
+    for (auto it = aln.data.rbegin(); it != aln.data.rend() && distant_mutations.size() < 2; ++it)
+    {
+        distant_mutations.clear();
+        for (const Mutation& mutation : *it)
+            if (mutation.type < aln.num_states && !carries_position(sample, mutation.position) &&
+                distant_mutations.size() < 2)
+                distant_mutations.push_back(mutation);
+    }
+    ASSERT_EQ(distant_mutations.size(), 2);
+    const PositionType seq_length = static_cast<PositionType>(aln.ref_seq.size());
+    std::vector<Mutation> missing_mutations;
+    PositionType position = 0;
+    for (const Mutation& mutation : distant_mutations)
+    {
+        if (mutation.position > position)
+            missing_mutations.emplace_back(TYPE_N, position, mutation.position - position);
+        missing_mutations.push_back(mutation);
+        position = mutation.position + 1;
+    }
+    missing_mutations.emplace_back(TYPE_N, position, seq_length - position);
+
+    Model new_model(ModelBase::GTR);
+    Tree new_tree(&aln, &new_model);
+    new_tree.doPlacement(log_stream);
+    std::vector<Sequence> new_samples;
+    new_samples.emplace_back("one_more_mutation", std::move(one_more_mutations));
+    new_samples.emplace_back("two_more_mutations", std::move(two_more_mutations));
+    new_samples.emplace_back("distant_mutations", std::move(missing_mutations));
+    aln.addSequences(std::move(new_samples));
+    new_tree.params->placement_hint_distance = 2;
+    const cmaple::VerboseMode verbose_mode = cmaple::verbose_mode;
+    cmaple::verbose_mode = cmaple::VB_MED;
+    std::ostringstream hint_log_stream;
+    new_tree.doPlacement(hint_log_stream);
+    cmaple::verbose_mode = verbose_mode;
+    EXPECT_NE(hint_log_stream.str().find("Placed 1 samples next to the placements of similar samples "
+                                         "(1 local searches fell back)"),
+              std::string::npos) << hint_log_stream.str();
+    EXPECT_EQ(countMissingPlacements(new_tree, {"one_more_mutation", "two_more_mutations", "distant_mutations"}),
+              0);
+}
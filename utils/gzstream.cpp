@@ -181,6 +181,27 @@ auto gzstreambuf::sync() -> int {
   return 0;
 }
 
+auto gzstreambuf::seekoff(std::streamoff off, std::ios_base::seekdir dir,
+                          std::ios_base::openmode which) -> std::streampos {
+  if (off || dir != std::ios_base::beg) {
+    return {std::streamoff(-1)};
+  }
+  return seekpos(0, which);
+}
+
+auto gzstreambuf::seekpos(std::streampos pos, std::ios_base::openmode which)
+    -> std::streampos {
+  // rewind (and decompress again from) the beginning of the input file
+  if (pos != std::streampos(0) || !(which & std::ios_base::in) ||
+      !(static_cast<unsigned int>(mode) & std::ios::in) || !opened ||
+      gzrewind(file)) {
+    return {std::streamoff(-1)};
+  }
+  compressed_position = 0;
+  setg(buffer + 4, buffer + 4, buffer + 4);
+  return pos;
+}
+
 auto gzstreambuf::getCompressedLength() -> size_t { return compressed_length; }
 
 auto gzstreambuf::getCompressedPosition() -> size_t {
@@ -76,6 +76,11 @@ public:
     virtual int     overflow( int c = EOF);
     virtual int     underflow();
     virtual int     sync();
+    // only rewinding an input stream (to position 0) is supported
+    virtual std::streampos seekoff( std::streamoff off, std::ios_base::seekdir dir,
+                                    std::ios_base::openmode which = std::ios_base::in);
+    virtual std::streampos seekpos( std::streampos pos,
+                                    std::ios_base::openmode which = std::ios_base::in);
 
     size_t getCompressedLength();
     size_t getCompressedPosition();
@@ -173,6 +173,45 @@ cmaple::RealNumType matrixEvolve(const cmaple::RealNumType* const vec1,
   return result;
 }
 
+// Closed-form kernels for JC-like rate matrices, i.e., q_ii = -1 and
+// q_ij = 1 / (length - 1) for all i != j (the matrix is symmetric, so it equals
+// its transposed matrix). They replace the matrix products by a sum over the
+// vector.
+
+// Compute the sum of all entries of a vector
+template <cmaple::StateType length>
+inline cmaple::RealNumType sumVec(const cmaple::RealNumType* const vec)
+{
+  cmaple::RealNumType result{ 0 };
+  for (cmaple::StateType j = 0; j < length; ++j)
+    result += vec[j];
+  return result;
+}
+
+// Compute dotProduct(mutation_mat_row_i, vec) for a JC-like rate matrix,
+// given sum_vec = sum of all entries of vec
+template <cmaple::StateType length>
+inline cmaple::RealNumType dotProductJC(const cmaple::RealNumType* const vec,
+                                        const cmaple::RealNumType sum_vec,
+                                        const cmaple::StateType i)
+{
+  constexpr cmaple::RealNumType inverse_num_diff_states = 1.0 / (length - 1);
+  return (sum_vec - length * vec[i]) * inverse_num_diff_states;
+}
+
+// The same as matrixEvolve() but for a JC-like rate matrix
+template <cmaple::StateType length>
+cmaple::RealNumType matrixEvolveJC(const cmaple::RealNumType* const vec1,
+                                   const cmaple::RealNumType* const vec2,
+                                   const cmaple::RealNumType total_blength)
+{
+  const cmaple::RealNumType sum_vec2 = sumVec<length>(vec2);
+  cmaple::RealNumType result{ 0 };
+  for (cmaple::StateType i = 0; i < length; ++i)
+    result += vec1[i] * (vec2[i] + total_blength * dotProductJC<length>(vec2, sum_vec2, i));
+  return result;
+}
+
 template <cmaple::StateType length>
 cmaple::RealNumType matrixEvolveRoot(const cmaple::RealNumType* const vec2,
                                      const cmaple::StateType seq1_state,
@@ -207,6 +246,27 @@ cmaple::RealNumType matrixEvolveRoot(const cmaple::RealNumType* const vec2,
   return result;
 }
 
+// The same as matrixEvolveRoot() but for a JC-like rate matrix
+template <cmaple::StateType length>
+cmaple::RealNumType matrixEvolveRootJC(const cmaple::RealNumType* const vec2,
+                                       const cmaple::StateType seq1_state,
+                                       const cmaple::RealNumType* model_root_freqs,
+                                       const cmaple::RealNumType* transposed_mut_mat_row,
+                                       const cmaple::RealNumType total_blength,
+                                       const cmaple::RealNumType seq1_region_plength_observation2node)
+{
+  const cmaple::RealNumType sum_vec2 = sumVec<length>(vec2);
+  cmaple::RealNumType result{ 0 };
+  for (cmaple::StateType i = 0; i < length; ++i)
+  {
+    cmaple::RealNumType tot2 = model_root_freqs[i] * transposed_mut_mat_row[i] * seq1_region_plength_observation2node;
+    if (seq1_state == i)
+      tot2 += model_root_freqs[i];
+    result += tot2 * (vec2[i] + total_blength * dotProductJC<length>(vec2, sum_vec2, i));
+  }
+  return result;
+}
+
 template <cmaple::StateType length>
 cmaple::RealNumType updateVecWithState(cmaple::RealNumType* const update_vec, const cmaple::StateType seq1_state,
                                const cmaple::RealNumType* const vec,
@@ -237,7 +297,7 @@ void setVecWithState(cmaple::RealNumType* const set_vec, const cmaple::StateType
 
 template <cmaple::StateType length>
 void updateCoeffs(cmaple::RealNumType* const root_freqs,
-        cmaple::RealNumType* const transposed_mut_mat_row, cmaple::RealNumType* const likelihood,
+        cmaple::RealNumType* const transposed_mut_mat_row, const cmaple::RealNumType* const likelihood,
         cmaple::RealNumType* const mutation_mat_row, const cmaple::RealNumType factor,
         cmaple::RealNumType& coeff0, cmaple::RealNumType& coeff1)
 {
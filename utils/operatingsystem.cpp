@@ -11,6 +11,9 @@
 #if defined(WIN32) || defined(WIN64)
 #include <io.h>  //for _isatty
 #else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>  //for isatty
 #endif
 
@@ -38,3 +41,33 @@ auto isStandardOutputATerminal() -> bool {
   return isatty(fileno(stdout));
 #endif
 }
+
+MemoryMappedFile::MemoryMappedFile(const std::string& filename) {
+#if !defined(WIN32) && !defined(WIN64)
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+      file_stat.st_size > 0) {
+    void* const addr = mmap(nullptr, static_cast<size_t>(file_stat.st_size),
+                            PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      madvise(addr, static_cast<size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+      data_ = static_cast<const char*>(addr);
+      size_ = static_cast<std::size_t>(file_stat.st_size);
+    }
+  }
+  // the mapping remains valid after closing the file descriptor
+  close(fd);
+#endif
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+#if !defined(WIN32) && !defined(WIN64)
+  if (data_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+}
@@ -8,9 +8,33 @@
 #ifndef operatingsystem_h
 #define operatingsystem_h
 
+#include <cstddef>
 #include <string>
 
 std::string getOSName();
 bool isStandardOutputATerminal();
 
+/**
+ A read-only memory mapping of a whole file (POSIX only).
+ data() returns nullptr if the file could not be mapped (e.g., on Windows,
+ for an empty file, or a pipe), so that callers can fall back to streams.
+ */
+class MemoryMappedFile {
+ public:
+  explicit MemoryMappedFile(const std::string& filename);
+  ~MemoryMappedFile();
+  MemoryMappedFile(const MemoryMappedFile&) = delete;
+  MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+  /** Pointer to the first byte of the file, or nullptr if not mapped */
+  const char* data() const { return data_; }
+
+  /** Size of the file in bytes */
+  std::size_t size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
 #endif /* operatingsystem_h */
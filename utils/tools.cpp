@@ -24,6 +24,8 @@
  ***************************************************************************/
 
 #include "tools.h"
+#include <zlib.h>
+#include <charconv>
 #include "timeutil.h"
 
 // #include <filesystem>
@@ -161,6 +163,16 @@ std::string cmaple::convertDoubleToString(RealNumType number,
   return ss.str();  // return a string with the contents of the stream
 }
 
+void cmaple::appendDoubleToString(std::string& output,
+                                  RealNumType number,
+                                  uint8_t precision) {
+  // the general format is the same as the default format of streams (%g)
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number,
+                                    std::chars_format::general, precision);
+  output.append(buffer, result.ptr);
+}
+
 auto cmaple::iEquals(const string& a, const string& b) -> bool {
   unsigned int sz = static_cast<unsigned int>(a.size());
   if (b.size() != sz) {
@@ -194,6 +206,173 @@ auto cmaple::copyFile(const char SRC[], const char DEST[]) -> bool {
   return true;  // file copied successfully
 }
 
+auto cmaple::isGzipFile(const string& strFilename) -> bool {
+  ifstream in(strFilename, ios::binary);
+  unsigned char magic[2] = {0, 0};
+  in.read(reinterpret_cast<char*>(magic), 2);
+  return in.gcount() == 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+}
+
+auto cmaple::isBgzfFile(const string& strFilename) -> bool {
+  ifstream in(strFilename, ios::binary);
+  unsigned char header[12];
+  in.read(reinterpret_cast<char*>(header), sizeof(header));
+  if (in.gcount() != sizeof(header) || header[0] != 0x1f ||
+      header[1] != 0x8b || header[2] != 8 || !(header[3] & 4)) {
+    return false;
+  }
+
+  // look for the 'BC' subfield in the extra field
+  std::vector<unsigned char> extra(header[10] |
+                                   (static_cast<size_t>(header[11]) << 8));
+  in.read(reinterpret_cast<char*>(extra.data()),
+          static_cast<std::streamsize>(extra.size()));
+  if (static_cast<size_t>(in.gcount()) != extra.size()) {
+    return false;
+  }
+  for (size_t i = 0; i + 4 <= extra.size();) {
+    const size_t slen = extra[i + 2] | (static_cast<size_t>(extra[i + 3]) << 8);
+    if (extra[i] == 'B' && extra[i + 1] == 'C' && slen == 2) {
+      return true;
+    }
+    i += 4 + slen;
+  }
+  return false;
+}
+
+namespace {
+/** A BGZF block: the compressed data and the size of its uncompressed data */
+struct BgzfBlock {
+  size_t cdata_start;
+  size_t cdata_length;
+  size_t out_start;
+  uint32_t out_length;
+  uint32_t crc;
+};
+
+inline auto readUint16(const unsigned char* const p) -> uint32_t {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+inline auto readUint32(const unsigned char* const p) -> uint32_t {
+  return readUint16(p) | (readUint16(p + 2) << 16);
+}
+
+/**
+ Split a gzip file into BGZF blocks
+ @return false if the file is not in BGZF format
+ */
+auto splitBgzfBlocks(const string& compressed, std::vector<BgzfBlock>& blocks)
+    -> bool {
+  const auto* const data =
+      reinterpret_cast<const unsigned char*>(compressed.data());
+  const size_t size = compressed.size();
+  size_t out_start = 0;
+  for (size_t pos = 0; pos < size;) {
+    // header (18 bytes with the 'BC' subfield) + footer (8 bytes)
+    if (size - pos < 26 || data[pos] != 0x1f || data[pos + 1] != 0x8b ||
+        data[pos + 2] != 8 || !(data[pos + 3] & 4)) {
+      return false;
+    }
+    const size_t xlen = readUint16(data + pos + 10);
+    size_t block_size = 0;
+    for (size_t i = pos + 12; i + 4 <= pos + 12 + xlen && i + 4 <= size;) {
+      const size_t slen = readUint16(data + i + 2);
+      if (data[i] == 'B' && data[i + 1] == 'C' && slen == 2) {
+        block_size = readUint16(data + i + 4) + 1;
+      }
+      i += 4 + slen;
+    }
+    if (!block_size || block_size < 20 + xlen || pos + block_size > size) {
+      return false;
+    }
+    const unsigned char* const footer = data + pos + block_size - 8;
+    blocks.push_back({pos + 12 + xlen, block_size - xlen - 20, out_start,
+                      readUint32(footer + 4), readUint32(footer)});
+    out_start += blocks.back().out_length;
+    pos += block_size;
+  }
+  return true;
+}
+}  // namespace
+
+auto cmaple::readGzipFile(const string& strFilename) -> string {
+  // read the compressed file
+  ifstream in(strFilename, ios::binary);
+  if (!in) {
+    throw ios::failure(string(ERR_READ_INPUT) + " " + strFilename);
+  }
+  const string compressed((std::istreambuf_iterator<char>(in)),
+                          std::istreambuf_iterator<char>());
+  in.close();
+  const string err_msg = "Failed to decompress " + strFilename;
+
+  // BGZF: decompress independent blocks in parallel
+  std::vector<BgzfBlock> blocks;
+  if (splitBgzfBlocks(compressed, blocks)) {
+    string content(blocks.empty() ? 0
+                                  : blocks.back().out_start +
+                                        blocks.back().out_length,
+                   '\0');
+    bool failed = false;
+#pragma omp parallel for schedule(dynamic) reduction(||:failed)
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      const BgzfBlock& block = blocks[i];
+      z_stream zs{};
+      if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) {
+        failed = true;
+        continue;
+      }
+      zs.next_in = reinterpret_cast<Bytef*>(
+          const_cast<char*>(compressed.data() + block.cdata_start));
+      zs.avail_in = static_cast<uInt>(block.cdata_length);
+      zs.next_out = reinterpret_cast<Bytef*>(&content[block.out_start]);
+      zs.avail_out = block.out_length;
+      const int ret = inflate(&zs, Z_FINISH);
+      inflateEnd(&zs);
+      if ((ret != Z_STREAM_END || zs.avail_out) ||
+          crc32(0L, reinterpret_cast<const Bytef*>(&content[block.out_start]),
+                block.out_length) != block.crc) {
+        failed = true;
+      }
+    }
+    if (failed) {
+      throw ios::failure(err_msg);
+    }
+    return content;
+  }
+
+  // other gzip files: decompress (all members) sequentially
+  string content;
+  z_stream zs{};
+  // 16 + MAX_WBITS: expect gzip header
+  if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
+    throw ios::failure(err_msg);
+  }
+  zs.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  zs.avail_in = static_cast<uInt>(compressed.size());
+  std::vector<char> buffer(1 << 18);
+  for (;;) {
+    zs.next_out = reinterpret_cast<Bytef*>(buffer.data());
+    zs.avail_out = static_cast<uInt>(buffer.size());
+    const int ret = inflate(&zs, Z_NO_FLUSH);
+    content.append(buffer.data(), buffer.size() - zs.avail_out);
+    if (ret == Z_STREAM_END) {
+      // move to the next member (if any)
+      if (!zs.avail_in) {
+        break;
+      }
+      inflateReset(&zs);
+    } else if (ret != Z_OK) {
+      inflateEnd(&zs);
+      throw ios::failure(err_msg);
+    }
+  }
+  inflateEnd(&zs);
+  return content;
+}
+
 auto cmaple::fileExists(const string& strFilename) -> bool {
   struct stat stFileInfo;
   bool blnReturn;
@@ -598,6 +777,19 @@ cmaple::Params::Params() {
   seq_type_str = "AUTO";
   tree_search_type_str = "NORMAL";
   make_consistent = false;
+  checkpoint_filename = "";
+  checkpoint_interval = 300;
+  checkpoint_placement_period = 0;
+  resume = false;
+  query_placement = false;
+  server_mode = false;
+  server_socket = "";
+  seed_placement = false;
+  seed_rare_mutation_limit = 1000;
+  parsimony_placement_radius = -1;
+  bound_placement = false;
+  cluster_placement_order = false;
+  placement_hint_distance = -1;
 
   // initialize random seed based on current time
   struct timeval tv;
@@ -713,6 +905,35 @@ auto cmaple::ParamsBuilder::withStopTreeSearchThresh(
   return *this;
 }
 
+auto cmaple::ParamsBuilder::withCheckpoint(
+    const std::string& checkpoint_filename,
+    const double& interval) -> cmaple::ParamsBuilder& {
+  if (!checkpoint_filename.length()) {
+    throw std::invalid_argument("checkpoint_filename must not be empty");
+  }
+  if (interval < 0) {
+    throw std::invalid_argument("checkpoint interval must be non-negative");
+  }
+  params_ptr->checkpoint_filename = checkpoint_filename;
+  params_ptr->checkpoint_interval = interval;
+
+  // return
+  return *this;
+}
+
+auto cmaple::ParamsBuilder::withCheckpointPlacementPeriod(
+    const int32_t& checkpoint_placement_period) -> cmaple::ParamsBuilder& {
+  if (checkpoint_placement_period >= 0) {
+    params_ptr->checkpoint_placement_period = checkpoint_placement_period;
+  } else {
+    throw std::invalid_argument(
+        "checkpoint_placement_period must be non-negative");
+  }
+
+  // return
+  return *this;
+}
+
 std::unique_ptr<cmaple::Params> cmaple::ParamsBuilder::build() {
   return std::move(params_ptr);
 }
@@ -778,7 +999,7 @@ void cmaple::parseArg(int argc, char* argv[], Params& params) {
           if (cnt >= argc || argv[cnt][0] == '-') {
             outError(
                 "Use -out-format <ALN_FORMAT>. Note <ALN_FORMAT> "
-                "could be MAPLE, PHYLIP, or FASTA");
+                "could be MAPLE, PHYLIP, FASTA, or BINARY");
           }
 
           // parse inputs
@@ -824,7 +1045,7 @@ void cmaple::parseArg(int argc, char* argv[], Params& params) {
           strcmp(argv[cnt], "--aln-format") == 0) {
         cnt++;
         if (cnt >= argc) {
-          outError("Use -format MAPLE, PHYLIP, FASTA, or AUTO");
+          outError("Use -format MAPLE, PHYLIP, FASTA, BINARY, VCF, or AUTO");
         }
         params.aln_format_str = argv[cnt];
 
@@ -1003,6 +1224,147 @@ void cmaple::parseArg(int argc, char* argv[], Params& params) {
 
         continue;
       }
+      if (strcmp(argv[cnt], "--checkpoint-interval") == 0 ||
+          strcmp(argv[cnt], "-ckp-interval") == 0) {
+        ++cnt;
+        if (cnt >= argc || argv[cnt][0] == '-') {
+          outError("Use -ckp-interval <SECONDS>");
+        }
+
+        try {
+          params.checkpoint_interval = convert_real_number(argv[cnt]);
+        } catch (std::invalid_argument e) {
+          outError(e.what());
+        }
+
+        if (params.checkpoint_interval < 0) {
+          outError("<SECONDS> must be non-negative!");
+        }
+
+        continue;
+      }
+      if (strcmp(argv[cnt], "--checkpoint-samples") == 0 ||
+          strcmp(argv[cnt], "-ckp-samples") == 0) {
+        ++cnt;
+        if (cnt >= argc || argv[cnt][0] == '-') {
+          outError("Use -ckp-samples <NUMBER>");
+        }
+
+        try {
+          params.checkpoint_placement_period = convert_int(argv[cnt]);
+        } catch (std::invalid_argument e) {
+          outError(e.what());
+        }
+
+        if (params.checkpoint_placement_period < 0) {
+          outError("<NUMBER> must be non-negative!");
+        }
+
+        continue;
+      }
+      if (strcmp(argv[cnt], "--resume") == 0 ||
+          strcmp(argv[cnt], "-resume") == 0) {
+        params.resume = true;
+        continue;
+      }
+      if (strcmp(argv[cnt], "--query-placement") == 0 ||
+          strcmp(argv[cnt], "-query") == 0) {
+        params.query_placement = true;
+        continue;
+      }
+      if (strcmp(argv[cnt], "--server") == 0 ||
+          strcmp(argv[cnt], "-server") == 0) {
+        params.server_mode = true;
+        continue;
+      }
+      if (strcmp(argv[cnt], "--socket") == 0 ||
+          strcmp(argv[cnt], "-socket") == 0) {
+        ++cnt;
+        if (cnt >= argc || argv[cnt][0] == '-') {
+          outError("Use -socket <SOCKET_PATH>");
+        }
+
+        params.server_socket = argv[cnt];
+        params.server_mode = true;
+
+        continue;
+      }
+      if (strcmp(argv[cnt], "--seed-placement") == 0 ||
+          strcmp(argv[cnt], "-seed-placement") == 0) {
+        params.seed_placement = true;
+        continue;
+      }
+      if (strcmp(argv[cnt], "--seed-rare-limit") == 0 ||
+          strcmp(argv[cnt], "-seed-rare") == 0) {
+        ++cnt;
+        if (cnt >= argc) {
+          outError("Use -seed-rare <NUMBER>");
+        }
+
+        int rare_mutation_limit = 0;
+        try {
+          rare_mutation_limit = convert_int(argv[cnt]);
+        } catch (std::invalid_argument e) {
+          outError(e.what());
+        }
+
+        if (rare_mutation_limit <= 0) {
+          outError("<NUMBER> must be positive!");
+        }
+        params.seed_rare_mutation_limit =
+            static_cast<NumSeqsType>(rare_mutation_limit);
+        params.seed_placement = true;
+
+        continue;
+      }
+      if (strcmp(argv[cnt], "--parsimony-radius") == 0 ||
+          strcmp(argv[cnt], "-pars-radius") == 0) {
+        ++cnt;
+        if (cnt >= argc) {
+          outError("Use -pars-radius <NUMBER>");
+        }
+
+        try {
+          params.parsimony_placement_radius = convert_int(argv[cnt]);
+        } catch (std::invalid_argument e) {
+          outError(e.what());
+        }
+
+        if (params.parsimony_placement_radius < 0) {
+          outError("<NUMBER> must be non-negative!");
+        }
+
+        continue;
+      }
+      if (strcmp(argv[cnt], "--bound-placement") == 0 ||
+          strcmp(argv[cnt], "-bound-placement") == 0) {
+        params.bound_placement = true;
+        continue;
+      }
+      if (strcmp(argv[cnt], "--cluster-order") == 0 ||
+          strcmp(argv[cnt], "-cluster-order") == 0) {
+        params.cluster_placement_order = true;
+        continue;
+      }
+      if (strcmp(argv[cnt], "--placement-hint-distance") == 0 ||
+          strcmp(argv[cnt], "-hint-dist") == 0) {
+        ++cnt;
+        if (cnt >= argc) {
+          outError("Use -hint-dist <NUMBER>");
+        }
+
+        try {
+          params.placement_hint_distance = convert_int(argv[cnt]);
+        } catch (std::invalid_argument e) {
+          outError(e.what());
+        }
+
+        if (params.placement_hint_distance < 0) {
+          outError("<NUMBER> must be non-negative!");
+        }
+
+        continue;
+      }
       if (strcmp(argv[cnt], "--failure-limit") == 0 ||
           strcmp(argv[cnt], "-fail-limit") == 0) {
         ++cnt;
@@ -1170,6 +1532,13 @@ void cmaple::parseArg(int argc, char* argv[], Params& params) {
   if (!params.aln_path.length()) {
     outError("Please supply an alignment file via -aln <ALN_FILENAME>");
   }
+  if (params.query_placement && !params.input_treefile.length()) {
+    outError("Please supply a reference tree via -t <TREE_FILE> to place "
+             "queries onto it (-query)");
+  }
+  if (params.query_placement && params.server_mode) {
+    outError("Please use either -query or -server/-socket, not both");
+  }
 }
 
 void cmaple::quickStartGuide() {
@@ -1221,7 +1590,9 @@ void cmaple::usage_cmaple() {
       << "                       or MAPLE format." << endl
       << "  -m <MODEL>           Specify a model name." << endl
       << "  -st <SEQ_TYPE>       Specify a sequence type (DNA/AA)." << endl
-      << "  -format <FORMAT>     Set the alignment format (PHYLIP/FASTA/MAPLE)."
+      << "  -format <FORMAT>     Set the alignment format (PHYLIP/FASTA/MAPLE/BINARY/VCF)."
+      << endl
+      << "                       VCF alignments require the reference (-ref)."
       << endl
       << "  -t <TREE_FILE>       Specify a starting tree for tree search."
       << endl
@@ -1236,9 +1607,39 @@ void cmaple::usage_cmaple() {
       << "                       branch supports (aLRT-SH)." << endl
       << "  -eps <NUM>           Set the epsilon value for computing" << endl
       << "                       branch supports (aLRT-SH)." << endl
+      << "  -query               Place the sequences, which are not in the" << endl
+      << "                       input tree (-t), onto the tree without" << endl
+      << "                       changing it. Output placements in jplace." << endl
+      << "  -server              Keep the alignment, model, and tree in" << endl
+      << "                       memory after the inference, then read" << endl
+      << "                       new sequences (MAPLE records) and commands" << endl
+      << "                       (PLACE, REMOVE <NAME>, NEWICK, QUIT) from" << endl
+      << "                       stdin to place (or remove) them" << endl
+      << "                       incrementally." << endl
+      << "  -socket <SOCKET_PATH> Like -server but serve the requests on a" << endl
+      << "                       Unix-domain socket (SHUTDOWN stops it)." << endl
+      << "  -seed-placement      Start seeking the placement of a new sample" << endl
+      << "                       from the samples sharing its rare mutations" << endl
+      << "                       instead of from the root." << endl
+      << "  -seed-rare <NUM>     Set the maximum number of samples carrying" << endl
+      << "                       a rare mutation for -seed-placement." << endl
+      << "                       Default: 1000." << endl
+      << "  -pars-radius <NUM>   Place new samples by parsimony first, then" << endl
+      << "                       only seek their placements by likelihood" << endl
+      << "                       within <NUM> levels of that position." << endl
+      << "  -bound-placement     Skip the subtrees whose samples lack too" << endl
+      << "                       many mutations of a new sample to hold its" << endl
+      << "                       best placement." << endl
+      << "  -cluster-order       Place similar samples one after another" << endl
+      << "                       instead of by their distances to the" << endl
+      << "                       reference." << endl
+      << "  -hint-dist <NUM>     Start seeking the placement of a new sample" << endl
+      << "                       next to that of a recent sample differing" << endl
+      << "                       from it by at most <NUM> mutations." << endl
       << "  -nt <NUM_THREADS>    Set the number of threads for computing"
       << endl
-      << "                       branch supports. Use `-nt AUTO` " << endl
+      << "                       branch supports or placing queries." << endl
+      << "                       Use `-nt AUTO` " << endl
       << "                       to employ all available CPU cores." << endl
       << "  -pre <PREFIX>        Specify a prefix for all output files." << endl
       << "  -rep-tree            Allow CMAPLE to replace the input tree" << endl
@@ -1246,10 +1647,15 @@ void cmaple::usage_cmaple() {
       << "  -out-mul-tree        Output the tree in multifurcating format."
       << endl
       << "  -overwrite           Overwrite output files if existing." << endl
+      << "  -ckp-interval <NUM>  Set the minimum period (in seconds) between" << endl
+      << "                       two checkpoints. Default: 300." << endl
+      << "  -ckp-samples <NUM>   Also write a checkpoint every <NUM> sample" << endl
+      << "                       placements." << endl
+      << "  -resume              Resume an interrupted run from its checkpoint." << endl
       << "  -ref <FILE>,<SEQ>    Specify the reference genome." << endl
       << "  -out-aln <FILE>      Write the input alignment to a file in " << endl
-      << "                       MAPLE (default), PHYLIP, or FASTA format." << endl
-      << "  -out-format <FORMAT> Specify the format (MAPLE/PHYLIP/FASTA) " << endl
+      << "                       MAPLE (default), PHYLIP, FASTA, or BINARY format." << endl
+      << "  -out-format <FORMAT> Specify the format (MAPLE/PHYLIP/FASTA/BINARY) " << endl
       << "                       to output the alignment with `-out-aln`." << endl
       << "  -min-bl <NUM>        Set the minimum branch length." << endl
       << "  -thresh-prob <NUM>   Specify a parameter for approximations."
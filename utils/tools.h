@@ -328,6 +328,8 @@ struct Index {
 /*--------------------------------------------------------------*/
 const char REF_NAME[] = "REF";
 const int MIN_NUM_TAXA = 3;
+// approximate size (in bytes) of each chunk of MAPLE records parsed in parallel
+const std::size_t MAPLE_CHUNK_SIZE = 1 << 18;
 const RealNumType MIN_NEGATIVE =
     std::numeric_limits<RealNumType>::lowest();  // -FLT_MAX;
 const RealNumType MIN_POSITIVE =
@@ -634,6 +636,89 @@ class Params {
   */
   RealNumType mean_subs_per_site;
 
+  /**
+   * Name of the checkpoint file, which is periodically (over)written during
+   * the inference. Default: "" (no checkpoint)
+   */
+  std::string checkpoint_filename;
+
+  /**
+   * The minimum period (in seconds) between two checkpoints. Default: 300
+   */
+  RealNumType checkpoint_interval;
+
+  /**
+   * The period (in term of the number of sample placements) to write a
+   * checkpoint regardless of checkpoint_interval. Default: 0 (disabled)
+   */
+  PositionType checkpoint_placement_period;
+
+  /**
+   * TRUE to resume an interrupted inference from the checkpoint file
+   */
+  bool resume;
+
+  /**
+   * TRUE to place the sequences which are not in the input tree onto the
+   * (fixed) input tree and output their placements in jplace format
+   */
+  bool query_placement;
+
+  /**
+   * TRUE to keep the alignment, the model, and the tree in memory after the
+   * inference and serve requests for placing new sequences incrementally
+   */
+  bool server_mode;
+
+  /**
+   * Path of the Unix-domain socket to serve placement requests on (if empty,
+   * requests are read from the standard input)
+   */
+  std::string server_socket;
+
+  /**
+   * TRUE to start seeking the placement of a new sample from the leaves sharing
+   * its rare mutations (looked up in an inverted index of mutations) instead of
+   * from the root
+   */
+  bool seed_placement;
+
+  /**
+   * The maximum number of leaves carrying a mutation for it to be considered
+   * rare when seeding sample placements. Default: 1000
+   */
+  cmaple::NumSeqsType seed_rare_mutation_limit;
+
+  /**
+   * If non-negative, place each new sample by parsimony first: start seeking
+   * its placement this number of levels above the most parsimonious leaf
+   * (among those sharing its rare mutations) and only examine the nodes up to
+   * twice this number of levels below. Default: -1 (disabled)
+   */
+  int parsimony_placement_radius;
+
+  /**
+   * TRUE to skip the subtrees where no sample placement can beat the best one
+   * found so far when seeking sample placements, according to a bound computed
+   * from the mutations carried by the leaves of those subtrees
+   */
+  bool bound_placement;
+
+  /**
+   * TRUE to place groups of similar samples (by the MinHash of their
+   * mutations) one after another, instead of following the order of the
+   * distances to the reference
+   */
+  bool cluster_placement_order;
+
+  /**
+   * If non-negative, start seeking the placement of a new sample next to the
+   * recent placement of a sample differing from it by at most this number of
+   * mutations (falling back to the usual start if that local search fails).
+   * Default: -1 (disabled)
+   */
+  int placement_hint_distance;
+
   /*
       TRUE to log debugging
    */
@@ -741,6 +826,33 @@ class ParamsBuilder {
    */
   ParamsBuilder& withStopTreeSearchThresh(const double& stop_search_thresh);
 
+  /*! \brief Specify a checkpoint file, which is periodically (over)written
+   * during the inference. A checkpoint is written between placement batches
+   * and between rounds of tree search once at least `interval` seconds have
+   * passed since the last one. The file is replaced atomically, thus it always
+   * contains a complete checkpoint, which can be restored by
+   * Tree::loadCheckpoint(). Default: no checkpoint
+   * @param[in] checkpoint_filename Name of the checkpoint file
+   * @param[in] interval A non-negative period (in seconds) between two
+   * checkpoints (optional)
+   * @return A reference to the ParamsBuilder instance
+   * @throw std::invalid\_argument if checkpoint\_filename is empty or interval
+   * is negative
+   */
+  ParamsBuilder& withCheckpoint(const std::string& checkpoint_filename,
+                                const double& interval = 300);
+
+  /*! \brief Specify the period (in term of the number of sample placements) to
+   * write a checkpoint (if a checkpoint file is specified) regardless of the
+   * time passed since the last one. Default: 0 (disabled)
+   * @param[in] checkpoint_placement_period A non-negative period (in term of
+   * the number of sample placements)
+   * @return A reference to the ParamsBuilder instance
+   * @throw std::invalid\_argument if checkpoint\_placement\_period is negative
+   */
+  ParamsBuilder& withCheckpointPlacementPeriod(
+      const int32_t& checkpoint_placement_period);
+
   /*! \brief Build the Params object after initializing parameters
    * @return a unique pointer to an instance of Params
    */
@@ -838,6 +950,17 @@ std::string convertDoubleToString(RealNumType number);
 
 std::string convertDoubleToString(RealNumType number, uint8_t precision);
 
+/**
+ * Append a real number to a string, formatted as convertDoubleToString() does
+ * but without any temporary stream or string
+ * @param output the string to append to
+ * @param number the number
+ * @param precision the number of significant digits
+ */
+void appendDoubleToString(std::string& output,
+                          RealNumType number,
+                          uint8_t precision = 6);
+
 /**
  Case-insensitive comparison between two strings
  @return true if two strings are equal.
@@ -859,6 +982,31 @@ bool copyFile(const char SRC[], const char DEST[]);
  */
 bool fileExists(const std::string& strFilename);
 
+/**
+ * Check if a file is gzip-compressed (by its magic bytes)
+ * @param strFilename
+ * @return true if the file starts by the gzip magic bytes
+ */
+bool isGzipFile(const std::string& strFilename);
+
+/**
+ * Check if a file is in BGZF format (i.e., its first gzip member has the 'BC'
+ * extra subfield storing the block size)
+ * @param strFilename
+ * @return true if the file starts by a BGZF block header
+ */
+bool isBgzfFile(const std::string& strFilename);
+
+/**
+ * Decompress a gzip file into memory. BGZF files (concatenated gzip blocks
+ * with their sizes in the 'BC' extra field) are decompressed in parallel;
+ * other (multi-member) gzip files are decompressed sequentially.
+ * @param strFilename
+ * @return the decompressed content
+ * @throw std::ios::failure if the file is not found or corrupted
+ */
+std::string readGzipFile(const std::string& strFilename);
+
 /**
     Check that path is a directory
  */